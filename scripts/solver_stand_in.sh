@@ -0,0 +1,62 @@
+#!/bin/sh
+#
+# Stand-in for the MATLAB VEM solver, to exercise the solver job scheduler
+# (sharding, retry, cancel and merge) without MATLAB. Select it as the solver
+# script in the Solver tab: scripts that are not MATLAB files are run as
+#
+#   solver_stand_in.sh <input folder> <output file> <solution id>
+#
+# For each NODE/ELE mesh of the input folder, in name order (that is, in
+# dataset order), it writes one row of the 5 error values read by PEMesh
+# (errS errInf errL2 hEmax condVect) to the output file, and the per vertex
+# solution and ground truth fields next to the inputs. Values are made up.
+#
+# Environment:
+#   STAND_IN_DELAY      seconds to sleep per mesh (to cancel a running shard)
+#   STAND_IN_FAIL_ONCE  if set, the first attempt of each shard exits with an
+#                       error and no output (to see it retried)
+
+if [ $# -ne 3 ]; then
+    echo "usage: $0 <input folder> <output file> <solution id>" >&2
+    exit 2
+fi
+
+in_folder=$1
+out_file=$2
+solution_id=$3
+
+if [ -n "$STAND_IN_FAIL_ONCE" ] && [ ! -e "$in_folder/.stand_in_failed" ]; then
+    touch "$in_folder/.stand_in_failed"
+    echo "failing on purpose"
+    exit 1
+fi
+
+: > "$out_file" || exit 1
+
+n=0
+
+for node in "$in_folder"/*.node; do
+    [ -e "$node" ] || continue
+
+    base=${node%.node}
+    [ -e "$base.ele" ] || { echo "missing $base.ele"; exit 1; }
+
+    [ -n "$STAND_IN_DELAY" ] && sleep "$STAND_IN_DELAY"
+
+    # the header of a NODE file starts with the number of vertices, the
+    # field is x+y (plus the solution id) and is exact on the ground truth
+    awk -v sol="$solution_id" '
+        NR == 1 { n = $1; next }
+        /^[ \t]*#/ || NF < 3 { next }
+        n > 0 { print $2 + $3 + sol; n-- }
+    ' "$node" > "$base-GROUND-TRUTH-sol.txt" || exit 1
+
+    awk '{ printf "%.17g\n", $1 * 1.001 }' "$base-GROUND-TRUTH-sol.txt" > "$base-VEM-sol.txt" || exit 1
+
+    n=$((n + 1))
+    echo "$n.0e-3 1e-4 1e-5 0.1 $((10 * n))" >> "$out_file" || exit 1
+
+    echo "solved $(basename "$base")"
+done
+
+echo "$n meshes"
@@ -33,27 +33,47 @@ LIBS         += -L$$PWD/../external/triangle/build -ltriangle
 
 #DEFINES += DEVELOP_MODE
 
-CONFIG += c++11
+CONFIG += c++17
 
 SOURCES += \
         $${VEM_BENCHMARK_DIR}/abstract_vem_element.cpp \
+        $${VEM_BENCHMARK_DIR}/aggregation.cpp \
+        $${VEM_BENCHMARK_DIR}/color_field_buffers.cpp \
+        $${VEM_BENCHMARK_DIR}/dataset_container.cpp \
+        $${VEM_BENCHMARK_DIR}/dataset_manifest.cpp \
+        $${VEM_BENCHMARK_DIR}/density_grid.cpp \
+        $${VEM_BENCHMARK_DIR}/error_norms.cpp \
+        $${VEM_BENCHMARK_DIR}/mapped_file.cpp \
         $${VEM_BENCHMARK_DIR}/mesh_metrics.cpp \
         $${VEM_BENCHMARK_DIR}/mirroring.cpp \
+        $${VEM_BENCHMARK_DIR}/polygon_heatmap.cpp \
+        $${VEM_BENCHMARK_DIR}/polygon_mesh_io.cpp \
+        $${VEM_BENCHMARK_DIR}/solution_io.cpp \
+        $${VEM_BENCHMARK_DIR}/solver_cache.cpp \
         $${VEM_BENCHMARK_DIR}/vem_elements.cpp \
+        $${VEM_BENCHMARK_DIR}/vem_poisson_solver.cpp \
+        $${VEM_BENCHMARK_DIR}/vertex_field_view.cpp \
         addpointsdialog.cpp \
         addpolygondialog.cpp \
         aggregatedialog.cpp \
+        asyncfilewriter.cpp \
+        backgroundtask.cpp \
         customizedchartview.cpp \
         dataset.cpp \
         datasetwidget.cpp \
+        downsampledlineseries.cpp \
         geometrygeometryscatterplotswidget.cpp \
         geometryperformancescatterplotswidget.cpp \
         main.cpp \
         mainwindow.cpp \
         meshmetricsgraphicwidget.cpp \
         meshmetricswidget.cpp \
+        meshprefetcher.cpp \
         parametricdatasetsettingsdialog.cpp \
+        renderupdatequeue.cpp \
+        scatterchartcache.cpp \
         scatterplotmarkersettingwidget.cpp \
+        solverjobscheduler.cpp \
         solverresultswidget.cpp \
         solversettingsdialog.cpp \
         solverwidget.cpp \
@@ -61,25 +81,45 @@ SOURCES += \
 
 HEADERS += \
         $${VEM_BENCHMARK_DIR}/abstract_vem_element.h \
+        $${VEM_BENCHMARK_DIR}/aggregation.h \
+        $${VEM_BENCHMARK_DIR}/color_field_buffers.h \
+        $${VEM_BENCHMARK_DIR}/dataset_container.h \
+        $${VEM_BENCHMARK_DIR}/dataset_manifest.h \
+        $${VEM_BENCHMARK_DIR}/density_grid.h \
+        $${VEM_BENCHMARK_DIR}/error_norms.h \
+        $${VEM_BENCHMARK_DIR}/mapped_file.h \
         $${VEM_BENCHMARK_DIR}/mesh_metrics.h \
         $${VEM_BENCHMARK_DIR}/mirroring.h \
         $${VEM_BENCHMARK_DIR}/non_uniform_scaling_01.h \
+        $${VEM_BENCHMARK_DIR}/polygon_heatmap.h \
+        $${VEM_BENCHMARK_DIR}/polygon_mesh_io.h \
+        $${VEM_BENCHMARK_DIR}/solution_io.h \
+        $${VEM_BENCHMARK_DIR}/solver_cache.h \
         $${VEM_BENCHMARK_DIR}/vem_elements.h \
+        $${VEM_BENCHMARK_DIR}/vem_poisson_solver.h \
+        $${VEM_BENCHMARK_DIR}/vertex_field_view.h \
         addpointsdialog.h \
         addpolygondialog.h \
         aggregatedialog.h \
+        asyncfilewriter.h \
+        backgroundtask.h \
         customizedchartview.h \
         dataset.h \
         dataset_classes.h \
         datasetwidget.h \
+        downsampledlineseries.h \
         geometrygeometryscatterplotswidget.h \
         geometryperformancescatterplotswidget.h \
         mainwindow.h \
         meshmetricsgraphicwidget.h \
         meshmetricswidget.h \
+        meshprefetcher.h \
         parametricdatasetsettingsdialog.h \
         quality_metrics.h \
+        renderupdatequeue.h \
+        scatterchartcache.h \
         scatterplotmarkersettingwidget.h \
+        solverjobscheduler.h \
         solverresultswidget.h \
         solversettingsdialog.h \
         solverwidget.h \
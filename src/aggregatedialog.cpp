@@ -46,6 +46,9 @@ AggregateDialog::AggregateDialog(QWidget *parent) :
 
     ui->nsteps_btn->hide();
     ui->label_4->hide();
+
+    ui->target_btn->hide();
+    ui->label_6->hide();
 }
 
 AggregateDialog::~AggregateDialog()
@@ -85,6 +88,21 @@ double AggregateDialog::getAggregationBound() const
     return ui->bound_btn->value();
 }
 
+int AggregateDialog::getAggregationMode() const
+{
+    return ui->mode_btn->currentIndex();
+}
+
+uint AggregateDialog::getSeed() const
+{
+    return static_cast<uint>(ui->seed_btn->value());
+}
+
+uint AggregateDialog::getTargetPolys() const
+{
+    return static_cast<uint>(ui->target_btn->value());
+}
+
 void AggregateDialog::on_type_btn_currentIndexChanged(int index)
 {
     if (index < 2)
@@ -104,3 +122,17 @@ void AggregateDialog::on_type_btn_currentIndexChanged(int index)
         ui->label_4->show();
     }
 }
+
+void AggregateDialog::on_mode_btn_currentIndexChanged(int index)
+{
+    if (index == 2)
+    {
+        ui->target_btn->show();
+        ui->label_6->show();
+    }
+    else
+    {
+        ui->target_btn->hide();
+        ui->label_6->hide();
+    }
+}
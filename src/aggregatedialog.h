@@ -53,9 +53,13 @@ public:
     std::string getAggregationName() const;
     int getNumSteps() const;
     double getAggregationBound() const;
+    int getAggregationMode() const;
+    uint getSeed() const;
+    uint getTargetPolys() const;
 
 private slots:
     void on_type_btn_currentIndexChanged(int index);
+    void on_mode_btn_currentIndexChanged(int index);
 
 private:
     Ui::AggregateDialog *ui;
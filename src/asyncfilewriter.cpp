@@ -0,0 +1,101 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "asyncfilewriter.h"
+
+AsyncFileWriter::AsyncFileWriter() :
+    n_written(0)
+{
+    thread = std::thread(&AsyncFileWriter::run, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        stop = true;
+    }
+    cv.notify_one();
+
+    thread.join();
+}
+
+void AsyncFileWriter::push(const std::string &filename, std::function<bool()> write_fn)
+{
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        queue.push_back(std::make_pair(filename, std::move(write_fn)));
+    }
+    cv.notify_one();
+}
+
+void AsyncFileWriter::wait_pending(const size_t max_pending)
+{
+    std::unique_lock<std::mutex> lock (mutex);
+    cv_done.wait(lock, [this, max_pending]() { return queue.size() <= max_pending; });
+}
+
+void AsyncFileWriter::finish()
+{
+    std::unique_lock<std::mutex> lock (mutex);
+    cv_done.wait(lock, [this]() { return queue.empty() && !busy; });
+}
+
+void AsyncFileWriter::run()
+{
+    std::unique_lock<std::mutex> lock (mutex);
+
+    while (true)
+    {
+        cv.wait(lock, [this]() { return stop || !queue.empty(); });
+
+        // pending jobs are written even when stopping
+        if (queue.empty()) break;
+
+        std::pair<std::string, std::function<bool()>> job = std::move(queue.front());
+        queue.pop_front();
+        busy = true;
+
+        lock.unlock();
+        bool ok = job.second();
+        lock.lock();
+
+        busy = false;
+
+        if (ok) n_written++;
+        else    failed_files.push_back(job.first);
+
+        cv_done.notify_all();
+    }
+
+    cv_done.notify_all();
+}
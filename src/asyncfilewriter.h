@@ -0,0 +1,86 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef ASYNCFILEWRITER_H
+#define ASYNCFILEWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes files on a dedicated thread, so that the threads producing the
+// data never wait for the disk. Jobs are executed in the order they are
+// pushed; a job returns false if the file could not be written.
+class AsyncFileWriter
+{
+public:
+    AsyncFileWriter ();
+    ~AsyncFileWriter ();
+
+    void push (const std::string &filename, std::function<bool()> write_fn);
+
+    // waits until at most max_pending jobs are queued, so that producers
+    // faster than the disk do not pile up buffers in memory
+    void wait_pending (const size_t max_pending);
+
+    // waits until every pushed job has been executed
+    void finish ();
+
+    uint get_num_written () const { return n_written; }
+
+    // files whose job failed, available after finish()
+    const std::vector<std::string> & get_failed_files () const { return failed_files; }
+
+private:
+
+    void run ();
+
+    std::thread             thread;
+    std::mutex              mutex;
+    std::condition_variable cv;
+    std::condition_variable cv_done;
+
+    std::deque<std::pair<std::string, std::function<bool()>>> queue;
+
+    bool stop = false;
+    bool busy = false;
+
+    std::atomic<uint>        n_written;
+    std::vector<std::string> failed_files;
+};
+
+#endif // ASYNCFILEWRITER_H
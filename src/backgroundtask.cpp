@@ -0,0 +1,90 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "backgroundtask.h"
+
+#include <QEventLoop>
+#include <QProgressDialog>
+#include <QTimer>
+
+#include <algorithm>
+#include <thread>
+
+BackgroundTask::BackgroundTask(QWidget *parent, const QString &label, const uint n_steps) :
+    parent(parent),
+    label(label),
+    n_steps(n_steps),
+    n_done(0),
+    canceled(false)
+{
+}
+
+bool BackgroundTask::run(std::function<void()> job)
+{
+    QProgressDialog progress (label, "Cancel", 0, static_cast<int>(n_steps), parent);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
+    progress.setAutoReset(false);
+    progress.setValue(0);
+
+    QObject::connect(&progress, &QProgressDialog::canceled, [this]() { canceled = true; });
+
+    std::atomic<bool> finished (false);
+
+    std::thread worker ([&job, &finished]()
+    {
+        job();
+        finished = true;
+    });
+
+    QEventLoop loop;
+    QTimer timer;
+
+    QObject::connect(&timer, &QTimer::timeout, [&]()
+    {
+        if (!progress.wasCanceled())
+            progress.setValue(static_cast<int>(std::min(n_done.load(), n_steps)));
+
+        if (finished)
+            loop.quit();
+    });
+
+    timer.start(50);
+    loop.exec();
+    timer.stop();
+
+    worker.join();
+
+    progress.close();
+
+    return !canceled;
+}
@@ -0,0 +1,68 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef BACKGROUNDTASK_H
+#define BACKGROUNDTASK_H
+
+#include <QString>
+#include <QWidget>
+
+#include <atomic>
+#include <functional>
+
+// Runs a job on a worker thread while a modal progress dialog, with a
+// Cancel button, keeps the GUI responsive. The job reports its progress
+// with step_done() and polls is_canceled(): both are thread-safe, so they
+// can be called from inside OpenMP loops. The job must not touch widgets.
+class BackgroundTask
+{
+public:
+    BackgroundTask (QWidget *parent, const QString &label, const uint n_steps);
+
+    // Blocks, processing GUI events, until the job returns.
+    // Returns false if the task was canceled.
+    bool run (std::function<void()> job);
+
+    void step_done    (const uint n = 1) { n_done += n; }
+    bool is_canceled  () const { return canceled; }
+
+private:
+
+    QWidget *parent = nullptr;
+    QString  label;
+    uint     n_steps = 0;
+
+    std::atomic<uint> n_done;
+    std::atomic<bool> canceled;
+};
+
+#endif // BACKGROUNDTASK_H
@@ -31,10 +31,13 @@
 *********************************************************************************/
 
 #include "customizedchartview.h"
+#include "downsampledlineseries.h"
 
 #include <QToolTip>
+#include <QWheelEvent>
 
 #include <iostream>
+#include <vector>
 
 CustomizedChartView::CustomizedChartView()
 {
@@ -66,11 +69,16 @@ void CustomizedChartView::mouseDoubleClickEvent( QMouseEvent * e )
 
     QChart *ch = new QChart();
 
+    std::vector<DownsampledLineSeries *> downsampled;
+
     for (QAbstractSeries * series : chart()->series())
     {
-        if (QLineSeries *l = static_cast<QLineSeries *>(series))
+        if (QLineSeries *l = qobject_cast<QLineSeries *>(series))
         {
-            QLineSeries * ls = new QLineSeries();
+            // downsampled series are copied with all their points
+            DownsampledLineSeries *d = qobject_cast<DownsampledLineSeries *>(series);
+
+            QLineSeries * ls = (d != nullptr) ? new DownsampledLineSeries() : new QLineSeries();
             ls->setName(l->name());
             ls->setVisible(l->isVisible());
             ls->setColor(l->color());
@@ -80,8 +88,13 @@ void CustomizedChartView::mouseDoubleClickEvent( QMouseEvent * e )
             pen.setWidth(3);
             ls->setPen(pen);
 
-            for (int i=0; i < l->count(); i++)
-                ls->append(l->at(i).x(), l->at(i).y());
+            if (d != nullptr)
+            {
+                static_cast<DownsampledLineSeries *>(ls)->set_points(d->full_points());
+                downsampled.push_back(static_cast<DownsampledLineSeries *>(ls));
+            }
+            else
+                ls->replace(l->points());
 
             ch->addSeries(ls);
         }
@@ -92,10 +105,40 @@ void CustomizedChartView::mouseDoubleClickEvent( QMouseEvent * e )
     static_cast<QValueAxis *>(ch->axisX())->setLabelFormat(static_cast<QValueAxis *>(chart()->axisX())->labelFormat());
     static_cast<QValueAxis *>(ch->axisX())->setMinorTickCount(static_cast<QValueAxis *>(ch->axisX())->minorTickCount());
 
+    for (DownsampledLineSeries *d : downsampled)
+        d->track_axis(static_cast<QValueAxis *>(ch->axisX()));
+
     CustomizedChartView *chview = new CustomizedChartView();
     chview->setChart(ch);
+    chview->set_wheel_zoom_enabled(true);
 
     chview->setWindowTitle(chart()->title());
 
     chview->show();
 }
+
+void CustomizedChartView::wheelEvent(QWheelEvent *e)
+{
+    // charts embedded in other widgets zoom with Ctrl only,
+    // so that the wheel still scrolls the widget holding them
+    const bool zoom = wheel_zoom_enabled &&
+                      (isWindow() || (e->modifiers() & Qt::ControlModifier));
+
+    if (!zoom || e->angleDelta().y() == 0)
+    {
+        QChartView::wheelEvent(e);
+        return;
+    }
+
+    const qreal factor = (e->angleDelta().y() > 0) ? 0.8 : 1.25;
+
+    QRectF area = chart()->plotArea();
+    const qreal x = chart()->mapFromScene(mapToScene(e->pos())).x();
+
+    area.setLeft (x - (x - area.left()) * factor);
+    area.setRight(x + (area.right() - x) * factor);
+
+    chart()->zoomIn(area);
+
+    e->accept();
+}
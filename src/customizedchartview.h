@@ -47,6 +47,7 @@ public:
     CustomizedChartView();
 
     void set_double_click_enabled (bool b) { double_click_enabled = b; }
+    void set_wheel_zoom_enabled   (bool b) { wheel_zoom_enabled = b; }
 
 Q_SIGNALS:
 
@@ -61,9 +62,13 @@ protected:
 
     void mouseDoubleClickEvent(QMouseEvent *e);
 
+    // zooms the x axis around the cursor
+    void wheelEvent(QWheelEvent *e);
+
 private:
 
     bool double_click_enabled = false;
+    bool wheel_zoom_enabled = false;
 };
 
 #endif // CUSTOMIZEDCHARTVIEW_H
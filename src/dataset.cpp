@@ -32,73 +32,521 @@
 
 #include "dataset.h"
 
+#include "meshes/dataset_manifest.h"
+#include "meshes/polygon_mesh_io.h"
+
+#include "asyncfilewriter.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <fstream>
 #include <iomanip>
 #include <sstream>
 
 #include <QDir>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+
+// rough footprint of a resident mesh: geometry, attributes and adjacency
+size_t estimate_mesh_bytes (const Polygonmesh<> &m)
+{
+    size_t n_corners = 0;
+    for (uint pid=0; pid < m.num_polys(); pid++)
+        n_corners += m.adj_p2v(pid).size();
+
+    return sizeof(DrawablePolygonmesh<>) +
+           m.num_verts() * (sizeof(vec3d) + sizeof(Vert_std_attributes) + 4 * sizeof(std::vector<uint>)) +
+           m.num_edges() * (2 * sizeof(uint) + sizeof(Edge_std_attributes) + 2 * sizeof(std::vector<uint>)) +
+           m.num_polys() * (sizeof(Polygon_std_attributes) + 4 * sizeof(std::vector<uint>)) +
+           n_corners     * 10 * sizeof(uint);
+}
+
+// a mesh on its way to disk: copied out of the dataset, so that it stays
+// valid if the mesh is evicted meanwhile
+typedef struct
+{
+    std::string                    filepath;    // without extension
+    FlatPolygonMesh                flat;
+    std::vector<uint8_t>           flags;
+    std::vector<vec3d>             verts;
+    std::vector<std::vector<uint>> polys;
+    std::string                    obj;
+    uint64_t                       content_hash;
+}
+SaveItem;
+
+DrawablePolygonmesh<> * build_mesh (const FlatPolygonMesh &flat, const std::vector<uint8_t> *poly_flags)
+{
+    std::vector<vec3d> verts;
+    std::vector<std::vector<uint>> polys;
+    flat_polygon_mesh_to_vectors(flat, verts, polys);
+
+    DrawablePolygonmesh<> *m = new DrawablePolygonmesh<> (verts, polys);
+
+    // PEM elements: stored flags for containers, non-triangles for mesh files
+    for (uint pid=0; pid < m->num_polys(); pid++)
+    {
+        bool pem = (poly_flags != nullptr) ? (poly_flags->at(pid) != 0) : (m->adj_p2v(pid).size() > 3);
+
+        if (!pem) continue;
+
+        m->poly_data(pid).flags.set(1, true);
+
+        for (uint eid : m->adj_p2e(pid))
+            m->edge_data(eid).flags.set(0, true);
+    }
+
+    return m;
+}
+
+}
+
+const std::string Dataset::container_filename     = "dataset.pemd";
+const std::string Dataset::manifest_filename      = "dataset.manifest";
+const std::string Dataset::metrics_cache_filename = "dataset.metrics";
+
 Dataset::Dataset() {}
 
-void Dataset::save_on_disk(const std::string directory)
+Dataset::~Dataset()
 {
-    QString dir = QString(directory.c_str());
+    clean();
+}
+
+bool Dataset::save_on_disk(const std::string directory, const SaveOptions &options, std::vector<std::string> *failed_files)
+{
+    // no default location: an empty directory would write into the
+    // working directory
+    if (directory.empty())
+        return false;
 
-    if (directory.size() > 0)
-        dir += QDir::separator();
+    QString dir = QString(directory.c_str()) + QDir::separator();
 
-    if (parametric_meshes.size() > 0)
+    if (parametric_meshes.empty())
+        return true;
+
+    const std::string folder = dir.toStdString();
+    const uint n_meshes = get_num_parametric_meshes();
+
+    // metrics are stored only when they have been computed for every mesh
+    const bool with_metrics = (parametric_meshes_metrics.size() == parametric_meshes.size());
+
+    // Meshes are saved in batches. A batch is fetched (and loaded, if needed)
+    // on the GUI thread, serialized concurrently, and then written in order by
+    // a single I/O thread, while the next batch is being serialized. Handles
+    // are only updated on the GUI thread, at the end
+    auto on_gui_thread = [&options](const std::function<void()> &f)
     {
-        unsigned int index = 0;
+        if (options.on_gui_thread) options.on_gui_thread(f);
+        else                       f();
+    };
+
+    uint batch_size = 16;
+#ifdef _OPENMP
+    batch_size = std::max(batch_size, 4 * static_cast<uint>(omp_get_max_threads()));
+#endif
+
+    const std::string container = folder + container_filename;
+
+    DatasetContainerWriter container_writer;
+    bool container_ok = container_writer.open(container);
+
+    std::vector<ManifestEntry> manifest (n_meshes);
+    std::vector<std::string>   filenames (n_meshes);
+    std::vector<std::string>   written;     // only touched by the I/O thread
 
-        for (const Polygonmesh<> *polymesh : parametric_meshes)
+    AsyncFileWriter writer;
+
+    bool canceled = false;
+
+    for (uint first=0; first < n_meshes && !canceled; first += batch_size)
+    {
+        const uint last = std::min(n_meshes, first + batch_size);
+
+        std::vector<std::shared_ptr<SaveItem>> batch;
+
+        on_gui_thread([&]()
         {
-            std::string filename;
+            for (uint index=first; index < last; index++)
+            {
+                DrawablePolygonmesh<> *polymesh = get_parametric_mesh(index);
+
+                std::string filename;
+
+                if (polymesh->mesh_data().filename.length() == 0)
+                {
+                    std::stringstream ss;
+                    ss << std::setw((parametric_meshes.size() / 10) + 1)
+                       << std::setfill('0') << index;
+
+                    filename = ss.str() + "_";
+                    filename = filename + std::to_string(parametric_meshes_t.at(index));
+                }
+                else
+                {
+                    filename = polymesh->mesh_data().filename.substr(polymesh->mesh_data().filename.find_last_of("/")+1);
+                }
+
+                std::shared_ptr<SaveItem> item = std::make_shared<SaveItem>();
+                item->filepath = folder + filename;
+                item->verts    = polymesh->vector_verts();
+                item->polys    = polymesh->vector_polys();
+
+                flat_polygon_mesh(*polymesh, item->flat);
+
+                item->flags.resize(polymesh->num_polys());
+                for (uint pid=0; pid < polymesh->num_polys(); pid++)
+                    item->flags.at(pid) = polymesh->poly_data(pid).flags.test(1) ? 1 : 0;
+
+                filenames.at(index) = item->filepath + ".obj";
+
+                batch.push_back(item);
+            }
+        });
+
+        // the OBJ is written from the same flat arrays that are hashed, and
+        // reads back to identical doubles, so the manifest hash stays valid
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int b=0; b < static_cast<int>(batch.size()); b++)
+        {
+            SaveItem &item = *batch.at(b);
+            serialize_OBJ_2D(item.flat, item.obj);
+            item.content_hash = mesh_content_hash(item.flat);
+        }
+
+        for (uint b=0; b < batch.size(); b++)
+        {
+            const uint index = first + b;
+            std::shared_ptr<SaveItem> item = batch.at(b);
+
+            ManifestEntry &e = manifest.at(index);
+            e.filename     = item->filepath.substr(item->filepath.find_last_of("/")+1) + ".obj";
+            e.class_id     = parametric_meshes_class_ids.at(index);
+            e.t            = parametric_meshes_t.at(index);
+            e.num_verts    = item->flat.num_verts();
+            e.num_polys    = item->flat.num_polys();
+            e.content_hash = item->content_hash;
+            e.metrics_key  = metrics_cache_key(e.content_hash);
 
-            if (polymesh->mesh_data().filename.length() == 0)
+
+            writer.push(item->filepath + ".node/.ele", [item, &written]()
+            {
+                write_NODE_ELE_2D(item->filepath.c_str(), item->verts, item->polys);
+
+                if (!std::ifstream(item->filepath + ".node").good() || !std::ifstream(item->filepath + ".ele").good())
+                    return false;
+
+                written.push_back(item->filepath + ".node");
+                written.push_back(item->filepath + ".ele");
+                return true;
+            });
+
+            writer.push(item->filepath + ".obj", [item, &written]()
+            {
+                if (!write_buffer(item->filepath + ".obj", item->obj))
+                    return false;
+
+                written.push_back(item->filepath + ".obj");
+                return true;
+            });
+
+            const MeshMetrics *metrics = with_metrics ? &parametric_meshes_metrics.at(index) : nullptr;
+            const uint         class_id = parametric_meshes_class_ids.at(index);
+            const double       t = parametric_meshes_t.at(index);
+            const std::string  name = e.filename;
+
+            // a container failure is reported once, for the first mesh that could not be added
+            writer.push(container, [item, metrics, class_id, t, name, &container_writer, &container_ok, &options]()
+            {
+                bool ok = true;
+
+                if (container_ok)
+                {
+                    container_ok = container_writer.add_mesh(item->flat, item->flags, class_id, t, metrics, name);
+                    ok = container_ok;
+                }
+
+                if (options.step_done) options.step_done();
+
+                return ok;
+            });
+        }
+
+        // keeps at most about one batch queued, to bound the memory held by buffers
+        writer.wait_pending(3 * batch_size);
+
+        canceled = options.is_canceled && options.is_canceled();
+    }
+
+    writer.finish();
+
+    std::vector<std::string> failed = writer.get_failed_files();
+
+    container_ok = container_writer.close() && container_ok;
+
+    // a partial container or manifest would be taken for the whole dataset on reload
+    if (canceled)
+    {
+        std::remove(container.c_str());
+        container_ok = false;
+    }
+    else
+    {
+        if (container_ok) written.push_back(container);
+        else              failed.push_back(container);
+
+        const std::string manifest_path = folder + manifest_filename;
+
+        if (write_dataset_manifest(manifest_path, manifest)) written.push_back(manifest_path);
+        else                                                 failed.push_back(manifest_path);
+
+        if (with_metrics)
+        {
+            std::vector<uint64_t> keys;
+            for (const ManifestEntry &e : manifest)
+                keys.push_back(e.metrics_key);
+
+            const std::string metrics_path = folder + metrics_cache_filename;
+
+            if (write_metrics_cache(metrics_path, keys, parametric_meshes_metrics)) written.push_back(metrics_path);
+            else                                                                     failed.push_back(metrics_path);
+        }
+    }
+
+    if (options.sync)
+    {
+        for (const std::string &f : written)
+            if (!sync_file(f)) failed.push_back(f);
+    }
+
+    // the meshes take the names of their files and, once saved, can be
+    // evicted and reloaded from the container
+    on_gui_thread([&]()
+    {
+        for (uint i=0; i < n_meshes; i++)
+        {
+            if (filenames.at(i).empty()) continue;
+
+            MeshHandle &h = parametric_meshes.at(i);
+            h.filename     = filenames.at(i);
+            h.content_hash = manifest.at(i).content_hash;
+
+            if (h.mesh != nullptr) h.mesh->mesh_data().filename = filenames.at(i);
+        }
+
+        if (!container_ok) return;
+
+        std::shared_ptr<DatasetContainerReader> reader = std::make_shared<DatasetContainerReader>();
+
+        if (reader->open(container) && reader->num_meshes() == parametric_meshes.size())
+        {
+            containers.push_back(reader);
+
+            for (uint i=0; i < parametric_meshes.size(); i++)
             {
-                std::stringstream ss;
-                ss << std::setw((parametric_meshes.size() / 10) + 1)
-                   << std::setfill('0') << index;
-                std::string s = ss.str();
+                MeshHandle &h = parametric_meshes.at(i);
+                h.container       = static_cast<int>(containers.size()) - 1;
+                h.container_index = i;
+                h.modified        = false;
+            }
+
+            fit_memory_budget(UINT_MAX);
+        }
+    });
+
+    if (failed_files != nullptr)
+        *failed_files = failed;
+
+    return !canceled && failed.empty();
+}
+
+bool Dataset::save_container(const std::string filename) const
+{
+    DatasetContainerWriter writer;
+
+    if (!writer.open(filename)) return false;
+
+    // metrics are stored only when they have been computed for every mesh
+    const bool with_metrics = (parametric_meshes_metrics.size() == parametric_meshes.size());
+
+    FlatPolygonMesh flat;
+    std::vector<uint8_t> flags;
+
+    for (uint i=0; i < parametric_meshes.size(); i++)
+    {
+        // meshes that are not resident are copied straight from their source,
+        // to leave the cache untouched
+        const MeshHandle &h = parametric_meshes.at(i);
+
+        if (h.mesh != nullptr)
+        {
+            flat_polygon_mesh(*h.mesh, flat);
 
-                filename = ss.str() + "_";
-                filename = filename + std::to_string(parametric_meshes_t.at(index));
+            flags.resize(h.mesh->num_polys());
+            for (uint pid=0; pid < h.mesh->num_polys(); pid++)
+                flags.at(pid) = h.mesh->poly_data(pid).flags.test(1) ? 1 : 0;
+        }
+        else if (h.container >= 0)
+        {
+            if (!containers.at(static_cast<uint>(h.container))->read_mesh(h.container_index, flat, flags))
+            {
+                std::cerr << "ERROR: cannot read mesh " << i << " (" << h.filename << ")" << std::endl;
+                writer.close();
+                return false;
             }
-            else
+        }
+        else
+        {
+            if (!read_polygon_mesh_2D(h.filename, flat))
             {
-                filename = polymesh->mesh_data().filename.substr(polymesh->mesh_data().filename.find_last_of("/")+1);
+                std::cerr << "ERROR: cannot read " << h.filename << std::endl;
+                writer.close();
+                return false;
             }
 
+            flags.resize(flat.num_polys());
+            for (uint pid=0; pid < flat.num_polys(); pid++)
+                flags.at(pid) = (flat.poly_offsets.at(pid+1) - flat.poly_offsets.at(pid) > 3) ? 1 : 0;
+        }
+
+        const std::string &path = parametric_meshes.at(i).filename;
+        const std::string name = path.substr(path.find_last_of("/")+1);
+
+        if (!writer.add_mesh(flat, flags, parametric_meshes_class_ids.at(i), parametric_meshes_t.at(i),
+                             with_metrics ? &parametric_meshes_metrics.at(i) : nullptr, name))
+        {
+            std::cerr << "ERROR: cannot write " << filename << std::endl;
+            writer.close();
+            return false;
+        }
+    }
+
+    return writer.close();
+}
+
+bool Dataset::load_container(const std::string filename)
+{
+    std::shared_ptr<DatasetContainerReader> reader = std::make_shared<DatasetContainerReader>();
+
+    if (!reader->open(filename)) return false;
 
-            std::string filepath = dir.toStdString() + filename;
+    const std::string dir = filename.substr(0, filename.find_last_of("/")+1);
 
-            std::cout << "Saving " << filepath << std::endl;
+    // only the index is read here: meshes are mapped on demand
+    containers.push_back(reader);
+
+    const uint first = get_num_parametric_meshes();
+
+    std::vector<MeshMetrics> metrics (reader->num_meshes());
+    bool with_metrics = true;
+
+    for (uint i=0; i < reader->num_meshes(); i++)
+    {
+        const DatasetContainerEntry &e = reader->entry(i);
 
-            write_NODE_ELE_2D(filepath.c_str(), polymesh->vector_verts(), polymesh->vector_polys());
+        MeshHandle h;
+        h.filename        = dir + reader->name(i);
+        h.container       = static_cast<int>(containers.size()) - 1;
+        h.container_index = i;
 
-            filepath += ".obj";
-            polymesh->save((filepath).c_str());
+        parametric_meshes.push_back(h);
+        parametric_meshes_t.push_back(e.t);
+        parametric_meshes_class_ids.push_back(e.class_id);
+
+        with_metrics = with_metrics && reader->read_metrics(i, metrics.at(i));
+    }
+
+    if (with_metrics && parametric_meshes_metrics.size() == first)
+        parametric_meshes_metrics.insert(parametric_meshes_metrics.end(), metrics.begin(), metrics.end());
+
+    return get_num_parametric_meshes() > first;
+}
+
+bool Dataset::load_manifest(const std::string filename)
+{
+    std::vector<ManifestEntry> manifest;
 
-            parametric_meshes.at(index)->mesh_data().filename = filepath;
+    if (!read_dataset_manifest(filename, manifest)) return false;
 
-            index++;
+    const std::string dir = filename.substr(0, filename.find_last_of("/")+1);
+
+    const uint first = get_num_parametric_meshes();
+
+    // meshes are parsed when first accessed
+    for (const ManifestEntry &e : manifest)
+    {
+        add_parametric_mesh_file(dir + e.filename, e.t, e.class_id);
+        parametric_meshes.back().content_hash = e.content_hash;
+    }
+
+    // cached metrics are reused only if they are available for every mesh
+    std::unordered_map<uint64_t, MeshMetrics> cache;
+
+    if (parametric_meshes_metrics.size() == first && read_metrics_cache(dir + metrics_cache_filename, cache))
+    {
+        std::vector<MeshMetrics> metrics;
+
+        for (const ManifestEntry &e : manifest)
+        {
+            auto it = cache.find(e.metrics_key);
+            if (it == cache.end()) break;
+            metrics.push_back(it->second);
         }
+
+        if (metrics.size() == manifest.size())
+            parametric_meshes_metrics.insert(parametric_meshes_metrics.end(), metrics.begin(), metrics.end());
     }
+
+    return get_num_parametric_meshes() > first;
 }
 
 void Dataset::clean()
 {
-    for (cinolib::DrawablePolygonmesh<> *p : parametric_meshes)
-        delete p;
+    for (MeshHandle &h : parametric_meshes)
+        delete h.mesh;
 
     parametric_meshes.clear();
     parametric_meshes_metrics.clear();
     parametric_meshes_t.clear();
+    parametric_meshes_class_ids.clear();
+
+    containers.clear();
+    resident_ids.clear();
+    lru.clear();
+    resident_bytes = 0;
 }
 
 void Dataset::add_parametric_mesh (DrawablePolygonmesh<> *m, const double t, const uint class_id)
 {
-    parametric_meshes.push_back(m);
+    MeshHandle h;
+    h.mesh     = m;
+    h.filename = m->mesh_data().filename;
+    h.bytes    = estimate_mesh_bytes(*m);
+    h.modified = true;
+
+    parametric_meshes.push_back(h);
+    parametric_meshes_t.push_back(t);
+    parametric_meshes_class_ids.push_back(class_id);
+
+    const uint i = get_num_parametric_meshes() - 1;
+
+    lru.push_front(i);
+    parametric_meshes.at(i).lru_pos = lru.begin();
+    resident_ids[m] = i;
+    resident_bytes += h.bytes;
+}
+
+void Dataset::add_parametric_mesh_file (const std::string &filename, const double t, const uint class_id)
+{
+    MeshHandle h;
+    h.filename = filename;
+
+    parametric_meshes.push_back(h);
     parametric_meshes_t.push_back(t);
     parametric_meshes_class_ids.push_back(class_id);
 }
@@ -108,8 +556,162 @@ bool Dataset::is_on_disk () const
     if (parametric_meshes.empty())
         return false;
 
-    if (parametric_meshes.at(0)->mesh_data().filename.length() == 0)
+    if (parametric_meshes.at(0).filename.length() == 0)
         return false;
 
     return true;
 }
+
+DrawablePolygonmesh<> * Dataset::get_parametric_mesh (const uint i)
+{
+    MeshHandle &h = parametric_meshes.at(i);
+
+    if (h.mesh == nullptr)
+    {
+        load_parametric_mesh(i);
+        fit_memory_budget(i);
+    }
+    else
+        touch_parametric_mesh(i);
+
+    return h.mesh;
+}
+
+DrawablePolygonmesh<> * Dataset::pin_parametric_mesh (const uint i)
+{
+    DrawablePolygonmesh<> *m = get_parametric_mesh(i);
+    parametric_meshes.at(i).pins++;
+    return m;
+}
+
+void Dataset::unpin_parametric_mesh (const DrawablePolygonmesh<> *m)
+{
+    auto it = resident_ids.find(m);
+    if (it == resident_ids.end()) return;
+
+    MeshHandle &h = parametric_meshes.at(it->second);
+    if (h.pins > 0) h.pins--;
+
+    if (h.pins == 0) fit_memory_budget(UINT_MAX);
+}
+
+void Dataset::set_parametric_mesh_modified (const DrawablePolygonmesh<> *m)
+{
+    auto it = resident_ids.find(m);
+    if (it == resident_ids.end()) return;
+
+    MeshHandle &h = parametric_meshes.at(it->second);
+    h.modified = true;
+
+    // the edit may have changed the footprint
+    resident_bytes -= h.bytes;
+    h.bytes = estimate_mesh_bytes(*h.mesh);
+    resident_bytes += h.bytes;
+}
+
+std::vector<DrawablePolygonmesh<> *> Dataset::get_resident_parametric_meshes () const
+{
+    std::vector<DrawablePolygonmesh<> *> meshes;
+    meshes.reserve(lru.size());
+
+    for (uint i : lru)
+        meshes.push_back(parametric_meshes.at(i).mesh);
+
+    return meshes;
+}
+
+void Dataset::set_render_owner (const DrawablePolygonmesh<> *m, const void *owner)
+{
+    auto it = resident_ids.find(m);
+    if (it == resident_ids.end()) return;
+
+    parametric_meshes.at(it->second).render_owner = owner;
+}
+
+const void * Dataset::get_render_owner (const DrawablePolygonmesh<> *m) const
+{
+    auto it = resident_ids.find(m);
+    if (it == resident_ids.end()) return nullptr;
+
+    return parametric_meshes.at(it->second).render_owner;
+}
+
+void Dataset::set_memory_budget (const size_t bytes)
+{
+    memory_budget = bytes;
+    fit_memory_budget(UINT_MAX);
+}
+
+void Dataset::load_parametric_mesh (const uint i)
+{
+    MeshHandle &h = parametric_meshes.at(i);
+
+    FlatPolygonMesh flat;
+    std::vector<uint8_t> flags;
+
+    bool ok = (h.container >= 0) ? containers.at(static_cast<uint>(h.container))->read_mesh(h.container_index, flat, flags)
+                                 : read_polygon_mesh_2D(h.filename, flat);
+
+    // an unreadable source yields an empty mesh, so that callers never get a null pointer
+    if (!ok)
+    {
+        std::cerr << "ERROR: cannot load mesh " << i << " (" << h.filename << ")" << std::endl;
+        flat = FlatPolygonMesh();
+        flags.clear();
+    }
+    else if (h.container < 0 && h.content_hash != 0 && mesh_content_hash(flat) != h.content_hash)
+    {
+        std::cerr << "WARNING: " << h.filename << " changed since the dataset was saved" << std::endl;
+        h.content_hash = mesh_content_hash(flat);
+    }
+
+    h.mesh  = build_mesh(flat, (ok && h.container >= 0) ? &flags : nullptr);
+    h.mesh->mesh_data().filename = h.filename;
+    h.bytes = estimate_mesh_bytes(*h.mesh);
+
+    lru.push_front(i);
+    h.lru_pos = lru.begin();
+    resident_ids[h.mesh] = i;
+    resident_bytes += h.bytes;
+
+    if (load_callback) load_callback(i, h.mesh);
+}
+
+void Dataset::evict_parametric_mesh (const uint i)
+{
+    MeshHandle &h = parametric_meshes.at(i);
+
+    resident_ids.erase(h.mesh);
+    lru.erase(h.lru_pos);
+    resident_bytes -= h.bytes;
+
+    delete h.mesh;
+    h.mesh  = nullptr;
+    h.bytes = 0;
+    h.render_owner = nullptr;
+}
+
+void Dataset::fit_memory_budget (const uint keep)
+{
+    // walk from the least recently used mesh, skipping the ones that cannot be dropped
+    auto it = lru.end();
+
+    while (resident_bytes > memory_budget && it != lru.begin())
+    {
+        --it;
+
+        const uint i = *it;
+        const MeshHandle &h = parametric_meshes.at(i);
+
+        if (i == keep || h.pins > 0 || h.modified) continue;
+
+        it = std::next(it);
+        evict_parametric_mesh(i);
+    }
+}
+
+void Dataset::touch_parametric_mesh (const uint i)
+{
+    MeshHandle &h = parametric_meshes.at(i);
+    lru.splice(lru.begin(), lru, h.lru_pos);
+}
@@ -35,27 +35,111 @@
 
 #include "dataset_classes.h"
 
+#include "meshes/dataset_container.h"
 #include "meshes/mesh_metrics.h"
 #include "meshes/vem_elements.h"
 
 #include <cinolib/meshes/meshes.h>
 
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+// A mesh of the dataset. Meshes read from disk are described by their source
+// (a mesh file, or an entry of a dataset container) and are loaded only when
+// accessed. Meshes that only exist in memory (generated, or edited after
+// loading) are flagged as modified and stay resident until they are saved.
+typedef struct
+{
+    DrawablePolygonmesh<>   * mesh = nullptr;       // nullptr if not resident
+    std::string               filename;
+    int                       container = -1;       // index in Dataset::containers, -1 for mesh files
+    uint                      container_index = 0;
+    uint64_t                  content_hash = 0;     // as listed in the manifest, 0 if unknown
+    size_t                    bytes = 0;            // estimated footprint, when resident
+    uint                      pins = 0;             // displayed by some widget, never evicted
+    bool                      modified = false;     // not on disk, never evicted
+    const void              * render_owner = nullptr; // who built the render data, nullptr if unknown
+    std::list<uint>::iterator lru_pos;
+}
+MeshHandle;
+
+// hooks for long running dataset operations, called from worker threads.
+// The dataset is not thread safe: when the operation runs off the GUI thread,
+// on_gui_thread must run the given function there and wait for it (meshes are
+// fetched and handles updated through it). If null, it is run in place
+typedef struct
+{
+    std::function<void()> step_done   = nullptr;  // once per mesh
+    std::function<bool()> is_canceled = nullptr;
+    std::function<void(const std::function<void()> &)> on_gui_thread = nullptr;
+    bool                  sync        = false;    // fsync every written file at the end
+}
+SaveOptions;
+
 class Dataset {
 public:
     Dataset();
+    ~Dataset();
+
+    // the dataset owns its meshes
+    Dataset (const Dataset &) = delete;
+    Dataset & operator= (const Dataset &) = delete;
 
     void clean ();
 
-    void save_on_disk (const std::string directory);
+    // writes NODE/ELE and OBJ files, the container and the manifest. Meshes
+    // are serialized concurrently and written by a dedicated I/O thread. Returns
+    // false if canceled, if some file (listed in failed_files) was not written
+    // or if directory is empty (there is no default location)
+    bool save_on_disk (const std::string directory, const SaveOptions &options = SaveOptions(), std::vector<std::string> *failed_files = nullptr);
     bool is_on_disk () const;
 
-    uint get_num_parametric_meshes () const { return parametric_meshes.size(); }
+    // single-file binary dataset (see meshes/dataset_container.h)
+    bool save_container (const std::string filename) const;
+    bool load_container (const std::string filename);
+
+    // mesh files listed in a manifest (see meshes/dataset_manifest.h)
+    bool load_manifest (const std::string filename);
 
-    void add_parametric_mesh (DrawablePolygonmesh<> *m, const double t, const uint class_id);
+    uint get_num_parametric_meshes () const { return static_cast<uint>(parametric_meshes.size()); }
+
+    void add_parametric_mesh      (DrawablePolygonmesh<> *m, const double t, const uint class_id);
+    void add_parametric_mesh_file (const std::string &filename, const double t, const uint class_id);
     void add_parametric_mesh_metrics (const MeshMetrics &m) { parametric_meshes_metrics.push_back(m); }
 
-    const std::vector<DrawablePolygonmesh<> *> & get_parametric_meshes  ()             const { return parametric_meshes; }
-                      DrawablePolygonmesh<> *    get_parametric_mesh    (const uint i) const { return parametric_meshes.at(i); }
+    // meshes are loaded on demand, and the least recently used ones are
+    // evicted when the resident meshes exceed the memory budget. Not thread safe:
+    // call from the GUI thread only
+    DrawablePolygonmesh<> * get_parametric_mesh (const uint i);
+
+    // a displayed mesh must stay pinned for as long as a canvas holds it
+    DrawablePolygonmesh<> * pin_parametric_mesh   (const uint i);
+    void                    unpin_parametric_mesh (const DrawablePolygonmesh<> *m);
+
+    // an edited mesh differs from its source: it stays resident until the
+    // dataset is saved. Passes that edit the whole dataset pin the meshes a
+    // batch at a time and flag the ones they actually changed
+    void set_parametric_mesh_modified (const DrawablePolygonmesh<> *m);
+
+    std::vector<DrawablePolygonmesh<> *> get_resident_parametric_meshes () const;
+
+    // the meshes are shared by the tabs, each drawing them in its own color
+    // mode: the owner (e.g. a prefetcher) tells who built their render data
+    // last. It is forgotten when the mesh is evicted, and reset to nullptr by
+    // whoever rebuilds the render data on its own
+    void         set_render_owner (const DrawablePolygonmesh<> *m, const void *owner);
+    const void * get_render_owner (const DrawablePolygonmesh<> *m) const;
+
+    bool   is_parametric_mesh_resident (const uint i) const { return parametric_meshes.at(i).mesh != nullptr; }
+    size_t get_resident_bytes          () const { return resident_bytes; }
+
+    // called on the GUI thread every time a mesh is loaded (e.g. to log it)
+    void set_load_callback (std::function<void(const uint, const DrawablePolygonmesh<> *)> callback) { load_callback = callback; }
+
+    void   set_memory_budget (const size_t bytes);
+    size_t get_memory_budget () const { return memory_budget; }
 
     const std::vector<MeshMetrics>  & get_parametric_meshes_metrics     () const { return parametric_meshes_metrics; }
     const std::vector<double>       & get_parametric_meshes_t           () const { return parametric_meshes_t; }
@@ -66,17 +150,37 @@ public:
                  uint get_parametric_mesh_class_id   (const uint i) const { return parametric_meshes_class_ids.at(i); }
     const std::string get_parametric_mesh_class_name (const uint i) const { if (i >= classNames.size()) return "Unknown Class"; return classNames.at(i); }
 
-    const std::string get_parametric_mesh_filename (const uint i) const { return parametric_meshes.at(i)->mesh_data().filename; }
+    const std::string get_parametric_mesh_filename (const uint i) const { return parametric_meshes.at(i).filename; }
+
+    static const std::string container_filename;
+    static const std::string manifest_filename;
+    static const std::string metrics_cache_filename;
 
 private:
 
-    std::vector<DrawablePolygonmesh<> *> parametric_meshes;
+    void load_parametric_mesh  (const uint i);
+    void evict_parametric_mesh (const uint i);
+    void fit_memory_budget     (const uint keep);
+    void touch_parametric_mesh (const uint i);
+
+    std::vector<MeshHandle>  parametric_meshes;
 
     std::vector<MeshMetrics> parametric_meshes_metrics;
 
     std::vector<double>      parametric_meshes_t;
 
     std::vector<uint>        parametric_meshes_class_ids;
+
+    std::vector<std::shared_ptr<DatasetContainerReader>> containers;
+
+    std::unordered_map<const DrawablePolygonmesh<> *, uint> resident_ids;
+
+    std::list<uint> lru;    // resident meshes, most recently used first
+
+    size_t resident_bytes = 0;
+    size_t memory_budget  = 2048ul * 1024 * 1024;
+
+    std::function<void(const uint, const DrawablePolygonmesh<> *)> load_callback;
 };
 
 #endif // DATASET_H
@@ -33,13 +33,17 @@
 #include "datasetwidget.h"
 #include "ui_datasetwidget.h"
 
+#include "meshes/aggregation.h"
 #include "meshes/mirroring.h"
+#include "meshes/polygon_mesh_io.h"
 
 #include <cinolib/sampling.h>
 #include <cinolib/triangle_wrap.h>
 #include <cinolib/tetgen_wrap.h>
 
 #include <addpolygondialog.h>
+#include <asyncfilewriter.h>
+#include <backgroundtask.h>
 #include <parametricdatasetsettingsdialog.h>
 #include <aggregatedialog.h>
 #include <solversettingsdialog.h>
@@ -48,9 +52,17 @@
 #include <QFileDialog>
 #include <QFormLayout>
 #include <QHBoxLayout>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QPushButton>
 
+#include <climits>
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 DatasetWidget::DatasetWidget(QWidget *parent) :
     QWidget(parent),
@@ -60,6 +72,22 @@ DatasetWidget::DatasetWidget(QWidget *parent) :
 
     connect(ui->param_slider, SIGNAL(valueChanged(int)), this, SLOT(show_parametric_mesh(int)));
 
+    render_queue = new RenderUpdateQueue(this);
+    connect(render_queue, SIGNAL(drained()), ui->canvas, SLOT(updateGL()));
+
+    prefetcher = new MeshPrefetcher(this);
+    prefetcher->set_jobs([this](const uint i)
+    {
+        DrawablePolygonmesh<> *m = dataset->pin_parametric_mesh(i);
+        prepare_render_data(m);
+        return m;
+    },
+    [this](DrawablePolygonmesh<> *m)
+    {
+        render_queue->discard(m);
+        dataset->unpin_parametric_mesh(m);
+    });
+
     ui->param_slider->hide();
     ui->mesh_number_label->hide();
 
@@ -123,6 +151,22 @@ DatasetWidget::~DatasetWidget()
     delete ui;
 }
 
+void DatasetWidget::set_dataset(Dataset *d)
+{
+    dataset = d;
+
+    prefetcher->set_dataset(d);
+
+    dataset->set_load_callback([this](const uint i, const DrawablePolygonmesh<> *m)
+    {
+        std::string message = "Loaded mesh " + std::to_string(i) + " (" + dataset->get_parametric_mesh_filename(i) + "): " +
+                              std::to_string(m->num_verts()) + "V / " + std::to_string(m->num_polys()) + "P";
+        ui->log_label->append(message.c_str());
+    });
+
+    dataset->set_memory_budget(static_cast<size_t>(ui->memory_budget_sb->value()) * 1024 * 1024);
+}
+
 void DatasetWidget::add_polygon (const SelectedPolyData selected_poly,
                                  const cinolib::vec2d &pos,
                                  const double rotation_angle,
@@ -508,18 +552,34 @@ void DatasetWidget::clean_canvas()
     for (DrawablePolygonmesh<> * p : drawable_polys)
         ui->canvas->pop(p);
 
-    for (DrawablePolygonmesh<> * p : dataset->get_parametric_meshes())
-        ui->canvas->pop(p);
+    if (displayed_mesh != nullptr)
+    {
+        ui->canvas->pop(displayed_mesh);
+        render_queue->discard(displayed_mesh);
+        dataset->unpin_parametric_mesh(displayed_mesh);
+        displayed_mesh = nullptr;
+    }
 
     drawable_polys.clear();
 }
 
 void DatasetWidget::compute_geometric_metrics ()
 {
-    if (dataset->get_parametric_meshes().size() == 0)
+    if (dataset->get_num_parametric_meshes() == 0)
         return;
 
-    for (uint i=0; i < dataset->get_parametric_meshes().size(); i++)
+    // metrics stored in a dataset container do not need to be recomputed
+    if (dataset->get_parametric_meshes_metrics().size() == dataset->get_num_parametric_meshes())
+    {
+        ui->log_label->append("Polygon geometry metrics loaded from the dataset container.");
+
+        ui->add_btn->setEnabled(false);
+
+        emit (computed_mesh_metrics());
+        return;
+    }
+
+    for (uint i=0; i < dataset->get_num_parametric_meshes(); i++)
     {
         Polygonmesh<> m = *(dataset->get_parametric_mesh(i));
 
@@ -721,11 +781,13 @@ void DatasetWidget::on_generate_dataset_btn_clicked()
             meshes_with_canvas.push_back(dm);
             t_values.push_back(t);
 
-            std::string message = "[" + std::to_string(dataset->get_parametric_meshes().size()) +
+            std::string message = "[" + std::to_string(dataset->get_num_parametric_meshes()) +
                                   "] T value: <b>" + std::to_string(t) + "</b> : " + ss.str() + "<br>";
             ui->log_label->append(message.c_str());
         }
 
+        clean_canvas();
+        prefetcher->invalidate();
         dataset->clean();
 
 //        for (uint i : elems_class_types)
@@ -767,6 +829,7 @@ void DatasetWidget::on_generate_dataset_btn_clicked()
 
         ui->aggregate_btn->setEnabled(true);
         ui->mirroring_btn->setEnabled(true);
+        ui->tiling_btn->setEnabled(true);
 
         ui->highlight_polys_cb->setEnabled(true);
 
@@ -781,20 +844,55 @@ void DatasetWidget::on_generate_dataset_btn_clicked()
 
 void DatasetWidget::show_parametric_mesh(int index)
 {
+    const uint id = static_cast<uint>(index);
+
+    // the previous mesh goes back to the prefetcher, still pinned
+    DrawablePolygonmesh<> *previous    = displayed_mesh;
+    const uint             previous_id = displayed_id;
+
+    if (displayed_mesh != nullptr)
+    {
+        ui->canvas->pop(displayed_mesh);
+        displayed_mesh = nullptr;
+    }
+
     clean_canvas();
 
-    DrawablePolygonmesh<> *m = dataset->get_parametric_mesh(static_cast<uint>(index));
+    // a prefetched mesh is pinned and its render data are ready
+    DrawablePolygonmesh<> *m = prefetcher->take(id);
 
-    m->show_marked_edge(true);
-    m->show_poly_color();
+    if (m == nullptr)
+    {
+        m = dataset->pin_parametric_mesh(id);
+        prepare_render_data(m);
+    }
+
+    displayed_mesh = m;
+    displayed_id   = id;
 
-    m->updateGL();
     ui->canvas->push_obj(m, reset_canvas);
     ui->canvas->updateGL();
 
     reset_canvas = false;
 
     ui->mesh_number_label->setText(std::to_string(index).c_str());
+
+    prefetcher->set_current(id, dataset->get_num_parametric_meshes());
+    prefetcher->put(previous_id, previous);
+}
+
+void DatasetWidget::prepare_render_data(DrawablePolygonmesh<> *m) const
+{
+    m->show_marked_edge(ui->highlight_polys_cb->isChecked());
+    m->show_poly_color();
+
+    m->updateGL();
+}
+
+void DatasetWidget::resume_prefetch()
+{
+    if (displayed_mesh != nullptr)
+        prefetcher->set_current(displayed_id, dataset->get_num_parametric_meshes());
 }
 
 void DatasetWidget::on_save_btn_clicked()
@@ -825,17 +923,52 @@ void DatasetWidget::on_save_btn_clicked()
     }
     while (!d.isEmpty());
 
-    dataset->save_on_disk(dir.toStdString());
+    // prefetched meshes are unpinned, so that the saved ones can be evicted
+    prefetcher->invalidate();
+
+    BackgroundTask task (this, "Saving meshes ...", dataset->get_num_parametric_meshes());
+
+    SaveOptions options;
+    options.step_done   = [&task]() { task.step_done(); };
+    options.is_canceled = [&task]() { return task.is_canceled(); };
+    options.sync        = ui->sync_cb->isChecked();
+
+    // the dataset is only touched on this thread, which runs the event loop of
+    // the task while the workers serialize and write
+    options.on_gui_thread = [this](const std::function<void()> &f)
+    {
+        QMetaObject::invokeMethod(this, f, Qt::BlockingQueuedConnection);
+    };
+
+    std::vector<std::string> failed_files;
+    bool saved = false;
+
+    task.run([&]()
+    {
+        saved = dataset->save_on_disk(dir.toStdString(), options, &failed_files);
+    });
+
+    resume_prefetch();
+
+    for (const std::string &f : failed_files)
+        ui->log_label->append(("Unable to write " + f).c_str());
+
+    if (task.is_canceled())
+    {
+        ui->log_label->append("Saving canceled: the dataset has not been completely written.");
+        return;
+    }
 
     dataset_folder = dir.toStdString();
 
-    std::string message = "Saved in " + dir.toStdString();
+    std::string message = (saved ? "Saved in " : "Saved with errors in ") + dir.toStdString();
     ui->log_label->append(message.c_str());
 
     ui->add_btn->setEnabled(false);
     ui->generate_dataset_btn->setEnabled(false);
     ui->aggregate_btn->setEnabled(false);
     ui->mirroring_btn->setEnabled(false);
+    ui->tiling_btn->setEnabled(false);
 
     emit (saved_in (dir.toStdString()));
 }
@@ -1147,6 +1280,34 @@ void DatasetWidget::on_load_polys_btn_clicked()
     ui->load_meshes_btn->setEnabled(false);
 }
 
+// class of a dataset mesh, from the prefix of its filename (leading
+// digits up to the first "_" are skipped)
+static uint class_id_from_filename (const QString &f)
+{
+    QStringRef subString = &f;
+
+    if (f.length() > 0 && f.at(0).isDigit())
+    {
+        subString = QStringRef(&f, f.indexOf("_")+1, f.length() - f.indexOf("_") - 1);
+    }
+
+    for (uint i=0; i < classPrefix.size(); i++)
+        if (subString.startsWith(classPrefix.at(i).c_str()) )
+        {
+            bool contains_other = false;
+
+            for (uint j=i+1; j < classPrefix.size(); j++)
+                if (subString.contains(classPrefix.at(j).c_str()))
+                    contains_other = true;
+
+            if (contains_other) continue;
+
+            return i;
+        }
+
+    return UINT_MAX;
+}
+
 void DatasetWidget::on_load_meshes_btn_clicked()
 {
     QString dir;
@@ -1175,110 +1336,123 @@ void DatasetWidget::on_load_meshes_btn_clicked()
     }
     while (d.isEmpty());
 
-    //// Load files in the selected folder
+    //// Load the binary dataset container or the manifest, if any, otherwise the mesh files in the selected folder
 
-    QStringList mesh_files = d.entryList(QStringList() << "*.obj" << "*.OBJ" << "*.off" << "*.OFF", QDir::Files);
-    QStringList node_ele_files = d.entryList(QStringList() << "*.node" << "*.ele", QDir::Files);
+    const QString container = d.filePath(Dataset::container_filename.c_str());
+    const QString manifest  = d.filePath(Dataset::manifest_filename.c_str());
 
-
-    if (mesh_files.empty())
+    if (QFileInfo::exists(container) && dataset->load_container(container.toStdString()))
     {
-        if (d.isEmpty())
-        {
-            QMessageBox *m = new QMessageBox (this);
-
-            m->setText("The folder has no .obj file."
-                       "\n\nPlease select another folder.");
-
-            m->exec();
-            return;
-        }
+        std::string message = "Loaded " + std::to_string(dataset->get_num_parametric_meshes()) +
+                              " meshes from " + container.toStdString();
+        ui->log_label->append(message.c_str());
     }
-
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-
-    uint id = 1;
-    for (QString &f : mesh_files)
+    else
+    if (QFileInfo::exists(manifest) && dataset->load_manifest(manifest.toStdString()))
     {
-        const std::string filename = dir.toStdString() + QString(QDir::separator()).toStdString() + f.toStdString();
-
-        std::string message = "[" + std::to_string(id) + "/" + std::to_string(mesh_files.size()) + "] ";
-                    message += "Loading " + filename + " ... ";
+        std::string message = "Loaded " + std::to_string(dataset->get_num_parametric_meshes()) +
+                              " meshes from " + manifest.toStdString();
         ui->log_label->append(message.c_str());
+    }
+    else
+    {
+        //// Load files in the selected folder
 
-        // check class
-        QStringRef subString = &f;
+        QStringList mesh_files = d.entryList(QStringList() << "*.obj" << "*.OBJ" << "*.off" << "*.OFF", QDir::Files);
+        QStringList node_ele_files = d.entryList(QStringList() << "*.node" << "*.ele", QDir::Files);
 
-        if (f.length() > 0 && f.at(0).isDigit())
-        {
-            subString = QStringRef(&f, f.indexOf("_")+1, f.length() - f.indexOf("_") - 1);
-        }
 
-        std:: cout << subString.toString().toStdString() << std::endl;
+        if (mesh_files.empty())
+        {
+            if (d.isEmpty())
+            {
+                QMessageBox *m = new QMessageBox (this);
 
-        uint class_id = UINT_MAX;
+                m->setText("The folder has no .obj file."
+                           "\n\nPlease select another folder.");
 
-        for (uint i=0; i < classPrefix.size(); i++)
-            if (subString.startsWith(classPrefix.at(i).c_str()) )
-            {
-                bool contains_other = false;
+                m->exec();
+                return;
+            }
+        }
 
-                for (uint j=i+1; j < classPrefix.size(); j++)
-                    if (subString.contains(classPrefix.at(j).c_str()))
-                        contains_other = true;
+        // files are validated on a worker pool, and only registered in the
+        // dataset: meshes are built on demand. Each file gets its own slot,
+        // so that they enter the dataset in sorted filename order
+        const int n_files = mesh_files.size();
 
-                if (contains_other) continue;
+        std::vector<char> loaded (n_files, 0);   // not vector<bool>: written concurrently
+        std::vector<uint> class_ids (n_files, UINT_MAX);
+        std::vector<std::string> messages (n_files);
 
-                class_id = i;
-                break;
-            }
+        for (int i=0; i < n_files; i++)
+            class_ids.at(i) = class_id_from_filename(mesh_files.at(i));
 
-        DrawablePolygonmesh<> *m = new DrawablePolygonmesh<> (filename.c_str());
+        const std::string folder = dir.toStdString() + QString(QDir::separator()).toStdString();
 
-        message = std::to_string(m->num_verts()) + "V / " + std::to_string(m->num_polys()) + "P ";
-        ui->log_label->append(message.c_str());
+        BackgroundTask task (this, "Loading meshes ...", static_cast<uint>(n_files));
 
-        for (uint pid=0; pid < m->num_polys(); pid++)
+        bool completed = task.run([&]()
         {
-            if (m->poly_verts(pid).size() > 3)
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (int i=0; i < n_files; i++)
             {
-                for (uint eid : m->adj_p2e(pid))
-                    m->edge_data(eid).flags.set(0, true);
+                if (task.is_canceled()) continue;
 
-                m->poly_data(pid).flags.set(1, true);
-            }
+                const std::string basename = QFileInfo(mesh_files.at(i)).completeBaseName().toStdString();
+                const std::string filename = folder + mesh_files.at(i).toStdString();
 
-            m->show_marked_edge(true);
-        }
+                std::string &message = messages.at(i);
+                message = "[" + std::to_string(i+1) + "/" + std::to_string(n_files) + "] Registered " + filename;
 
-        // save node/ele if not present - to enable pde solver
-        QFileInfo fileInfo(QString(filename.c_str()));
-        QString basename = fileInfo.completeBaseName();
+                // save node/ele if not present - to enable pde solver. Only
+                // then the mesh is parsed here, the others when first accessed
+                const std::string node_ele_filename = folder + basename;
 
-        QString node_filename = dir + QString(QDir::separator()) + basename + ".node";
-        QString ele_filename = dir + QString(QDir::separator()) + basename + ".ele";
+                if (!std::ifstream(node_ele_filename + ".node").good() || !std::ifstream(node_ele_filename + ".ele").good())
+                {
+                    FlatPolygonMesh flat;
+                    if (!read_polygon_mesh_2D(filename, flat))
+                    {
+                        message += " ... FAILED";
+                        task.step_done();
+                        continue;
+                    }
 
-        if (!QFile(node_filename).exists() || !QFile(ele_filename).exists())
-        {
-            const std::string node_ele_filename = dir.toStdString() + QString(QDir::separator()).toStdString() + basename.toStdString();
+                    std::vector<vec3d> verts;
+                    std::vector<std::vector<uint>> polys;
+                    flat_polygon_mesh_to_vectors(flat, verts, polys);
 
-            write_NODE_ELE_2D(node_ele_filename.c_str(), m->vector_verts(), m->vector_polys());
-            message = "Saved NODE/ELE " + node_ele_filename;
-            ui->log_label->append(message.c_str());
-        }
+                    write_NODE_ELE_2D(node_ele_filename.c_str(), verts, polys);
+                    message += "\nSaved NODE/ELE " + node_ele_filename;
+                }
 
-        dataset->add_parametric_mesh(m, DBL_MAX, class_id);
+                loaded.at(i) = 1;
 
-        ui->log_label->append("\n");
+                task.step_done();
+            }
+        });
 
-        id++;
+        // meshes are built when first accessed (and logged by the load
+        // callback), their drawable setup (marked edges, render lists) is
+        // left to show_parametric_mesh
+        for (int i=0; i < n_files; i++)
+        {
+            if (!messages.at(i).empty())
+                ui->log_label->append(messages.at(i).c_str());
 
-        QCoreApplication::processEvents();
+            if (!loaded.at(i)) continue;
+
+            dataset->add_parametric_mesh_file(folder + mesh_files.at(i).toStdString(), DBL_MAX, class_ids.at(i));
+        }
+
+        if (!completed)
+            ui->log_label->append("Loading canceled.");
     }
 
-    QApplication::restoreOverrideCursor();
+    if (dataset->get_num_parametric_meshes() == 0) return;
 
-    ui->param_slider->setMaximum(static_cast<int>(mesh_files.size()-1));
+    ui->param_slider->setMaximum(static_cast<int>(dataset->get_num_parametric_meshes()-1));
 
     ui->log_label->append("Dataset completed.");
     ui->param_slider->show();
@@ -1309,312 +1483,205 @@ void DatasetWidget::on_aggregate_btn_clicked()
     AggregateDialog *dialog = new AggregateDialog();
 
     uint aggregation_type = 10;
+    int  aggregation_mode = GREEDY_AGGREGATION;
+    uint seed = 0;
+    uint target_polys = 0;
     if (dialog->exec() == 1)
+    {
         aggregation_type = dialog->getAggregationIndex();
-    if (aggregation_type >3)     return;
+        aggregation_mode = dialog->getAggregationMode();
+        seed = dialog->getSeed();
+        target_polys = dialog->getTargetPolys();
+    }
     delete dialog;
+    if (aggregation_type >3)     return;
 
-    if (dataset->get_parametric_meshes().empty()) return;
-    uint count_mesh = 0;
-
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-
-    for (DrawablePolygonmesh<> *m : dataset->get_parametric_meshes())
-    {
-        double diameter = -inf_double, rho = -inf_double, rho_a = -inf_double;
-
-        for (uint pid = 0; pid < m->num_polys(); pid++)
-        {
-            double max_pd = -inf_double;
-            std::vector<vec3d> points = m->poly_verts(pid);
-            for(uint i=0; i<points.size()-1; ++i)
-                for(uint j=i+1; j<points.size(); ++j)
-                {
-                    max_pd = std::max(max_pd, points.at(i).dist(points.at(j)));
-
-                    if (m->poly_data(pid).flags.test(1))
-                    {
-                        diameter = std::max(diameter, max_pd);
-                    }
-                }
-
-            /*if (aggregation_type == 0)
-            {
-                diameter = std::max(diameter, max_pd);
-            }
-            else */if (aggregation_type == 1)
-            {
-                double min_e = inf_double;
-                for (auto eid : m->adj_p2e(pid))
-                    min_e = std::min(min_e, m->edge_length(eid));
-
-                double area = m->poly_area(pid);
-
-                rho = std::max(rho, max_pd / std::min(sqrt(area), min_e));
-            }
-            else if (aggregation_type == 2)
-            {
-                double min_e = inf_double;
-                for (auto eid : m->adj_p2e(pid))
-                    min_e = std::min(min_e, m->edge_length(eid));
-
-                double area = m->poly_area(pid);
-
-                rho = max_pd / std::min(sqrt(area), min_e);
-                rho_a = std::max(rho_a, rho * rho * area);
-            }
-        }
-
-        for (uint e=0; e < elems.size(); e++)
-            m->poly_data(m->num_polys()-(e+1)).flags.set(1, true);
-
-        std::cout << count_mesh <<  " - aggregating ... " << std::endl;
-        double value;
-        if      (aggregation_type == 0)     value = diameter;
-        else if (aggregation_type == 1)     value = 1000;
-        else if (aggregation_type == 2)     value = rho;
-        else if (aggregation_type == 3)     value = rho_a;
-        else return;
-
-        ui->log_label->append(("Aggregating Triangles on Mesh " + std::to_string(count_mesh) + " ...").c_str());
-        aggregate_triangles(*m, value, aggregation_type);
-
-        std::string filename = m->mesh_data().filename.substr(m->mesh_data().filename.find_last_of("/")+1);
-
-        filename = "/home/danielacabiddu/Downloads/5k_polygons_canvas_aggregated_2/" + filename;
-        m->save(filename.c_str());
-
-        std::cout << "saved " << filename << std::endl;
+    if (dataset->get_num_parametric_meshes() == 0) return;
 
-        ui->log_label->append("DONE");
+    std::string out_folder = QFileDialog::getExistingDirectory(this, "Select output folder for aggregated meshes",
+                                                               QDir::homePath()).toStdString();
+    if (out_folder.empty())
+        ui->log_label->append("No output folder selected: aggregated meshes will not be written on disk.");
 
-        m->updateGL();
+    // the prefetcher must not rebuild render data while the workers edit the meshes
+    prefetcher->invalidate();
 
-        QCoreApplication::processEvents();
+    const uint n_meshes = dataset->get_num_parametric_meshes();
+    const uint n_elems  = static_cast<uint>(elems.size());
 
+    ui->log_label->append(("Aggregating " + std::to_string(n_meshes) + " meshes ...").c_str());
 
-        count_mesh++;
-    }
-    ui->canvas->updateGL();
-    QApplication::restoreOverrideCursor();
-
-    ui->aggregate_btn->setEnabled(false);
-    ui->save_btn->setEnabled(true);
-}
+    BackgroundTask task (this, "Aggregating meshes ...", n_meshes);
+    AsyncFileWriter writer;
 
-void DatasetWidget::aggregate_triangles (Polygonmesh<> &dm, const double value_b, const int aggregation_type)
-{
-    bool ok = false;
-    while (!ok)
+    // the dataset is only touched on this thread, which runs the event loop
+    // of the task
+    auto on_gui_thread = [this](const std::function<void()> &f)
+    {
+        QMetaObject::invokeMethod(this, f, Qt::BlockingQueuedConnection);
+    };
+
+    // meshes are pinned a batch at a time, so that the whole dataset is never
+    // resident. They are aggregated concurrently, unless they are fewer than
+    // the threads: in that case the parallel modes use all threads on each mesh
+    uint batch_size     = 16;
+    bool parallel_meshes = true;
+#ifdef _OPENMP
+    batch_size      = std::max(batch_size, 4 * static_cast<uint>(omp_get_max_threads()));
+    parallel_meshes = static_cast<int>(n_meshes) >= omp_get_max_threads();
+#endif
+
+    // render data are only needed by the displayed mesh
+    DrawablePolygonmesh<> *shown = displayed_mesh;
+
+    bool completed = task.run([&]()
     {
-        std::map<double, std::pair<uint,uint>> value2pid; // = (value, (pid1,pid2))
-        std::set<std::pair<uint,uint>> already;
+        for (uint first=0; first < n_meshes && !task.is_canceled(); first += batch_size)
+        {
+            const uint last = std::min(n_meshes, first + batch_size);
 
-//        if (aggregation_type == 1)
-//        {
-//            uint pid1 = rand() % dm.num_polys();
-//            uint pid2 = dm.adj_p2p(pid1).at(0);
+            std::vector<DrawablePolygonmesh<> *> batch;
+            std::vector<uint8_t> changed (last - first, 0);
 
-//            double val = 10;
-//            if (dm.num_polys() <= 50)
-//                val = 1000 + val;
+            on_gui_thread([&]()
+            {
+                for (uint i=first; i < last; i++)
+                    batch.push_back(dataset->pin_parametric_mesh(i));
+            });
 
-//            value2pid.insert(std::pair<double, std::pair<uint,uint>> (val, std::pair<uint,uint> (pid1, pid2)));
-//        }
-//        else
-        {
-            for (uint pid = 0; pid < dm.num_polys(); pid++)
+            #pragma omp parallel for schedule(dynamic, 1) if (parallel_meshes)
+            for (int b=0; b < static_cast<int>(batch.size()); b++)
             {
-                if (dm.poly_data(pid).flags.test(1)) continue;
+                if (task.is_canceled()) continue;
 
-                std::vector<uint> points_pid = dm.poly_verts_id(pid); // id dei vertici di pid
+                const uint mid = first + static_cast<uint>(b);
 
-                for (uint adj_pid : dm.adj_p2p(pid))    // poligoni adiacenti a pid
-                {
-                    if (dm.poly_data(adj_pid).flags.test(1)) continue;
+                DrawablePolygonmesh<> *m = batch.at(b);
 
-                    if (already.find(std::pair<uint,uint>(adj_pid, pid)) != already.end() ) continue;
+                const uint num_polys = m->num_polys();
 
-                    already.insert(std::pair<uint,uint> (adj_pid, pid));
-                    already.insert(std::pair<uint,uint> (pid, adj_pid));
+                double diameter = -inf_double, rho = -inf_double, rho_a = -inf_double;
 
-                    std::vector<uint> points_adj = dm.poly_verts_id(adj_pid); // id dei vertici di adj_pid
-                    std::set<uint> points_ids;
-                    std::vector<vec3d> points;
-                    for (uint p : points_pid)   points_ids.insert(p);
-                    for (uint p : points_adj)   points_ids.insert(p);
-                    for (uint p : points_ids)   points.push_back(dm.vert(p));
-
-                    double diameter = -inf_double;
+                for (uint pid = 0; pid < m->num_polys(); pid++)
+                {
+                    double max_pd = -inf_double;
+                    std::vector<vec3d> points = m->poly_verts(pid);
                     for(uint i=0; i<points.size()-1; ++i)
                         for(uint j=i+1; j<points.size(); ++j)
-                            diameter = std::max(diameter, points.at(i).dist(points.at(j)));
-
-                    if (aggregation_type == 0)
-                    {
-                        value2pid.insert(std::pair<double, std::pair<uint,uint>> (diameter, std::pair<uint,uint> (adj_pid, pid)));
-                    }
-                    else
-                    if (aggregation_type == 1)
-                    {
-                        double val = rand() % 1000;
-
-                        //if (dm.poly_verts(pid).size()>3 && dm.poly_verts(adj_pid).size()>3 )
-                        if (dm.num_polys() <= 50)
-                            val = 1000 + val;
+                        {
+                            max_pd = std::max(max_pd, points.at(i).dist(points.at(j)));
 
-                        value2pid.insert(std::pair<double, std::pair<uint,uint>> (val, std::pair<uint,uint> (adj_pid, pid)));
+                            if (m->poly_data(pid).flags.test(1))
+                            {
+                                diameter = std::max(diameter, max_pd);
+                            }
+                        }
 
-                        break;
-                    }
-                    else
-                    if (aggregation_type == 2)
+                    if (aggregation_type == 1)
                     {
                         double min_e = inf_double;
-                        for (auto eid : dm.adj_p2e(pid))
-                            if(!(dm.poly_contains_edge(adj_pid,eid)))
-                                min_e = std::min(min_e, dm.edge_length(eid));
+                        for (auto eid : m->adj_p2e(pid))
+                            min_e = std::min(min_e, m->edge_length(eid));
 
-                        for (auto eid : dm.adj_p2e(adj_pid))
-                            if(!(dm.poly_contains_edge(pid,eid)))
-                                min_e = std::min(min_e, dm.edge_length(eid));
+                        double area = m->poly_area(pid);
 
-                        double area = dm.poly_area(pid) + dm.poly_area(adj_pid);
-                        double rho = diameter / std::min(sqrt(area), min_e);
-
-                        value2pid.insert(std::pair<double, std::pair<uint,uint>> (rho, std::pair<uint,uint> (adj_pid, pid)));
+                        rho = std::max(rho, max_pd / std::min(sqrt(area), min_e));
                     }
-                    else if (aggregation_type == 3)
+                    else if (aggregation_type == 2)
                     {
                         double min_e = inf_double;
-                        for (auto eid : dm.adj_p2e(pid))
-                            if(!(dm.poly_contains_edge(adj_pid,eid)))
-                                min_e = std::min(min_e, dm.edge_length(eid));
-
-                        for (auto eid : dm.adj_p2e(adj_pid))
-                            if(!(dm.poly_contains_edge(pid,eid)))
-                                min_e = std::min(min_e, dm.edge_length(eid));
+                        for (auto eid : m->adj_p2e(pid))
+                            min_e = std::min(min_e, m->edge_length(eid));
 
-                        double area = dm.poly_area(pid) + dm.poly_area(adj_pid);
-                        double rho = diameter / std::min(sqrt(area), min_e);
-                        double rho_a = rho * rho * area;
+                        double area = m->poly_area(pid);
 
-                        value2pid.insert(std::pair<double, std::pair<uint,uint>> (rho_a, std::pair<uint,uint> (adj_pid, pid)));
+                        rho = max_pd / std::min(sqrt(area), min_e);
+                        rho_a = std::max(rho_a, rho * rho * area);
                     }
-                    else return;
                 }
-            }
-        }
 
-        if (value2pid.empty())
-        {
-            ok = true;
-            break;
-        }
-
-
-        uint pid_tb_merged = (*value2pid.begin()).second.first;
-        uint pid_tb_merged_2 = (*value2pid.begin()).second.second;
-        double value = (*value2pid.begin()).first;
-
-        std::cout << value << std::endl;
-
-        if (value > value_b )    ok = true;
-        else        //se il valore è < di quello di bound, unisco
-        {
-                Polygonmesh<> *m = new Polygonmesh<> (dm.vector_verts(), {});
-
-                m->poly_add(dm.adj_p2v(pid_tb_merged_2));
-                m->poly_add(dm.adj_p2v(pid_tb_merged));
-
-//                m->save("prova.obj");
-
-                bool has_no_manifold = false;
-                bool has_hole = false;
-                std::vector<cinolib::ipair> be = m->get_boundary_edges();
-                std::vector<bool> visited (be.size(), false);
-                std::queue<cinolib::ipair> queue;
-                queue.push(be.at(0));
-                visited.at(0) =true;
-
-                while (!queue.empty())
+                for (uint e=0; e < n_elems; e++)
                 {
-                    cinolib::ipair e = queue.front();
-                    queue.pop();
-
-                    for (uint i=0; i < be.size(); i++)
-                    {
-                        if (visited.at(i)) continue;
-
-                        if (be.at(i).first == e.first || be.at(i).first == e.second ||
-                                be.at(i).second == e.first || be.at(i).second == e.second )
-                        {
-                            queue.push(be.at(i));
-                            visited.at(i) =true;
+                    if (m->poly_data(m->num_polys()-(e+1)).flags.test(1)) continue;
 
-                        }
-                    }
+                    m->poly_data(m->num_polys()-(e+1)).flags.set(1, true);
+                    changed.at(b) = 1;
                 }
 
-                uint count_visisted = 0;
+                double value;
+                if      (aggregation_type == 0)     value = diameter;
+                else if (aggregation_type == 1)     value = 1000;
+                else if (aggregation_type == 2)     value = rho;
+                else                                value = rho_a;
 
-                for (bool b : visited)
-                    if (b) count_visisted++;
+                if (aggregation_mode == PARALLEL_AGGREGATION)
+                    aggregate_triangles_parallel(*m, value, aggregation_type, seed);
+                else if (aggregation_mode == MULTILEVEL_AGGREGATION)
+                    aggregate_triangles_multilevel(*m, value, aggregation_type, target_polys, seed);
+                else
+                    aggregate_triangles(*m, value, aggregation_type);
 
-                has_hole = (! (count_visisted == be.size()));
+                // every merge removes a polygon
+                if (m->num_polys() != num_polys)
+                    changed.at(b) = 1;
 
+                if (m == shown)
+                    render_queue->enqueue(m);
 
-                for (uint i=0; i < be.size()-1; i++)
+                if (!out_folder.empty())
                 {
-                    uint count_first = 0;
-                    uint count_sec = 0;
+                    std::string filename = m->mesh_data().filename.substr(m->mesh_data().filename.find_last_of("/")+1);
+                    if (filename.empty()) filename = std::to_string(mid) + ".obj";
 
-                    for (uint j=i+1; j < be.size(); j++)
+                    filename = out_folder + "/" + filename;
+
+                    writer.push(filename, [m, filename]()
                     {
-                        if (be.at(i).first == be.at(j).first || be.at(i).first == be.at(j).second)
-                            count_first++;
+                        m->save(filename.c_str());
+                        return std::ifstream(filename).good();
+                    });
+                }
 
-                        if (be.at(i).second == be.at(j).first || be.at(i).second == be.at(j).second)
-                            count_sec++;
+                task.step_done();
+            }
 
-                        if (count_first > 1 || count_sec > 1 )
-                        {
-                            has_no_manifold = true;
-                            break;
-                            //std::cout << "[" << be.at(i).first << ", " << be.at(i).second << "] edge is not manifold" << std::endl;
-                        }
-                    }
+            // the writer reads the meshes: they stay pinned until written
+            writer.finish();
 
-                    if (has_no_manifold) break;
+            // aggregated meshes differ from their files: they stay resident
+            // from now on, the others can be evicted again
+            on_gui_thread([&]()
+            {
+                for (uint b=0; b < batch.size(); b++)
+                {
+                    if (changed.at(b)) dataset->set_parametric_mesh_modified(batch.at(b));
+                    dataset->unpin_parametric_mesh(batch.at(b));
                 }
+            });
+        }
+    });
 
+    render_queue->flush();
+    resume_prefetch();
 
-                if (!has_no_manifold && !has_hole)
-                {
-                    std::vector<uint> verts = m->get_ordered_boundary_vertices();
-                    std::vector<uint> bverts = verts;
+    emit (meshes_edited());
 
-                    bool has_dupl = false;
-                    std::sort(bverts.begin(), bverts.end());
-                    for (uint i=0; i < bverts.size()-1; i++)
-                    {
-                        if (bverts.at(i) == bverts.at(i+1))
-                            has_dupl = true;
-                    }
+    if (!out_folder.empty())
+        ui->log_label->append((std::to_string(writer.get_num_written()) + " aggregated meshes saved in " + out_folder).c_str());
 
-                    if (!has_dupl)
-                    {
+    for (const std::string &f : writer.get_failed_files())
+        ui->log_label->append(("Unable to write " + f).c_str());
 
-                        dm.poly_add(verts);
+    if (!completed)
+    {
+        ui->log_label->append("Aggregation canceled: the remaining meshes have not been aggregated.");
+        return;
+    }
 
-                        delete  m;
-                        dm.poly_remove(std::max (pid_tb_merged_2, pid_tb_merged));
-                        dm.poly_remove(std::min (pid_tb_merged_2, pid_tb_merged));
-                    }
-                }
+    ui->log_label->append("DONE");
 
-        }
-    }
+    ui->aggregate_btn->setEnabled(false);
+    ui->save_btn->setEnabled(true);
 }
 
 void DatasetWidget::on_mirroring_btn_clicked()
@@ -1623,10 +1690,15 @@ void DatasetWidget::on_mirroring_btn_clicked()
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    uint index=0;
+    prefetcher->invalidate();
 
-    for (cinolib::DrawablePolygonmesh<> *mesh : dataset->get_parametric_meshes())
+    // one mesh at a time is pinned, so that the whole dataset is never resident
+    for (uint index=0; index < dataset->get_num_parametric_meshes(); index++)
     {
+        cinolib::DrawablePolygonmesh<> *mesh = dataset->pin_parametric_mesh(index);
+
+        const uint num_polys = mesh->num_polys();
+
         std::string message = "Mirriring mesh " + std::to_string(index) + ": " +
                                                   std::to_string(mesh->num_verts()) + "V|" +
                                                   std::to_string(mesh->num_polys()) + "P" ;
@@ -1637,7 +1709,8 @@ void DatasetWidget::on_mirroring_btn_clicked()
         //mesh->edge_unmark_all();
         mesh->edge_mark_boundaries();
 
-        mesh->updateGL();
+        if (mesh == displayed_mesh)
+            mesh->updateGL();
 
         message = "--> Mirrired mesh " + std::to_string(index) + ": " +
                                          std::to_string(mesh->num_verts()) + "V|" +
@@ -1645,16 +1718,170 @@ void DatasetWidget::on_mirroring_btn_clicked()
 
         ui->log_label->append(message.c_str());
 
-        index++;
+        // mirrored meshes differ from their files: they stay resident from now on
+        if (mesh->num_polys() != num_polys)
+            dataset->set_parametric_mesh_modified(mesh);
+
+        dataset->unpin_parametric_mesh(mesh);
     }
 
     ui->canvas->updateGL();
 
+    resume_prefetch();
+
+    emit (meshes_edited());
+
     QApplication::restoreOverrideCursor();
 
     ui->mirroring_btn->setEnabled(true);
 }
 
+void DatasetWidget::on_tiling_btn_clicked()
+{
+    bool ok = false;
+
+    int nx = QInputDialog::getInt(this, "Tiling", "Number of columns (N)", 2, 1, 10000, 1, &ok);
+    if (!ok) return;
+
+    int ny = QInputDialog::getInt(this, "Tiling", "Number of rows (M)", nx, 1, 10000, 1, &ok);
+    if (!ok) return;
+
+    QStringList modes;
+    modes << "Periodic" << "Reflected";
+    QString mode_name = QInputDialog::getItem(this, "Tiling", "Arrangement", modes, 0, false, &ok);
+    if (!ok) return;
+
+    int mode = (mode_name == "Reflected") ? REFLECTED_TILING : PERIODIC_TILING;
+
+    if (dataset->get_num_parametric_meshes() == 0) return;
+
+    // the result grows as N x M: its size is estimated on the displayed mesh
+    // (or on the first one), the meshes of a dataset being alike
+    const DrawablePolygonmesh<> *sample = (displayed_mesh != nullptr) ? displayed_mesh : dataset->get_parametric_mesh(0);
+
+    const uint64_t n_tiles     = static_cast<uint64_t>(nx) * static_cast<uint64_t>(ny);
+    const uint64_t tiled_verts = n_tiles * sample->num_verts();
+    const uint64_t tiled_polys = n_tiles * sample->num_polys();
+    const uint64_t total_polys = tiled_polys * dataset->get_num_parametric_meshes();
+
+    // vertex, edge and polygon ids are 32 bit (edges are about V + P)
+    if (tiled_verts + tiled_polys >= UINT_MAX)
+    {
+        QMessageBox *m = new QMessageBox (this);
+
+        m->setText(("ERROR: A " + std::to_string(nx) + " x " + std::to_string(ny) + " tiling would produce about " +
+                    std::to_string(tiled_polys) + " polygons per mesh, more than a mesh can hold."
+                    "\n\nPlease choose fewer tiles.").c_str());
+        m->exec();
+
+        return;
+    }
+
+    // tiled meshes are not on disk, they all stay resident
+    const uint64_t max_tiled_polys = 10000000;
+
+    if (total_polys > max_tiled_polys)
+    {
+        QMessageBox *m = new QMessageBox (this);
+
+        m->setText(("A " + std::to_string(nx) + " x " + std::to_string(ny) + " tiling will produce about " +
+                    std::to_string(tiled_polys) + " polygons per mesh, " + std::to_string(total_polys) +
+                    " in the whole dataset, all kept in memory until saved."
+                    "\n\nDo you want to continue?").c_str());
+        m->setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+        m->setDefaultButton(QMessageBox::No);
+
+        if (m->exec() != QMessageBox::Yes) return;
+    }
+
+    ui->tiling_btn->setEnabled(false);
+
+    // the prefetcher must not rebuild render data while the workers edit the meshes
+    prefetcher->invalidate();
+
+    const uint n_meshes = dataset->get_num_parametric_meshes();
+
+    BackgroundTask task (this, "Tiling meshes ...", n_meshes);
+
+    // the dataset is only touched on this thread, which runs the event loop
+    // of the task
+    auto on_gui_thread = [this](const std::function<void()> &f)
+    {
+        QMetaObject::invokeMethod(this, f, Qt::BlockingQueuedConnection);
+    };
+
+    // meshes are pinned a batch at a time, so that the whole dataset is never resident
+    uint batch_size = 16;
+#ifdef _OPENMP
+    batch_size = std::max(batch_size, 4 * static_cast<uint>(omp_get_max_threads()));
+#endif
+
+    // render data are only needed by the displayed mesh
+    DrawablePolygonmesh<> *shown = displayed_mesh;
+
+    task.run([&]()
+    {
+        for (uint first=0; first < n_meshes && !task.is_canceled(); first += batch_size)
+        {
+            const uint last = std::min(n_meshes, first + batch_size);
+
+            std::vector<DrawablePolygonmesh<> *> batch;
+            std::vector<uint8_t> tiled (last - first, 0);
+
+            on_gui_thread([&]()
+            {
+                for (uint i=first; i < last; i++)
+                    batch.push_back(dataset->pin_parametric_mesh(i));
+            });
+
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (int b=0; b < static_cast<int>(batch.size()); b++)
+            {
+                if (task.is_canceled()) continue;
+
+                DrawablePolygonmesh<> *m = batch.at(b);
+
+                const uint num_polys = m->num_polys();
+
+                apply_tiling(*m, static_cast<uint>(nx), static_cast<uint>(ny), mode);
+                m->edge_mark_boundaries();
+
+                tiled.at(b) = (m->num_polys() != num_polys) ? 1 : 0;
+
+                if (m == shown)
+                    render_queue->enqueue(shown);
+
+                task.step_done();
+            }
+
+            // tiled meshes differ from their files: they stay resident from
+            // now on, the others can be evicted again
+            on_gui_thread([&]()
+            {
+                for (uint b=0; b < batch.size(); b++)
+                {
+                    DrawablePolygonmesh<> *mesh = batch.at(b);
+
+                    std::string message = "--> Tiled mesh " + std::to_string(first + b) + ": " +
+                                                              std::to_string(mesh->num_verts()) + "V|" +
+                                                              std::to_string(mesh->num_polys()) + "P";
+                    ui->log_label->append(message.c_str());
+
+                    if (tiled.at(b)) dataset->set_parametric_mesh_modified(mesh);
+                    dataset->unpin_parametric_mesh(mesh);
+                }
+            });
+        }
+    });
+
+    render_queue->flush();
+    resume_prefetch();
+
+    emit (meshes_edited());
+
+    ui->tiling_btn->setEnabled(true);
+}
+
 void DatasetWidget::on_show_coords_cb_stateChanged(int checked)
 {
     if (!checked)
@@ -1670,14 +1897,25 @@ void DatasetWidget::on_show_coords_cb_stateChanged(int checked)
 
 void DatasetWidget::on_highlight_polys_cb_stateChanged(int checked)
 {
-    #pragma omp parallel for
-    for (uint i=0; i < dataset->get_num_parametric_meshes(); i++)
-    {
-        DrawablePolygonmesh<> *m = dataset->get_parametric_mesh(i);
+    // meshes are loaded on demand: only the displayed one has render data to
+    // update, its neighbors are prefetched again
+    prefetcher->invalidate();
 
-        m->show_marked_edge(checked);
-        m->updateGL();
+    if (displayed_mesh != nullptr)
+    {
+        render_queue->enqueue(displayed_mesh, [checked](DrawablePolygonmesh<> *m)
+        {
+            m->show_marked_edge(checked);
+            m->updateGL();
+        });
     }
 
-    ui->canvas->updateGL();
+    resume_prefetch();
+}
+
+void DatasetWidget::on_memory_budget_sb_valueChanged(int mb)
+{
+    if (dataset == nullptr) return;
+
+    dataset->set_memory_budget(static_cast<size_t>(mb) * 1024 * 1024);
 }
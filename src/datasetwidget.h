@@ -34,6 +34,8 @@
 #define DATASETWIDGET_H
 
 #include "dataset.h"
+#include "meshprefetcher.h"
+#include "renderupdatequeue.h"
 
 #include "meshes/mesh_metrics.h"
 #include "meshes/vem_elements.h"
@@ -68,10 +70,13 @@ public:
 
   Dataset *get_dataset() { return dataset; }
 
-  void set_dataset(Dataset *d) { dataset = d; }
+  void set_dataset(Dataset *d);
 
   void compute_geometric_metrics();
 
+  // the render data of the prefetched meshes are stale (e.g. their color mode changed)
+  void drop_prefetched_meshes() { prefetcher->invalidate(); }
+
 public slots:
 
   void polygon_zoom_in();
@@ -104,10 +109,14 @@ private slots:
 
   void on_mirroring_btn_clicked();
 
+  void on_tiling_btn_clicked();
+
   void on_show_coords_cb_stateChanged(int checked);
 
   void on_highlight_polys_cb_stateChanged(int checked);
 
+  void on_memory_budget_sb_valueChanged(int mb);
+
 Q_SIGNALS:
 
   void computed_mesh_metrics();
@@ -117,6 +126,9 @@ Q_SIGNALS:
 
   void saved_in(const std::string folder);
 
+  // aggregation, mirroring or tiling have edited the meshes of the dataset
+  void meshes_edited();
+
 private:
     Ui::DatasetWidget *ui;
 
@@ -144,6 +156,12 @@ private:
 
     Dataset *dataset = nullptr;
 
+    DrawablePolygonmesh<> *displayed_mesh = nullptr;   // pinned while on the canvas
+    uint                   displayed_id   = 0;
+
+    RenderUpdateQueue *render_queue = nullptr;         // render data edited by the workers
+    MeshPrefetcher    *prefetcher   = nullptr;         // neighbors of the displayed mesh
+
     std::string dataset_folder;
 
     bool enable_add_polygon = true;
@@ -153,6 +171,10 @@ private:
     void deform_elem (const double value, const bool with_canvas = false);
 
     void clean_canvas ();
+    void prepare_render_data (DrawablePolygonmesh<> *m) const;
+
+    // prefetches again the neighbors of the displayed mesh, after an invalidate
+    void resume_prefetch ();
 
     void add_polygon (cinolib::GLcanvas *canvas, QMouseEvent *event) ;
     void add_polygon (const SelectedPolyData selected_poly, const cinolib::vec2d &pos = cinolib::vec2d(0.5, 0.5), const bool scale_to_fit = true);
@@ -168,8 +190,6 @@ private:
 
     void polygon_zoom_in (DrawablePolygonmesh<> *m);
     void polygon_zoom_out (DrawablePolygonmesh<> *m);
-
-    void aggregate_triangles (Polygonmesh<> &m, const double value_bound, const int flag);
 };
 
 #endif // DATASETWIDGET_H
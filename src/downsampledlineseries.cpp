@@ -0,0 +1,160 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "downsampledlineseries.h"
+
+#include <QtCharts/QChart>
+
+#include <algorithm>
+#include <cmath>
+
+DownsampledLineSeries::DownsampledLineSeries(QObject *parent) : QLineSeries(parent)
+{
+}
+
+void DownsampledLineSeries::set_points(const QVector<QPointF> &p)
+{
+    points = p;
+    update_points();
+}
+
+void DownsampledLineSeries::track_axis(QValueAxis *axis_x)
+{
+    if (axis_x == nullptr) return;
+
+    x_min = axis_x->min();
+    x_max = axis_x->max();
+    has_range = true;
+
+    connect(axis_x, SIGNAL(rangeChanged(qreal, qreal)), this, SLOT(on_axis_range_changed(qreal, qreal)));
+
+    if (chart() != nullptr)
+        connect(chart(), SIGNAL(plotAreaChanged(const QRectF &)), this, SLOT(update_points()));
+
+    update_points();
+}
+
+void DownsampledLineSeries::on_axis_range_changed(qreal min, qreal max)
+{
+    x_min = min;
+    x_max = max;
+    has_range = true;
+
+    update_points();
+}
+
+void DownsampledLineSeries::update_points()
+{
+    if (points.empty())
+    {
+        clear();
+        return;
+    }
+
+    // visible points, plus one on each side so that the lines
+    // leaving the plot area keep their slope
+    int first = 0;
+    int last  = points.size();
+
+    if (has_range)
+    {
+        auto x_less = [] (const QPointF &p, const qreal x) { return p.x() < x; };
+        auto less_x = [] (const qreal x, const QPointF &p) { return x < p.x(); };
+
+        first = static_cast<int>(std::lower_bound(points.begin(), points.end(), x_min, x_less) - points.begin());
+        last  = static_cast<int>(std::upper_bound(points.begin(), points.end(), x_max, less_x) - points.begin());
+
+        first = std::max(first - 1, 0);
+        last  = std::min(last + 1, points.size());
+    }
+
+    if (last <= first)
+    {
+        clear();
+        return;
+    }
+
+    int n_buckets = 1024;
+    if (chart() != nullptr && chart()->plotArea().width() >= 1.0)
+        n_buckets = static_cast<int>(std::ceil(chart()->plotArea().width()));
+
+    if (last - first <= 2 * n_buckets)
+    {
+        replace(points.mid(first, last - first));
+        return;
+    }
+
+    const qreal x0 = points.at(first).x();
+    const qreal dx = points.at(last-1).x() - x0;
+
+    auto bucket_of = [&] (const qreal x)
+    {
+        if (!(dx > 0.0)) return 0;
+        const int b = static_cast<int>((x - x0) / dx * n_buckets);
+        return std::min(std::max(b, 0), n_buckets - 1);
+    };
+
+    QVector<QPointF> shown;
+    shown.reserve(2 * n_buckets + 2);
+
+    // the first and the last point are always kept
+    shown.append(points.at(first));
+
+    int i = first;
+    while (i < last)
+    {
+        const int b = bucket_of(points.at(i).x());
+
+        int i_min = i;
+        int i_max = i;
+        int j = i + 1;
+
+        while (j < last && bucket_of(points.at(j).x()) == b)
+        {
+            if (points.at(j).y() < points.at(i_min).y()) i_min = j;
+            if (points.at(j).y() > points.at(i_max).y()) i_max = j;
+            j++;
+        }
+
+        const int i_a = std::min(i_min, i_max);
+        const int i_b = std::max(i_min, i_max);
+
+        if (i_a != first) shown.append(points.at(i_a));
+        if (i_b != i_a && i_b != last-1) shown.append(points.at(i_b));
+
+        i = j;
+    }
+
+    if (last-1 != first) shown.append(points.at(last-1));
+
+    replace(shown);
+}
@@ -0,0 +1,78 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef DOWNSAMPLEDLINESERIES_H
+#define DOWNSAMPLEDLINESERIES_H
+
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QValueAxis>
+#include <QVector>
+#include <QPointF>
+QT_CHARTS_USE_NAMESPACE
+
+// A line series that keeps all its points but only shows, for each pixel
+// column of the plot area, the min and the max of the points falling in it.
+// Lines drawn this way look the same as the full ones and keep all the peaks,
+// while the number of points handed to the chart stays bounded by twice the
+// plot width. The shown points are recomputed, and pushed with a single
+// replace(), when the tracked x axis is zoomed or the plot area resized.
+// Points must be sorted by x.
+class DownsampledLineSeries : public QLineSeries
+{
+    Q_OBJECT
+public:
+    DownsampledLineSeries (QObject *parent = nullptr);
+
+    void set_points (const QVector<QPointF> &points);
+    const QVector<QPointF> & full_points () const { return points; }
+
+    // To be called once the series is in a chart and its axes are created
+    void track_axis (QValueAxis *axis_x);
+
+public Q_SLOTS:
+
+    void update_points ();
+
+private Q_SLOTS:
+
+    void on_axis_range_changed (qreal min, qreal max);
+
+private:
+
+    QVector<QPointF> points;
+
+    qreal x_min = 0.0;
+    qreal x_max = 0.0;
+    bool  has_range = false;
+};
+
+#endif // DOWNSAMPLEDLINESERIES_H
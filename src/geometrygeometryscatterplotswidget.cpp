@@ -41,6 +41,8 @@
 #include <QToolTip>
 #include <QtCharts/QLogValueAxis>
 
+#include <algorithm>
+
 GeometryGeometryScatterPlotsWidget::GeometryGeometryScatterPlotsWidget(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::GeometryGeometryScatterPlotsWidget)
@@ -64,6 +66,10 @@ GeometryGeometryScatterPlotsWidget::GeometryGeometryScatterPlotsWidget(QWidget *
 
     ui->marker_settings_widget->setLayout(new QVBoxLayout());
 
+    chart_cache = new ScatterChartCache(ui->stackedWidget);
+
+    connect(ui->marker_size_dsb, SIGNAL(valueChanged(double)), this, SLOT (update_marker_size (double)));
+
     extra_colors.push_back(QColor(255, 192, 203));
     extra_colors.push_back(QColor(211, 211, 211));
     extra_colors.push_back(QColor(0, 0, 139));
@@ -73,254 +79,173 @@ GeometryGeometryScatterPlotsWidget::GeometryGeometryScatterPlotsWidget(QWidget *
 
 GeometryGeometryScatterPlotsWidget::~GeometryGeometryScatterPlotsWidget()
 {
+    delete chart_cache;
     delete ui;
 }
 
 void GeometryGeometryScatterPlotsWidget::create_scatterPlots(const Dataset &d, const std::vector<MeshMetrics> &metrics)
 {
-    std::vector<uint> class_chages;
-    class_chages.push_back(0);
+    chart_cache->clear();
+
+    for (ScatterPlotMarkerSettingWidget *msw : marker_settings_widgets)
+        msw->deleteLater();
+
+    marker_settings_widgets.clear();
+
+    class_changes.clear();
+    class_changes.push_back(0);
 
     for (uint i=1; i < d.get_num_parametric_meshes(); i++)
         if (d.get_parametric_mesh_class_id(i) != d.get_parametric_mesh_class_id(i-1))
-            class_chages.push_back(i);
+            class_changes.push_back(i);
 
-    class_chages.push_back(d.get_num_parametric_meshes());
+    class_changes.push_back(d.get_num_parametric_meshes());
 
-    for (int i=0; i < ui->x_axis_cb->count(); i++)
-    {
-        for (int j=0; j < ui->x_axis_cb->count(); j++)
-        {
-            QChart *ch = new QChart();
+    class_names.clear();
 
-            double maxX = -DBL_MAX;
-            double maxY = -DBL_MAX;
+    for (uint cc=0; cc < class_changes.size()-1; cc++)
+    {
+        std::string class_name = "Unknown";
+        if (d.get_num_parametric_meshes() > 0)
+            class_name = d.get_parametric_mesh_class_name(d.get_parametric_mesh_class_id(class_changes.at(cc))).c_str();
 
-            for (uint cc=0; cc < class_chages.size()-1; cc++)
-            {
-                std::string class_name = "Unknown";
-                if (d.get_num_parametric_meshes() > 0)
-                    class_name = d.get_parametric_mesh_class_name(d.get_parametric_mesh_class_id(class_chages.at(cc))).c_str();
+        class_names.push_back(class_name);
+    }
 
-                QScatterSeries *s = new QScatterSeries();
-                s->setName(class_name.c_str());
+    // the values of each metric are computed once, and shared by all the
+    // charts having it on one of their axes. Charts are built when shown
+    values.assign(cbID2metricsID.size(), std::vector<double>(d.get_num_parametric_meshes()));
 
-                if (cc > 4)
-                    s->setColor(extra_colors.at(cc-5));
+    for (uint c=0; c < cbID2metricsID.size(); c++)
+    {
+        const uint metric_id = cbID2metricsID.at(c);
+        const bool log_scale = (metric_id == 8 || metric_id >= 13);
 
-                for (uint m=class_chages.at(cc); m < class_chages.at(cc+1); m++)
-                {
-                    double x, y;
+        for (uint m=0; m < d.get_num_parametric_meshes(); m++)
+        {
+            const double v = mesh_metric_value(metrics.at(m), metric_id);
+            values.at(c).at(m) = log_scale ? log(v) : v;
+        }
+    }
 
-                    double min_IC = std::min(metrics.at(m).IC_min,
-                                             metrics.at(m).IC_poly_min);
+    // marker settings are taken from the first chart, and applied to all
+    // the charts built afterwards
+    marker_sizes.clear();
+    marker_colors.clear();
+    marker_visible.clear();
 
-                    if (metrics.at(m).IC_min_id == UINT_MAX) min_IC = metrics.at(m).IC_poly_min;
-                    else if (metrics.at(m).IC_poly_min_id == UINT_MAX) min_IC = metrics.at(m).IC_min;
+    ui->x_axis_cb->blockSignals(true);
+    ui->y_axis_cb->blockSignals(true);
+    ui->x_axis_cb->setCurrentIndex(0);
+    ui->y_axis_cb->setCurrentIndex(0);
+    ui->x_axis_cb->blockSignals(false);
+    ui->y_axis_cb->blockSignals(false);
 
-                    double min_CC = std::min(metrics.at(m).CC_min,
-                                             metrics.at(m).CC_poly_min);
+    show_current_plot();
 
-                    if (metrics.at(m).CC_min_id == UINT_MAX) min_CC = metrics.at(m).CC_poly_min;
-                    else if (metrics.at(m).CC_poly_min_id == UINT_MAX) min_CC = metrics.at(m).CC_min;
+    QChart *first = chart_view(0, 0)->chart();
 
-                    double min_CR = std::min(metrics.at(m).CR_min,
-                                             metrics.at(m).CR_poly_min);
+    for (uint cc=0; cc < class_names.size(); cc++)
+    {
+        QScatterSeries * s = static_cast<QScatterSeries*>(first->series()[static_cast<int>(cc)]);
 
-                    if (metrics.at(m).CR_min_id == UINT_MAX) min_CR = metrics.at(m).CR_poly_min;
-                    else if (metrics.at(m).CR_poly_min_id == UINT_MAX) min_CR = metrics.at(m).CR_min;
+        marker_sizes.push_back(s->markerSize());
+        marker_colors.push_back(s->color());
+        marker_visible.push_back(true);
 
-                    double min_AR = std::min(metrics.at(m).AR_min,
-                                             metrics.at(m).AR_poly_min);
+        ScatterPlotMarkerSettingWidget * msw = new ScatterPlotMarkerSettingWidget();
+        msw->update_series_name(class_names.at(cc).c_str());
+        msw->set_checked(true);
 
-                    if (metrics.at(m).AR_min_id == UINT_MAX) min_AR = metrics.at(m).AR_poly_min;
-                    else if (metrics.at(m).AR_poly_min_id == UINT_MAX) min_AR = metrics.at(m).AR_min;
+        ui->marker_size_dsb->setValue(s->markerSize());
+        msw->set_marker_size(s->markerSize());
+        msw->set_id(cc);
+        msw->set_color(s->color());
 
-                    double min_KE = std::min(metrics.at(m).KE_min,
-                                             metrics.at(m).KE_poly_min);
+        connect(msw, SIGNAL(size_changed(uint, double)), this, SLOT (update_marker_size (uint, double)));
+        connect(msw, SIGNAL(checked_changed(uint, int)), this, SLOT (update_show_series (uint, int)));
+        connect(msw, SIGNAL(color_changed(uint, QColor)), this, SLOT (update_color_series (uint, QColor)));
 
-                    if (metrics.at(m).KE_min_id == UINT_MAX) min_KE = metrics.at(m).KE_poly_min;
-                    else if (metrics.at(m).KE_poly_min_id == UINT_MAX) min_KE = metrics.at(m).KE_min;
+        ui->marker_settings_widget->layout()->addWidget(msw);
+        marker_settings_widgets.push_back(msw);
+    }
+}
 
-                    double min_KAR = std::min(metrics.at(m).KAR_min,
-                                              metrics.at(m).KAR_poly_min);
+CustomizedChartView * GeometryGeometryScatterPlotsWidget::build_chart(const int xID, const int yID) const
+{
+    QChart *ch = new QChart();
 
-                    if (metrics.at(m).KAR_min_id == UINT_MAX) min_KAR = metrics.at(m).KAR_poly_min;
-                    else if (metrics.at(m).KAR_poly_min_id == UINT_MAX) min_KAR = metrics.at(m).KAR_min;
+    const std::vector<double> &x = values.at(static_cast<uint>(xID));
+    const std::vector<double> &y = values.at(static_cast<uint>(yID));
 
-                    double min_APR = std::min(metrics.at(m).APR_min,
-                                              metrics.at(m).APR_poly_min);
+    for (uint cc=0; cc < class_names.size(); cc++)
+    {
+        QScatterSeries *s = new QScatterSeries();
+        s->setName(class_names.at(cc).c_str());
 
-                    if (metrics.at(m).APR_min_id == UINT_MAX) min_APR = metrics.at(m).APR_poly_min;
-                    else if (metrics.at(m).APR_poly_min_id == UINT_MAX) min_APR = metrics.at(m).APR_min;
+        if (cc > 4)
+            s->setColor(extra_colors.at(cc-5));
 
-                    double min_MA = std::min(metrics.at(m).MA_min,
-                                             metrics.at(m).MA_poly_min);
+        QVector<QPointF> points;
+        points.reserve(static_cast<int>(class_changes.at(cc+1) - class_changes.at(cc)));
 
-                    if (metrics.at(m).MA_min_id == UINT_MAX) min_MA = metrics.at(m).MA_poly_min;
-                    else if (metrics.at(m).MA_poly_min_id == UINT_MAX) min_MA = metrics.at(m).MA_min;
+        for (uint m=class_changes.at(cc); m < class_changes.at(cc+1); m++)
+            points.append(QPointF(x.at(m), y.at(m)));
 
-                    double min_SE = std::min(metrics.at(m).SE_min,
-                                             metrics.at(m).SE_poly_min);
-                    min_SE = log(min_SE);
-
-                    if (metrics.at(m).SE_min_id == UINT_MAX) min_SE = metrics.at(m).SE_poly_min;
-                    else if (metrics.at(m).SE_poly_min_id == UINT_MAX) min_SE = metrics.at(m).SE_min;
-
-                    double min_ER = std::min(metrics.at(m).ER_min,
-                                             metrics.at(m).ER_poly_min);
-
-                    if (metrics.at(m).ER_min_id == UINT_MAX) min_ER = metrics.at(m).ER_poly_min;
-                    else if (metrics.at(m).ER_poly_min_id == UINT_MAX) min_ER = metrics.at(m).ER_min;
-
-                    double min_MPD = std::min(metrics.at(m).MPD_min,
-                                             metrics.at(m).MPD_poly_min);
-
-                    if (metrics.at(m).MPD_min_id == UINT_MAX) min_MPD = metrics.at(m).MPD_poly_min;
-                    else if (metrics.at(m).MPD_poly_min_id == UINT_MAX) min_MPD = metrics.at(m).MPD_min;
-
-                    double min_NS = std::min(metrics.at(m).NS_min,
-                                             metrics.at(m).NS_poly_min);
-
-                    if (metrics.at(m).NS_min_id == UINT_MAX) min_NS = metrics.at(m).NS_poly_min;
-                    else if (metrics.at(m).NS_poly_min_id == UINT_MAX) min_NS = metrics.at(m).NS_min;
-
-                    double min_MXA = std::min(metrics.at(m).MXA_min,
-                                              metrics.at(m).MXA_poly_min);
-
-                    if (metrics.at(m).MXA_min_id == UINT_MAX) min_MXA = metrics.at(m).MXA_poly_min;
-                    else if (metrics.at(m).MXA_poly_min_id == UINT_MAX) min_MXA = metrics.at(m).MXA_min;
-
-                    double min_SR = std::min(metrics.at(m).SR_min,
-                                             metrics.at(m).SR_poly_min);
-                    min_SR = log(min_SR);
-
-                    if (metrics.at(m).SR_min_id == UINT_MAX) min_SR = metrics.at(m).SR_poly_min;
-                    else if (metrics.at(m).SR_poly_min_id == UINT_MAX) min_SR = metrics.at(m).SR_min;
-
-                    double max_VEM = std::max(metrics.at(m).VEM_max, metrics.at(m).VEM_poly_max);
-                    max_VEM = log(max_VEM);
-
-                    if (metrics.at(m).VEM_max_id == UINT_MAX) max_VEM = metrics.at(m).VEM_poly_max;
-                    else if (metrics.at(m).VEM_poly_max_id == UINT_MAX) max_VEM = metrics.at(m).VEM_max;
-
-                    double sum_VEMA = sqrt(metrics.at(m).VEMA_sum + metrics.at(m).VEMA_poly_sum);
-                    sum_VEMA = log(sum_VEMA);
-
-                    std::cout <<min_SE<<" "<<max_VEM<<std::endl;
-                    std::cout <<min_SE<<" "<<sum_VEMA<<std::endl;
-
-                    switch (cbID2metricsID.at(i)) {
-                        case 0: x = min_IC; break;
-                        case 1: x = min_CC; break;
-                        case 2: x = min_CR; break;
-
-                        case 3: x = min_AR; break;
-                        case 4: x = min_KE; break;
-                        case 5: x = min_KAR; break;
-                        case 6: x = min_APR; break;
-                        case 7: x = min_MA; break;
-                        case 8: x = min_SE; break;
-                        case 9: x = min_ER; break;
-                        case 10: x = min_MPD; break;
-                        case 11: x = min_NS; break;
-                        case 12: x = min_MXA; break;
-                        case 13: x = min_SR; break;
-                        case 14: x = max_VEM; break;
-                        case 15: x = sum_VEMA; break;
-                    default: x = DBL_MAX;
-                    }
-                    switch (cbID2metricsID.at(j)) {
-                        case 0: y = min_IC; break;
-                        case 1: y = min_CC; break;
-                        case 2: y = min_CR; break;
-                        case 3: y = min_AR; break;
-                        case 4: y = min_KE; break;
-                        case 5: y = min_KAR; break;
-                        case 6: y = min_APR; break;
-                        case 7: y = min_MA; break;
-                        case 8: y = min_SE; break;
-                        case 9: y = min_ER; break;
-                        case 10: y = min_MPD; break;
-                        case 11: y = min_NS; break;
-                        case 12: y = min_MXA; break;
-                        case 13: y = min_SR; break;
-                        case 14: y = max_VEM; break;
-                        case 15: y = sum_VEMA; break;
-                    default: y = DBL_MAX;
-                    }
-                    s->append(x,y);
-
-                    if(x>maxX)  maxX=x;
-                    if(y>maxY)  maxY=y;
-                }
-                ch->addSeries(s);
-            }
-
-            ch->createDefaultAxes();
-
-//            QLogValueAxis *axisXlog = new QLogValueAxis();
-//            axisXlog->setLabelFormat("%e");
-//            axisXlog->setBase(10.0);
-//            axisXlog->setMax(maxX);
-//            ch->removeAxis(ch->axes().at(0));
-//            ch->addAxis(axisXlog, Qt::AlignBottom);
-
-//            QLogValueAxis *axisYlog = new QLogValueAxis();
-//            axisYlog->setLabelFormat("%e");
-//            axisYlog->setBase(10.0);
-//            axisYlog->setMax(maxY);
-//            ch->removeAxis(ch->axes().at(1));
-//            ch->addAxis(axisYlog, Qt::AlignLeft);
-
-            ch->axes()[0]->setTitleText(metrics_names.at(cbID2metricsID.at(i)).c_str());
-            ch->axes()[1]->setTitleText(metrics_names.at(cbID2metricsID.at(j)).c_str());
-
-            std::cout << chart_views.size() << " : " << metrics_names.at(cbID2metricsID.at(i)) <<
-                                               " - " << metrics_names.at(cbID2metricsID.at(j)) << std::endl;
-            CustomizedChartView *ch_view = new CustomizedChartView();
-            ch_view->setChart(ch);
-
-//            connect(ch_view, SIGNAL(clicked(double, double, double, double)),
-//                    this, SLOT (show_tooltip (double, double, double, double)));
-
-            chart_views.push_back(ch_view);
-            ui->stackedWidget->addWidget(ch_view);
-        }
+        s->replace(points);
+        ch->addSeries(s);
     }
-    ui->stackedWidget->setCurrentIndex(0);
 
-    ui->x_axis_cb->setCurrentIndex(0);
-    ui->y_axis_cb->setCurrentIndex(0);
+    ch->createDefaultAxes();
+
+    ch->axes()[0]->setTitleText(metrics_names.at(cbID2metricsID.at(static_cast<uint>(xID))).c_str());
+    ch->axes()[1]->setTitleText(metrics_names.at(cbID2metricsID.at(static_cast<uint>(yID))).c_str());
 
-    QScatterSeries * s = static_cast<QScatterSeries*>(chart_views.at(0)->chart()->series()[0]);
-    ui->marker_size_dsb->setValue(s->markerSize());
+    apply_marker_settings(ch);
 
-    for (uint cc=0; cc < class_chages.size()-1; cc++)
+    CustomizedChartView *ch_view = new CustomizedChartView();
+    ch_view->setChart(ch);
+
+//    connect(ch_view, SIGNAL(clicked(double, double, double, double)),
+//            this, SLOT (show_tooltip (double, double, double, double)));
+
+    return ch_view;
+}
+
+void GeometryGeometryScatterPlotsWidget::apply_marker_settings(QChart *ch) const
+{
+    for (int i=0; i < ch->series().count() && i < static_cast<int>(marker_sizes.size()); i++)
     {
-        std::string class_name = "Unknown";
+        QScatterSeries * s = static_cast<QScatterSeries*>(ch->series()[i]);
+        s->setMarkerSize(marker_sizes.at(static_cast<uint>(i)));
+        s->setColor(marker_colors.at(static_cast<uint>(i)));
+        s->setVisible(marker_visible.at(static_cast<uint>(i)));
+    }
+}
 
-        if (d.get_num_parametric_meshes() > 0)
-            class_name = d.get_parametric_mesh_class_name(d.get_parametric_mesh_class_id(class_chages.at(cc))).c_str();
+void GeometryGeometryScatterPlotsWidget::show_current_plot()
+{
+    int xID = ui->x_axis_cb->currentIndex();
+    int yID = ui->y_axis_cb->currentIndex();
 
-        ScatterPlotMarkerSettingWidget * msw = new ScatterPlotMarkerSettingWidget();
-        msw->update_series_name(class_name.c_str());
-        msw->set_checked(true);
+    if (xID < 0 || yID < 0 || values.empty()) return;
 
-        QScatterSeries * s = static_cast<QScatterSeries*>(chart_views.at(0)->chart()->series()[cc]);
-        ui->marker_size_dsb->setValue(s->markerSize());
-        msw->set_marker_size(s->markerSize());
-        msw->set_id(cc);
-        msw->set_color(s->color());
+    ui->stackedWidget->setCurrentWidget(chart_view(xID, yID));
+}
 
-        connect(msw, SIGNAL(size_changed(uint, double)), this, SLOT (update_marker_size (uint, double)));
-        connect(msw, SIGNAL(checked_changed(uint, int)), this, SLOT (update_show_series (uint, int)));
-        connect(msw, SIGNAL(color_changed(uint, QColor)), this, SLOT (update_color_series (uint, QColor)));
+CustomizedChartView * GeometryGeometryScatterPlotsWidget::chart_view(const int xID, const int yID)
+{
+    const int key = xID * ui->y_axis_cb->count() + yID;
 
-        ui->marker_settings_widget->layout()->addWidget(msw);
-        marker_settings_widgets.push_back(msw);
+    CustomizedChartView *ch_view = chart_cache->find(key);
+
+    if (ch_view == nullptr)
+    {
+        ch_view = build_chart(xID, yID);
+        chart_cache->insert(key, ch_view);
     }
-    connect(ui->marker_size_dsb, SIGNAL(valueChanged(double)), this, SLOT (update_marker_size (double)));
+
+    return ch_view;
 }
 
 void GeometryGeometryScatterPlotsWidget::show_scatterplot_x(int xID)
@@ -329,7 +254,7 @@ void GeometryGeometryScatterPlotsWidget::show_scatterplot_x(int xID)
 
     std::cout << xID << " - " << yID << std::endl;
 
-    ui->stackedWidget->setCurrentIndex(xID * ui->y_axis_cb->count()+ yID);
+    show_current_plot();
 }
 
 void GeometryGeometryScatterPlotsWidget::show_scatterplot_y(int yID)
@@ -338,46 +263,39 @@ void GeometryGeometryScatterPlotsWidget::show_scatterplot_y(int yID)
 
     std::cout << xID << " - " << yID << std::endl;
 
-    ui->stackedWidget->setCurrentIndex(xID * ui->y_axis_cb->count()+ yID);
+    show_current_plot();
 }
 
 void GeometryGeometryScatterPlotsWidget::update_marker_size(double size)
 {
-    for (CustomizedChartView *ch_view : chart_views)
-    {
-        for (int i=0; i < ch_view->chart()->series().count(); i++)
-        {
-            QScatterSeries * s = static_cast<QScatterSeries*>(ch_view->chart()->series()[i]);
-            s->setMarkerSize(size);
-        }
-    }
+    std::fill(marker_sizes.begin(), marker_sizes.end(), size);
+
+    for (const auto &item : chart_cache->charts())
+        apply_marker_settings(item.second->chart());
 }
 
 void GeometryGeometryScatterPlotsWidget::update_marker_size(uint id, double size)
 {
-    for (CustomizedChartView *ch_view : chart_views)
-    {
-        QScatterSeries * s = static_cast<QScatterSeries*>(ch_view->chart()->series()[id]);
-        s->setMarkerSize(size);
-    }
+    marker_sizes.at(id) = size;
+
+    for (const auto &item : chart_cache->charts())
+        apply_marker_settings(item.second->chart());
 }
 
 void GeometryGeometryScatterPlotsWidget::update_show_series(uint id, int b)
 {
-    for (CustomizedChartView *ch_view : chart_views)
-    {
-        QScatterSeries * s = static_cast<QScatterSeries*>(ch_view->chart()->series()[id]);
-        s->setVisible(b);
-    }
+    marker_visible.at(id) = b;
+
+    for (const auto &item : chart_cache->charts())
+        apply_marker_settings(item.second->chart());
 }
 
 void GeometryGeometryScatterPlotsWidget::update_color_series(uint id, QColor c)
 {
-    for (CustomizedChartView *ch_view : chart_views)
-    {
-        QScatterSeries * s = static_cast<QScatterSeries*>(ch_view->chart()->series()[id]);
-        s->setColor(c);
-    }
+    marker_colors.at(id) = c;
+
+    for (const auto &item : chart_cache->charts())
+        apply_marker_settings(item.second->chart());
 }
 
 void GeometryGeometryScatterPlotsWidget::show_tooltip(double posX, double posY, double x, double y)
@@ -395,8 +313,17 @@ void GeometryGeometryScatterPlotsWidget::on_save_btn_clicked()
     if (dir.isNull())
         return;
 
-    for (QChartView *chview : chart_views)
+    if (values.empty())
+        return;
+
+    // charts are built one at a time, and deleted once saved
+    const int n_y = ui->y_axis_cb->count();
+
+    for (int k=0; k < ui->x_axis_cb->count() * n_y; k++)
     {
+        CustomizedChartView *chview = build_chart(k / n_y, k % n_y);
+        chview->resize(ui->stackedWidget->size());
+
         std::string x_axis = chview->chart()->axisX()->titleText().toStdString();
         std::string y_axis = chview->chart()->axisY()->titleText().toStdString();
 
@@ -424,6 +351,8 @@ void GeometryGeometryScatterPlotsWidget::on_save_btn_clicked()
 
         QPixmap p = chview->grab();
         p.save(filename.c_str());
+
+        delete chview;
     }
 
 }
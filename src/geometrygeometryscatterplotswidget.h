@@ -38,6 +38,7 @@
 #include "customizedchartview.h"
 #include "dataset.h"
 #include "meshes/mesh_metrics.h"
+#include "scatterchartcache.h"
 #include "scatterplotmarkersettingwidget.h"
 
 namespace Ui {
@@ -70,13 +71,35 @@ private slots:
     void on_save_btn_clicked();
 
 private:
+
+    void show_current_plot ();
+
+    // the chart of an (x, y) pair, from the cache or built on the fly
+    CustomizedChartView * chart_view  (const int xID, const int yID);
+    CustomizedChartView * build_chart (const int xID, const int yID) const;
+
+    void apply_marker_settings (QChart *ch) const;
+
     Ui::GeometryGeometryScatterPlotsWidget *ui;
 
     std::vector<uint> cbID2metricsID;
 
-    std::vector<CustomizedChartView * > chart_views;
+    // first mesh of each class, plus the number of meshes
+    std::vector<uint>        class_changes;
+    std::vector<std::string> class_names;
+
+    // value of each axis item, mesh by mesh
+    std::vector<std::vector<double>> values;
+
+    ScatterChartCache *chart_cache = nullptr;
+
     std::vector<ScatterPlotMarkerSettingWidget *> marker_settings_widgets;
 
+    // marker settings of each class
+    std::vector<double> marker_sizes;
+    std::vector<QColor> marker_colors;
+    std::vector<bool>   marker_visible;
+
     std::vector<QColor> extra_colors;
 };
 
@@ -35,10 +35,14 @@
 
 #include "quality_metrics.h"
 
+#include <QCoreApplication>
 #include <QFileDialog>
+#include <QProgressDialog>
 
 #include <QtCharts/QLogValueAxis>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 GeometryPerformanceScatterPlotsWidget::GeometryPerformanceScatterPlotsWidget(QWidget *parent) :
@@ -73,14 +77,19 @@ GeometryPerformanceScatterPlotsWidget::GeometryPerformanceScatterPlotsWidget(QWi
     extra_colors.push_back(QColor(211, 211, 211));
     extra_colors.push_back(QColor(0, 0, 139));
     extra_colors.push_back(QColor(34,139,34));
+
+    chart_cache = new ScatterChartCache(ui->stackedWidget);
+
+    connect(ui->marker_size_dsb, SIGNAL(valueChanged(double)), this, SLOT (update_marker_size (double)));
 }
 
 GeometryPerformanceScatterPlotsWidget::~GeometryPerformanceScatterPlotsWidget()
 {
+    delete chart_cache;
     delete ui;
 }
 
-void GeometryPerformanceScatterPlotsWidget::create_scatterPlots(const Dataset d, const std::vector<MeshMetrics> &metrics,
+void GeometryPerformanceScatterPlotsWidget::create_scatterPlots(const Dataset &d, const std::vector<MeshMetrics> &metrics,
                                                                 const std::vector<std::vector<double> > &performances)
 {
     ui->compute_btn->hide();
@@ -89,315 +98,451 @@ void GeometryPerformanceScatterPlotsWidget::create_scatterPlots(const Dataset d,
     ui->groupBox_2->show();
     ui->groupBox_3->show();
 
-    for(int i = ui->stackedWidget->count(); i >= 0; i--)
+    chart_cache->clear();
+
+    // the metrics may have changed with the dataset
+    if (density_view != nullptr)
     {
-        QWidget* widget = ui->stackedWidget->widget(i);
-        ui->stackedWidget->removeWidget(widget);
-        widget->deleteLater();
+        ui->stackedWidget->removeWidget(density_view);
+        density_view->deleteLater();
+        density_view = nullptr;
     }
 
-    for (QChartView *chv : chart_views)
-        chv->deleteLater();
-
-    chart_views.clear();
+    std::vector<std::vector<float>>().swap(poly_metric_values);
+    poly_offsets.clear();
 
-    //std::string first_class = d.class_names.at(0);
-
-    std::vector<uint> class_chages;
-    class_chages.push_back(0);
+    class_changes.clear();
+    class_changes.push_back(0);
 
     for (uint i=1; i < d.get_num_parametric_meshes(); i++)
         if (d.get_parametric_mesh_class_id(i) != d.get_parametric_mesh_class_id(i-1))
-            class_chages.push_back(i);
+            class_changes.push_back(i);
+
+    class_changes.push_back(d.get_num_parametric_meshes());
 
-    class_chages.push_back(d.get_num_parametric_meshes());
+    class_names.clear();
 
-    for (int i=0; i < ui->x_axis_cb->count(); i++)
+    for (uint cc=0; cc < class_changes.size()-1; cc++)
     {
-        for (int j=0; j < ui->y_axis_cb->count(); j++)
+        std::string class_name = "CLASS";
+
+        if (d.get_num_parametric_meshes() > 0)
+            class_name = d.get_parametric_mesh_class_name(d.get_parametric_mesh_class_id(class_changes.at(cc))).c_str();
+
+        class_names.push_back(class_name);
+    }
+
+    // the values of each axis item are computed once, and shared by all the
+    // charts having it on one of their axes. Charts are built when shown
+    x_values.assign(cbID2metricsID.size(), std::vector<double>(d.get_num_parametric_meshes()));
+
+    for (uint c=0; c < cbID2metricsID.size(); c++)
+    {
+        const uint metric_id = cbID2metricsID.at(c);
+        const bool log_scale = (metric_id >= 13);
+
+        for (uint m=0; m < d.get_num_parametric_meshes(); m++)
         {
-            QChart *ch = new QChart();
+            const double v = mesh_metric_value(metrics.at(m), metric_id);
+            x_values.at(c).at(m) = log_scale ? log(v) : v;
+        }
+    }
 
-            for (uint cc=0; cc < class_chages.size()-1; cc++)
-            {
-                std::string class_name = "CLASS";
+    y_values.assign(performances.size(), std::vector<double>());
+    y_max.assign(performances.size(), 0.0);
 
-                if (d.get_num_parametric_meshes() > 0)
-                    class_name = d.get_parametric_mesh_class_name(d.get_parametric_mesh_class_id(class_chages.at(cc))).c_str();
+    for (uint j=0; j < performances.size(); j++)
+    {
+        for (const double p : performances.at(j))
+            y_values.at(j).push_back(log(p));
 
-                QScatterSeries *s = new QScatterSeries();
-                s->setName(class_name.c_str());
+        if (!performances.at(j).empty())
+            y_max.at(j) = *std::max_element(performances.at(j).begin(), performances.at(j).end());
+    }
+
+    // marker settings are taken from the first chart, and applied to all
+    // the charts built afterwards
+    marker_sizes.clear();
+    marker_colors.clear();
+    marker_visible.clear();
+
+    QChart *first = chart_view(std::max(ui->x_axis_cb->currentIndex(), 0),
+                               std::max(ui->y_axis_cb->currentIndex(), 0))->chart();
+
+    QScatterSeries * s = static_cast<QScatterSeries*>(first->series()[0]);
+    ui->marker_size_dsb->setValue(s->markerSize());
+
+    for (uint cc=0; cc < class_names.size(); cc++)
+    {
+        ScatterPlotMarkerSettingWidget * msw;
+        if (update_settings_bar)
+            msw = new ScatterPlotMarkerSettingWidget();
+        else
+            msw = marker_settings_widgets.at(cc);
 
-                if (cc > 4)
-                    s->setColor(extra_colors.at(cc-5));
+        msw->update_series_name(class_names.at(cc).c_str());
+        msw->set_checked(true);
 
-                for (uint m=class_chages.at(cc); m < class_chages.at(cc+1); m++)
-                {
-                    double x, y;
-                    double min_IC = std::min(metrics.at(m).IC_min,
-                                             metrics.at(m).IC_poly_min);
+        QScatterSeries * s = static_cast<QScatterSeries*>(first->series()[static_cast<int>(cc)]);
 
-                    if (metrics.at(m).IC_min_id == UINT_MAX) min_IC = metrics.at(m).IC_poly_min;
-                    else if (metrics.at(m).IC_poly_min_id == UINT_MAX) min_IC = metrics.at(m).IC_min;
+        marker_sizes.push_back(s->markerSize());
+        marker_colors.push_back(s->color());
+        marker_visible.push_back(true);
+
+        ui->marker_size_dsb->setValue(s->markerSize());
+        msw->set_marker_size(s->markerSize());
+        msw->set_id(cc);
+        msw->set_color(s->color());
 
-                    double min_CC = std::min(metrics.at(m).CC_min,
-                                             metrics.at(m).CC_poly_min);
+        if (ui->marker_settings_widget->layout() == nullptr)
+            ui->marker_settings_widget->setLayout( new QVBoxLayout() );
 
-                    if (metrics.at(m).CC_min_id == UINT_MAX) min_CC = metrics.at(m).CC_poly_min;
-                    else if (metrics.at(m).CC_poly_min_id == UINT_MAX) min_CC = metrics.at(m).CC_min;
+        if (update_settings_bar) {
+            connect(msw, SIGNAL(size_changed(uint, double)), this, SLOT (update_marker_size (uint, double)));
+            connect(msw, SIGNAL(checked_changed(uint, int)), this, SLOT (update_show_series (uint, int)));
+            connect(msw, SIGNAL(color_changed(uint, QColor)), this, SLOT (update_color_series (uint, QColor)));
 
-                    double min_CR = std::min(metrics.at(m).CR_min,
-                                             metrics.at(m).CR_poly_min);
+            ui->marker_settings_widget->layout()->addWidget(msw);
+            marker_settings_widgets.push_back(msw);
+        }
+    }
 
-                    if (metrics.at(m).CR_min_id == UINT_MAX) min_CR = metrics.at(m).CR_poly_min;
-                    else if (metrics.at(m).CR_poly_min_id == UINT_MAX) min_CR = metrics.at(m).CR_min;
+    update_settings_bar = false;
 
-                    double min_AR = std::min(metrics.at(m).AR_min,
-                                             metrics.at(m).AR_poly_min);
+    show_current_plot();
+}
 
-                    if (metrics.at(m).AR_min_id == UINT_MAX) min_AR = metrics.at(m).AR_poly_min;
-                    else if (metrics.at(m).AR_poly_min_id == UINT_MAX) min_AR = metrics.at(m).AR_min;
+CustomizedChartView * GeometryPerformanceScatterPlotsWidget::build_chart(const int i, const int j) const
+{
+    QChart *ch = new QChart();
 
-                    double min_KE = std::min(metrics.at(m).KE_min,
-                                             metrics.at(m).KE_poly_min);
+    const std::vector<double> &x = x_values.at(static_cast<uint>(i));
+    const std::vector<double> &y = y_values.at(static_cast<uint>(j));
 
-                    if (metrics.at(m).KE_min_id == UINT_MAX) min_KE = metrics.at(m).KE_poly_min;
-                    else if (metrics.at(m).KE_poly_min_id == UINT_MAX) min_KE = metrics.at(m).KE_min;
+    for (uint cc=0; cc < class_names.size(); cc++)
+    {
+        QScatterSeries *s = new QScatterSeries();
+        s->setName(class_names.at(cc).c_str());
 
-                    double min_KAR = std::min(metrics.at(m).KAR_min,
-                                              metrics.at(m).KAR_poly_min);
+        if (cc > 4)
+            s->setColor(extra_colors.at(cc-5));
 
-                    if (metrics.at(m).KAR_min_id == UINT_MAX) min_KAR = metrics.at(m).KAR_poly_min;
-                    else if (metrics.at(m).KAR_poly_min_id == UINT_MAX) min_KAR = metrics.at(m).KAR_min;
+        QVector<QPointF> points;
+        points.reserve(static_cast<int>(class_changes.at(cc+1) - class_changes.at(cc)));
 
-                    double min_APR = std::min(metrics.at(m).APR_min,
-                                              metrics.at(m).APR_poly_min);
+        for (uint m=class_changes.at(cc); m < class_changes.at(cc+1); m++)
+            points.append(QPointF(x.at(m), y.at(m)));
 
-                    if (metrics.at(m).APR_min_id == UINT_MAX) min_APR = metrics.at(m).APR_poly_min;
-                    else if (metrics.at(m).APR_poly_min_id == UINT_MAX) min_APR = metrics.at(m).APR_min;
+        s->replace(points);
+        ch->addSeries(s);
+    }
+    ch->createDefaultAxes();
 
-                    double min_MA = std::min(metrics.at(m).MA_min,
-                                             metrics.at(m).MA_poly_min);
+    ch->axes()[1]->setMax(y_max.at(static_cast<uint>(j)));
 
-                    if (metrics.at(m).MA_min_id == UINT_MAX) min_MA = metrics.at(m).MA_poly_min;
-                    else if (metrics.at(m).MA_poly_min_id == UINT_MAX) min_MA = metrics.at(m).MA_min;
+    ch->axes()[0]->setTitleText(metrics_names.at(cbID2metricsID.at(static_cast<uint>(i))).c_str());
+    ch->axes()[1]->setTitleText(ui->y_axis_cb->itemText(j).toStdString().c_str());
 
-                    double min_SE = std::min(metrics.at(m).SE_min,
-                                             metrics.at(m).SE_poly_min);
+    if (ui->y_axis_cb->itemText(j).toStdString().compare("condVect") == 0)
+    {
+        QLogValueAxis *axisYlog = new QLogValueAxis();
+//        axisYlog->setBase(8.0);
+//        axisYlog->setMinorTickCount(-1);
+        axisYlog->setLabelFormat("%e");
+        axisYlog->setTitleText(ui->y_axis_cb->itemText(j).toStdString().c_str());
+        axisYlog->setMax(y_max.at(static_cast<uint>(j)) * 10);
+
+        ch->removeAxis(ch->axes().at(1));
+        ch->addAxis(axisYlog, Qt::AlignLeft);
+
+        for (QAbstractSeries *s : ch->series())
+            s->attachAxis(axisYlog);
+    }
 
-                    if (metrics.at(m).SE_min_id == UINT_MAX) min_SE = metrics.at(m).SE_poly_min;
-                    else if (metrics.at(m).SE_poly_min_id == UINT_MAX) min_SE = metrics.at(m).SE_min;
+    apply_marker_settings(ch);
 
-                    double min_ER = std::min(metrics.at(m).ER_min,
-                                             metrics.at(m).ER_poly_min);
+    CustomizedChartView *ch_view = new CustomizedChartView();
+    ch_view->setChart(ch);
 
-                    if (metrics.at(m).ER_min_id == UINT_MAX) min_ER = metrics.at(m).ER_poly_min;
-                    else if (metrics.at(m).ER_poly_min_id == UINT_MAX) min_ER = metrics.at(m).ER_min;
+//    connect(ch_view, SIGNAL(clicked(double, double, double, double)),
+//            this, SLOT (show_tooltip (double, double, double, double)));
 
-                    double min_MPD = std::min(metrics.at(m).MPD_min,
-                                             metrics.at(m).MPD_poly_min);
+    return ch_view;
+}
 
-                    if (metrics.at(m).MPD_min_id == UINT_MAX) min_MPD = metrics.at(m).MPD_poly_min;
-                    else if (metrics.at(m).MPD_poly_min_id == UINT_MAX) min_MPD = metrics.at(m).MPD_min;
+CustomizedChartView * GeometryPerformanceScatterPlotsWidget::chart_view(const int xID, const int yID)
+{
+    const int key = xID * ui->y_axis_cb->count() + yID;
 
-                    double min_NS = std::min(metrics.at(m).NS_min,
-                                             metrics.at(m).NS_poly_min);
+    CustomizedChartView *ch_view = chart_cache->find(key);
 
-                    if (metrics.at(m).NS_min_id == UINT_MAX) min_NS = metrics.at(m).NS_poly_min;
-                    else if (metrics.at(m).NS_poly_min_id == UINT_MAX) min_NS = metrics.at(m).NS_min;
+    if (ch_view == nullptr)
+    {
+        ch_view = build_chart(xID, yID);
+        chart_cache->insert(key, ch_view);
+    }
 
-                    double min_MXA = std::min(metrics.at(m).MXA_min,
-                                              metrics.at(m).MXA_poly_min);
+    return ch_view;
+}
 
-                    if (metrics.at(m).MXA_min_id == UINT_MAX) min_MXA = metrics.at(m).MXA_poly_min;
-                    else if (metrics.at(m).MXA_poly_min_id == UINT_MAX) min_MXA = metrics.at(m).MXA_min;
+void GeometryPerformanceScatterPlotsWidget::apply_marker_settings(QChart *ch) const
+{
+    for (int i=0; i < ch->series().count() && i < static_cast<int>(marker_sizes.size()); i++)
+    {
+        QScatterSeries * s = static_cast<QScatterSeries*>(ch->series()[i]);
+        s->setMarkerSize(marker_sizes.at(static_cast<uint>(i)));
+        s->setColor(marker_colors.at(static_cast<uint>(i)));
+        s->setVisible(marker_visible.at(static_cast<uint>(i)));
+    }
+}
 
-                    double min_SR = std::min(metrics.at(m).SR_min,
-                                             metrics.at(m).SR_poly_min);
-                    min_SR = log(min_SR);
+void GeometryPerformanceScatterPlotsWidget::show_scatterplot_x(int xID)
+{
+    int yID = ui->y_axis_cb->currentIndex();
 
-                    if (metrics.at(m).SR_min_id == UINT_MAX) min_SR = metrics.at(m).SR_poly_min;
-                    else if (metrics.at(m).SR_poly_min_id == UINT_MAX) min_SR = metrics.at(m).SR_min;
+    std::cout << xID << " - " << yID << std::endl;
 
-                    double max_VEM = std::max(metrics.at(m).VEM_max, metrics.at(m).VEM_poly_max);
-                    max_VEM = log(max_VEM);
+    show_current_plot();
+}
 
-                    if (metrics.at(m).VEM_max_id == UINT_MAX) max_VEM = metrics.at(m).VEM_poly_max;
-                    else if (metrics.at(m).VEM_poly_max_id == UINT_MAX) max_VEM = metrics.at(m).VEM_max;
+void GeometryPerformanceScatterPlotsWidget::show_scatterplot_y(int yID)
+{
+    int xID = ui->x_axis_cb->currentIndex();
 
-                    double sum_VEMA = sqrt(metrics.at(m).VEMA_sum + metrics.at(m).VEMA_poly_sum);
-                    sum_VEMA = log(sum_VEMA);
+    std::cout << xID << " - " << yID << std::endl;
 
-                    switch (cbID2metricsID.at(i)) {
-                        case 0: x = min_IC; break;
-                        case 1: x = min_CC; break;
-                        case 2: x = min_CR; break;
-                        case 3: x = min_AR; break;
-                        case 4: x = min_KE; break;
-                        case 5: x = min_KAR; break;
-                        case 6: x = min_APR; break;
-                        case 7: x = min_MA; break;
-                        case 8: x = min_SE; break;
-                        case 9: x = min_ER; break;
-                        case 10: x = min_MPD; break;
-                        case 11: x = min_NS; break;
-                        case 12: x = min_MXA; break;
-                        case 13: x = min_SR; break;
-                        case 14: x = max_VEM; break;
-                        case 15: x = sum_VEMA; break;
-                    default: x = DBL_MAX;
-                    }
+    show_current_plot();
+}
 
-                    y = performances.at(j).at(m);
-                    y = log(y);
+void GeometryPerformanceScatterPlotsWidget::show_current_plot()
+{
+    int xID = ui->x_axis_cb->currentIndex();
+    int yID = ui->y_axis_cb->currentIndex();
 
-                    s->append(x,y);
-                    std::cout <<x<<" "<<y<<std::endl;
-                }
-                ch->addSeries(s);
-            }
-            ch->createDefaultAxes();
+    if (xID < 0 || yID < 0 || x_values.empty()) return;
 
-            ch->axes()[0]->setTitleText(metrics_names.at(cbID2metricsID.at(i)).c_str());
-            ch->axes()[1]->setMax(*std::max_element(performances.at(j).begin(), performances.at(j).end()));
+    if (ui->per_poly_cb->isChecked())
+        show_density_plot(xID, yID);
+    else
+        ui->stackedWidget->setCurrentWidget(chart_view(xID, yID));
+}
 
-            ch->axes()[0]->setTitleText(metrics_names.at(cbID2metricsID.at(i)).c_str());
-            ch->axes()[1]->setTitleText(ui->y_axis_cb->itemText(j).toStdString().c_str());
+void GeometryPerformanceScatterPlotsWidget::show_density_plot(const int xID, const int yID)
+{
+    const std::string x_name = metrics_names.at(cbID2metricsID.at(xID));
+    const std::string y_name = ui->y_axis_cb->itemText(yID).toStdString();
 
-            std::cout << chart_views.size() << " : " << metrics_names.at(cbID2metricsID.at(i)) <<
-                                               " - " << ui->y_axis_cb->itemText(j).toStdString() << std::endl;
+    const bool has_errors = (static_cast<uint>(yID) < local_errors.size() &&
+                             !local_errors.at(yID).empty());
 
-            if (ui->y_axis_cb->itemText(j).toStdString().compare("condVect") == 0)
-            {
-                QLogValueAxis *axisYlog = new QLogValueAxis();
-//                axisYlog->setBase(8.0);
-//                axisYlog->setMinorTickCount(-1);
-                axisYlog->setLabelFormat("%e");
-                axisYlog->setTitleText(ui->y_axis_cb->itemText(j).toStdString().c_str());
-                axisYlog->setMax(*std::max_element(performances.at(j).begin(), performances.at(j).end()) * 10);
+    if (has_errors && poly_metric_values.empty() && !compute_poly_metric_values())
+    {
+        ui->per_poly_cb->setChecked(false);
+        return;
+    }
 
-                std::cout << "MAX CONDVECT : " << axisYlog->max() << std::endl;
+    QChart *ch = new QChart();
 
-                ch->removeAxis(ch->axes().at(1));
-                ch->addAxis(axisYlog, Qt::AlignLeft);
+    if (!has_errors)
+    {
+        ch->setTitle(("No per polygon values of " + y_name).c_str());
+    }
+    else
+    {
+        // as in the per mesh plots: log of the errors, and of the metrics
+        // from SR on. Zero errors have no log and are not drawn
+        const uint metric_id = cbID2metricsID.at(xID);
+        const bool log_x = (metric_id >= 13);
 
-                for (QAbstractSeries *s : ch->series())
-                    s->attachAxis(axisYlog);
+        const std::vector<std::vector<double>> &errs = local_errors.at(yID);
+        const std::vector<float> &values = poly_metric_values.at(xID);
+
+        std::vector<float> x (values.size(), NAN);
+        std::vector<float> y (values.size(), NAN);
+
+        for (uint m=0; m+1 < poly_offsets.size(); m++)
+        {
+            const size_t offset  = poly_offsets.at(m);
+            const size_t n_polys = poly_offsets.at(m+1) - offset;
+
+            // meshes without results (or with stale ones) are left out
+            if (m >= errs.size() || errs.at(m).size() != n_polys) continue;
+
+            #pragma omp parallel for schedule(static)
+            for (long pid=0; pid < static_cast<long>(n_polys); pid++)
+            {
+                const float v = values.at(offset + pid);
+                x.at(offset + pid) = log_x ? std::log(v) : v;
+                y.at(offset + pid) = static_cast<float>(std::log(errs.at(m).at(pid)));
             }
+        }
 
+        DensityGrid grid;
+        compute_density_grid(x, y, 256, 192, grid);
 
-            CustomizedChartView *ch_view = new CustomizedChartView();
-            ch_view->setChart(ch);
+        // bins are drawn as square markers, one series per density level
+        // (log scale), from light to dark
+        const uint n_levels = 6;
+        const double log_max = std::log(static_cast<double>(grid.max_count) + 1.0);
 
-//            connect(ch_view, SIGNAL(clicked(double, double, double, double)),
-//                    this, SLOT (show_tooltip (double, double, double, double)));
+        std::vector<QScatterSeries *> levels (n_levels);
 
-            chart_views.push_back(ch_view);
-            ui->stackedWidget->addWidget(ch_view);
+        for (uint l=0; l < n_levels; l++)
+        {
+            const uint min_count = static_cast<uint>(std::ceil(std::exp(log_max * l / n_levels)));
+
+            levels.at(l) = new QScatterSeries();
+            levels.at(l)->setName((">= " + std::to_string(min_count) + " polygons").c_str());
+            levels.at(l)->setMarkerShape(QScatterSeries::MarkerShapeRectangle);
+            levels.at(l)->setMarkerSize(4.0);
+            levels.at(l)->setBorderColor(Qt::transparent);
+            levels.at(l)->setColor(QColor::fromHsvF(0.6, 0.15 + 0.85 * l / (n_levels-1), 1.0 - 0.6 * l / (n_levels-1)));
+        }
+
+        QVector<QVector<QPointF>> points (n_levels);
+
+        for (uint j=0; j < grid.ny; j++)
+            for (uint i=0; i < grid.nx; i++)
+            {
+                const uint c = grid.counts.at(static_cast<size_t>(j) * grid.nx + i);
+                if (c == 0) continue;
+
+                const uint l = std::min(n_levels-1, static_cast<uint>(n_levels * std::log(static_cast<double>(c)) / log_max));
+                points[l].append(QPointF(density_grid_x(grid, i), density_grid_y(grid, j)));
+            }
 
+        for (uint l=0; l < n_levels; l++)
+        {
+            levels.at(l)->replace(points.at(l));
+            ch->addSeries(levels.at(l));
         }
+
+        ch->setTitle((std::to_string(grid.n_points) + " polygons").c_str());
     }
 
-    ui->stackedWidget->setCurrentIndex(0);
+    ch->createDefaultAxes();
 
-    QScatterSeries * s = static_cast<QScatterSeries*>(chart_views.at(0)->chart()->series()[0]);
-    ui->marker_size_dsb->setValue(s->markerSize());
+    if (!ch->axes().empty())
+    {
+        ch->axes(Qt::Horizontal).first()->setTitleText(x_name.c_str());
+        ch->axes(Qt::Vertical).first()->setTitleText(y_name.c_str());
+    }
 
-    for (uint cc=0; cc < class_chages.size()-1; cc++)
+    if (density_view == nullptr)
     {
-        std::string class_name = "CLASS";
+        density_view = new CustomizedChartView();
+        ui->stackedWidget->addWidget(density_view);
+    }
 
-        if (d.get_num_parametric_meshes() > 0)
-            class_name = d.get_parametric_mesh_class_name(d.get_parametric_mesh_class_id(class_chages.at(cc))).c_str();
+    QChart *old_chart = density_view->chart();
+    density_view->setChart(ch);
+    delete old_chart;
 
-        ScatterPlotMarkerSettingWidget * msw;
-        if (update_settings_bar)
-            msw = new ScatterPlotMarkerSettingWidget();
-        else
-            msw = marker_settings_widgets.at(cc);
+    ui->stackedWidget->setCurrentWidget(density_view);
+}
 
-        msw->update_series_name(class_name.c_str());
-        msw->set_checked(true);
+bool GeometryPerformanceScatterPlotsWidget::compute_poly_metric_values()
+{
+    if (dataset == nullptr) return false;
 
-        QScatterSeries * s = static_cast<QScatterSeries*>(chart_views.at(0)->chart()->series()[cc]);
-        ui->marker_size_dsb->setValue(s->markerSize());
-        msw->set_marker_size(s->markerSize());
-        msw->set_id(cc);
-        msw->set_color(s->color());
+    const uint n_meshes = dataset->get_num_parametric_meshes();
 
-        connect(msw, SIGNAL(size_changed(uint, double)), this, SLOT (update_marker_size (uint, double)));
-        connect(msw, SIGNAL(checked_changed(uint, int)), this, SLOT (update_show_series (uint, int)));
-        connect(msw, SIGNAL(color_changed(uint, QColor)), this, SLOT (update_color_series (uint, QColor)));
+    std::vector<std::vector<float>> values (cbID2metricsID.size());
+    std::vector<size_t> offsets (1, 0);
 
-        if (ui->marker_settings_widget->layout() == nullptr)
-            ui->marker_settings_widget->setLayout( new QVBoxLayout() );
+    QProgressDialog progress ("Computing polygon metrics ...", "Cancel", 0, static_cast<int>(n_meshes), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
 
-        if (update_settings_bar) {
-            ui->marker_settings_widget->layout()->addWidget(msw);
-            marker_settings_widgets.push_back(msw);
+    // the dataset is accessed from the GUI thread only: meshes are pinned one
+    // at a time (so they are not evicted meanwhile), and their polygons are
+    // processed in parallel
+    for (uint m=0; m < n_meshes; m++)
+    {
+        progress.setValue(static_cast<int>(m));
+        QCoreApplication::processEvents();
+
+        if (progress.wasCanceled()) return false;
+
+        const DrawablePolygonmesh<> *mesh = dataset->pin_parametric_mesh(m);
+        const size_t offset = offsets.back();
+
+        offsets.push_back(offset + mesh->num_polys());
+
+        for (std::vector<float> &v : values)
+            v.resize(offsets.back());
+
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (int pid=0; pid < static_cast<int>(mesh->num_polys()); pid++)
+        {
+            PolyMetrics pm;
+            compute_poly_metrics(*mesh, static_cast<uint>(pid), pm);
+
+            for (uint c=0; c < cbID2metricsID.size(); c++)
+                values.at(c).at(offset + pid) = static_cast<float>(poly_metric_value(pm, cbID2metricsID.at(c)));
         }
+
+        dataset->unpin_parametric_mesh(mesh);
     }
 
-    connect(ui->marker_size_dsb, SIGNAL(valueChanged(double)), this, SLOT (update_marker_size (double)));
+    progress.setValue(static_cast<int>(n_meshes));
 
-    update_settings_bar = false;
+    poly_metric_values.swap(values);
+    poly_offsets.swap(offsets);
+
+    return true;
 }
 
-void GeometryPerformanceScatterPlotsWidget::show_scatterplot_x(int xID)
+void GeometryPerformanceScatterPlotsWidget::set_dataset(Dataset *d)
 {
-    int yID = ui->y_axis_cb->currentIndex();
+    dataset = d;
+}
 
-    std::cout << xID << " - " << yID << std::endl;
+void GeometryPerformanceScatterPlotsWidget::set_local_errors(const std::vector<std::vector<std::vector<double>>> &errs)
+{
+    local_errors = errs;
 
-    ui->stackedWidget->setCurrentIndex(xID * ui->y_axis_cb->count()+ yID);
+    if (ui->per_poly_cb->isChecked())
+        show_current_plot();
 }
 
-void GeometryPerformanceScatterPlotsWidget::show_scatterplot_y(int yID)
+void GeometryPerformanceScatterPlotsWidget::on_per_poly_cb_toggled(bool checked)
 {
-    int xID = ui->x_axis_cb->currentIndex();
+    ui->groupBox_3->setEnabled(!checked);
 
-    std::cout << xID << " - " << yID << std::endl;
-
-    ui->stackedWidget->setCurrentIndex(xID * ui->y_axis_cb->count()+ yID);
+    show_current_plot();
 }
 
 void GeometryPerformanceScatterPlotsWidget::update_marker_size(double size)
 {
-    for (CustomizedChartView *ch_view : chart_views)
-    {
-        for (QAbstractSeries *as : ch_view->chart()->series())
-        {
-            QScatterSeries * s = static_cast<QScatterSeries*>(as);
-            s->setMarkerSize(size);
-        }
-    }
+    std::fill(marker_sizes.begin(), marker_sizes.end(), size);
+
+    for (const auto &item : chart_cache->charts())
+        apply_marker_settings(item.second->chart());
 }
 
 void GeometryPerformanceScatterPlotsWidget::update_marker_size(uint id, double size)
 {
-    for (CustomizedChartView *ch_view : chart_views)
-    {
-        QScatterSeries * s = static_cast<QScatterSeries*>(ch_view->chart()->series()[id]);
-        s->setMarkerSize(size);
-    }
+    marker_sizes.at(id) = size;
+
+    for (const auto &item : chart_cache->charts())
+        apply_marker_settings(item.second->chart());
 }
 
 void GeometryPerformanceScatterPlotsWidget::update_show_series(uint id, int b)
 {
-    for (CustomizedChartView *ch_view : chart_views)
-    {
-        QScatterSeries * s = static_cast<QScatterSeries*>(ch_view->chart()->series()[id]);
-        s->setVisible(b);
-    }
+    marker_visible.at(id) = b;
+
+    for (const auto &item : chart_cache->charts())
+        apply_marker_settings(item.second->chart());
 }
 
 void GeometryPerformanceScatterPlotsWidget::update_color_series(uint id, QColor c)
 {
-    for (CustomizedChartView *ch_view : chart_views)
-    {
-        QScatterSeries * s = static_cast<QScatterSeries*>(ch_view->chart()->series()[id]);
-        s->setColor(c);
-    }
+    marker_colors.at(id) = c;
+
+    for (const auto &item : chart_cache->charts())
+        apply_marker_settings(item.second->chart());
 }
 
 void GeometryPerformanceScatterPlotsWidget::on_pushButton_clicked()
@@ -409,8 +554,17 @@ void GeometryPerformanceScatterPlotsWidget::on_pushButton_clicked()
     if (dir.isNull())
         return;
 
-    for (QChartView *chview : chart_views)
+    if (x_values.empty())
+        return;
+
+    // charts are built one at a time, and deleted once saved
+    const int n_y = ui->y_axis_cb->count();
+
+    for (int k=0; k < ui->x_axis_cb->count() * n_y; k++)
     {
+        CustomizedChartView *chview = build_chart(k / n_y, k % n_y);
+        chview->resize(ui->stackedWidget->size());
+
         std::string x_axis = chview->chart()->axisX()->titleText().toStdString();
         std::string y_axis = chview->chart()->axisY()->titleText().toStdString();
 
@@ -425,6 +579,8 @@ void GeometryPerformanceScatterPlotsWidget::on_pushButton_clicked()
 
         QPixmap p = chview->grab();
         p.save(filename.c_str());
+
+        delete chview;
     }
 
 }
@@ -35,7 +35,9 @@
 
 #include "customizedchartview.h"
 #include "dataset.h"
+#include "meshes/density_grid.h"
 #include "meshes/mesh_metrics.h"
+#include "scatterchartcache.h"
 #include "scatterplotmarkersettingwidget.h"
 
 #include <QWidget>
@@ -52,13 +54,19 @@ public:
     explicit GeometryPerformanceScatterPlotsWidget(QWidget *parent = nullptr);
     ~GeometryPerformanceScatterPlotsWidget();
 
-    void create_scatterPlots (const Dataset d,
+    void create_scatterPlots (const Dataset &d,
                               const std::vector<MeshMetrics> &metrics,
                               const std::vector<std::vector<double>> &performances);
 
     void set_empty ();
     void set_solution_id (const uint id) { solution_id = id; }
 
+    void set_dataset (Dataset *d);
+
+    // errS, errInf and errL2 of each polygon, mesh by mesh, for the per
+    // polygon plots
+    void set_local_errors (const std::vector<std::vector<std::vector<double>>> &errs);
+
 Q_SIGNALS:
 
     void compute_GP_scatterplots ();
@@ -79,7 +87,21 @@ private slots:
 
     void on_compute_btn_clicked();
 
+    void on_per_poly_cb_toggled(bool checked);
+
 private:
+
+    void show_current_plot ();
+    void show_density_plot (const int xID, const int yID);
+
+    // the chart of an (x, y) pair, from the cache or built on the fly
+    CustomizedChartView * chart_view  (const int xID, const int yID);
+    CustomizedChartView * build_chart (const int xID, const int yID) const;
+
+    void apply_marker_settings (QChart *ch) const;
+
+    bool compute_poly_metric_values ();
+
     Ui::GeometryPerformanceScatterplotsWidget *ui;
 
     uint solution_id = UINT_MAX;
@@ -87,11 +109,38 @@ private:
 
     std::vector<uint> cbID2metricsID;
 
-    std::vector<CustomizedChartView * > chart_views;
+    // first mesh of each class, plus the number of meshes
+    std::vector<uint>        class_changes;
+    std::vector<std::string> class_names;
+
+    // value of each x and y axis item, mesh by mesh, and the largest value
+    // of each performance (the y values are logs)
+    std::vector<std::vector<double>> x_values;
+    std::vector<std::vector<double>> y_values;
+    std::vector<double>              y_max;
+
+    ScatterChartCache *chart_cache = nullptr;
+
     std::vector<ScatterPlotMarkerSettingWidget *> marker_settings_widgets;
 
+    // marker settings of each class
+    std::vector<double> marker_sizes;
+    std::vector<QColor> marker_colors;
+    std::vector<bool>   marker_visible;
+
     std::vector<QColor> extra_colors;
 
+    Dataset *dataset = nullptr;
+
+    // per polygon values of the x axis items and local errors of the y axis
+    // items, over the polygons of all the meshes. Metrics are computed the
+    // first time a per polygon plot is shown
+    std::vector<std::vector<float>> poly_metric_values;
+    std::vector<size_t>             poly_offsets;       // first polygon of each mesh
+    std::vector<std::vector<std::vector<double>>> local_errors;
+
+    CustomizedChartView *density_view = nullptr;
+
 
 };
 
@@ -16,7 +16,10 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
-#include <cinolib/scalar_field.h>
+#include "backgroundtask.h"
+#include "downsampledlineseries.h"
+#include "meshes/error_norms.h"
+#include "meshes/solution_io.h"
 
 #include <QDir>
 #include <QFileDialog>
@@ -30,6 +33,10 @@
 #include <QtCharts/QValueAxis>
 QT_CHARTS_USE_NAMESPACE
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow)
@@ -50,6 +57,7 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->metricsWidget, SIGNAL (show_unsorted_metrics()), this, SLOT(show_mesh_metrics()));
     connect(ui->solverWidget, SIGNAL (solver_completed (const uint, const std::string, const std::string)), this, SLOT (show_solver_results (const uint, const std::string, const std::string)));
     connect(ui->datasetWidget, SIGNAL (saved_in(const std::string)), this, SLOT (update_solver_input_folder (const std::string)));
+    connect(ui->datasetWidget, SIGNAL (meshes_edited()), ui->solverResultsWidget, SLOT (geometry_changed()));
 
     connect(ui->scatterPlotsGPWidget, SIGNAL(compute_GP_scatterplots()), this, SLOT(compute_GP_scatterplots()));
 
@@ -64,6 +72,10 @@ MainWindow::MainWindow(QWidget *parent) :
 
 MainWindow::~MainWindow()
 {
+    // the widgets are deleted after the dataset: the result meshes are
+    // unpinned while it still exists
+    ui->solverResultsWidget->clear();
+
     delete ui;
 }
 
@@ -77,20 +89,20 @@ void MainWindow::show_mesh_metrics()
 
     metrics = ui->datasetWidget->get_parametric_meshes_metrics();
     ui->graphicMeshMetricWidget->set_metrics(&metrics);
-    ui->graphicMeshMetricWidget->set_slider_max(dataset.get_parametric_meshes().size()-1);
+    ui->graphicMeshMetricWidget->set_slider_max(dataset.get_num_parametric_meshes()-1);
 
     ui->graphicMeshMetricWidget->show_mesh(0);
     ui->metricsWidget->reset();
 
     for (uint i=0; i < n_metrics; i++)
     {
-        QLineSeries *series_min = new QLineSeries();
-        QLineSeries *series_max = new QLineSeries();
-        QLineSeries *series_avg = new QLineSeries();
+        DownsampledLineSeries *series_min = new DownsampledLineSeries();
+        DownsampledLineSeries *series_max = new DownsampledLineSeries();
+        DownsampledLineSeries *series_avg = new DownsampledLineSeries();
 
-        QLineSeries *series_poly_min = new QLineSeries();
-        QLineSeries *series_poly_max = new QLineSeries();
-        QLineSeries *series_poly_avg = new QLineSeries();
+        DownsampledLineSeries *series_poly_min = new DownsampledLineSeries();
+        DownsampledLineSeries *series_poly_max = new DownsampledLineSeries();
+        DownsampledLineSeries *series_poly_avg = new DownsampledLineSeries();
 
         series_poly_min->setColor(extra_colors.at(0));
         series_poly_max->setColor(extra_colors.at(1));
@@ -104,6 +116,10 @@ void MainWindow::show_mesh_metrics()
         series_poly_max->setName("Poly Max");
         series_poly_avg->setName("Poly Avg");
 
+        // points are collected here and handed to the series in one go
+        QVector<QPointF> points_min, points_max, points_avg;
+        QVector<QPointF> points_poly_min, points_poly_max, points_poly_avg;
+
         QChart *chart = new QChart();
 
         for (uint m=0; m < metrics.size(); m++)
@@ -299,27 +315,49 @@ void MainWindow::show_mesh_metrics()
                 min_poly_id = metrics.at(m).VEMA_poly_min_id;
                 max_poly_id = metrics.at(m).VEMA_poly_max_id;
                 break;
+            case 16: val_min = metrics.at(m).VPC_min;
+                val_max = metrics.at(m).VPC_max;
+                val_avg = metrics.at(m).VPC_avg;
+                val_poly_min = metrics.at(m).VPC_poly_min;
+                val_poly_max = metrics.at(m).VPC_poly_max;
+                val_poly_avg = metrics.at(m).VPC_poly_avg;
+                min_id = metrics.at(m).VPC_min_id;
+                max_id = metrics.at(m).VPC_max_id;
+                min_poly_id = metrics.at(m).VPC_poly_min_id;
+                max_poly_id = metrics.at(m).VPC_poly_max_id;
+                break;
+            case 17: val_min = metrics.at(m).VSC_min;
+                val_max = metrics.at(m).VSC_max;
+                val_avg = metrics.at(m).VSC_avg;
+                val_poly_min = metrics.at(m).VSC_poly_min;
+                val_poly_max = metrics.at(m).VSC_poly_max;
+                val_poly_avg = metrics.at(m).VSC_poly_avg;
+                min_id = metrics.at(m).VSC_min_id;
+                max_id = metrics.at(m).VSC_max_id;
+                min_poly_id = metrics.at(m).VSC_poly_min_id;
+                max_poly_id = metrics.at(m).VSC_poly_max_id;
+                break;
             default:
                 std::cerr << "Invalid metric index" << std::endl;
             }
 
             if (min_id < UINT_MAX)
-                series_min->append(m, val_min);
+                points_min.append(QPointF(m, val_min));
 
             if (max_id < UINT_MAX)
-                series_max->append(m, val_max);
+                points_max.append(QPointF(m, val_max));
 
             if (min_id < UINT_MAX && max_id < UINT_MAX)
-                series_avg->append(m, val_avg);
+                points_avg.append(QPointF(m, val_avg));
 
             if (min_poly_id < UINT_MAX)
-                series_poly_min->append(m, val_poly_min);
+                points_poly_min.append(QPointF(m, val_poly_min));
 
             if (max_poly_id < UINT_MAX)
-                series_poly_max->append(m, val_poly_max);
+                points_poly_max.append(QPointF(m, val_poly_max));
 
             if (min_poly_id < UINT_MAX && max_poly_id < UINT_MAX)
-                series_poly_avg->append(m, val_poly_avg);
+                points_poly_avg.append(QPointF(m, val_poly_avg));
         }
 
         chart->legend()->hide();
@@ -332,6 +370,14 @@ void MainWindow::show_mesh_metrics()
         series_poly_max->setPointsVisible();
         series_poly_avg->setPointsVisible();
 
+        series_min->set_points(points_min);
+        series_max->set_points(points_max);
+        series_avg->set_points(points_avg);
+
+        series_poly_min->set_points(points_poly_min);
+        series_poly_max->set_points(points_poly_max);
+        series_poly_avg->set_points(points_poly_avg);
+
         chart->addSeries(series_min);
         chart->addSeries(series_max);
         chart->addSeries(series_avg);
@@ -361,6 +407,13 @@ void MainWindow::show_mesh_metrics()
 //        series_poly_avg->attachAxis(axisYlog);
 
         chart->createDefaultAxes();
+
+        // the shown points follow the zoom of the x axis
+        QValueAxis *axis_x = static_cast<QValueAxis *>(chart->axisX());
+        for (DownsampledLineSeries *s : {series_min, series_max, series_avg,
+                                         series_poly_min, series_poly_max, series_poly_avg})
+            s->track_axis(axis_x);
+
         chart->legend()->setAlignment(Qt::AlignRight);
 
         static_cast<QValueAxis *>(chart->axisX())->setLabelFormat("%i");
@@ -384,6 +437,7 @@ void MainWindow::show_mesh_metrics()
 
         CustomizedChartView *chartView = new CustomizedChartView();
         chartView->setChart(chart);
+        chartView->set_wheel_zoom_enabled(true);
         chartView->setBackgroundBrush(QColor (230, 230, 230));
         chartView->setRenderHint(QPainter::Antialiasing);
 
@@ -443,6 +497,10 @@ void MainWindow::show_sorted_mesh_metrics(const uint to_be_sort_id)
             break;
         case 15: val = metrics.at(m).VEMA_min;
             break;
+        case 16: val = metrics.at(m).VPC_min;
+            break;
+        case 17: val = metrics.at(m).VSC_min;
+            break;
         default:
             std::cerr << "Invalid metric index" << std::endl;
         }
@@ -452,13 +510,13 @@ void MainWindow::show_sorted_mesh_metrics(const uint to_be_sort_id)
 
     for (uint i=0; i < n_metrics; i++)
     {
-        QLineSeries *series_min = new QLineSeries();
-        QLineSeries *series_max = new QLineSeries();
-        QLineSeries *series_avg = new QLineSeries();
+        DownsampledLineSeries *series_min = new DownsampledLineSeries();
+        DownsampledLineSeries *series_max = new DownsampledLineSeries();
+        DownsampledLineSeries *series_avg = new DownsampledLineSeries();
 
-        QLineSeries *series_poly_min = new QLineSeries();
-        QLineSeries *series_poly_max = new QLineSeries();
-        QLineSeries *series_poly_avg = new QLineSeries();
+        DownsampledLineSeries *series_poly_min = new DownsampledLineSeries();
+        DownsampledLineSeries *series_poly_max = new DownsampledLineSeries();
+        DownsampledLineSeries *series_poly_avg = new DownsampledLineSeries();
 
         series_poly_min->setColor(extra_colors.at(0));
         series_poly_max->setColor(extra_colors.at(1));
@@ -472,6 +530,10 @@ void MainWindow::show_sorted_mesh_metrics(const uint to_be_sort_id)
         series_poly_max->setName("Polygon Max");
         series_poly_avg->setName("Polygon Avg");
 
+        // points are collected here and handed to the series in one go
+        QVector<QPointF> points_min, points_max, points_avg;
+        QVector<QPointF> points_poly_min, points_poly_max, points_poly_avg;
+
         QChart *chart = new QChart();
         uint metric_id = 0;
 
@@ -670,33 +732,63 @@ void MainWindow::show_sorted_mesh_metrics(const uint to_be_sort_id)
                 min_poly_id = metrics.at(m).VEMA_poly_min_id;
                 max_poly_id = metrics.at(m).VEMA_poly_max_id;
                 break;
+            case 16: val_min = metrics.at(m).VPC_min;
+                val_max = metrics.at(m).VPC_max;
+                val_avg = metrics.at(m).VPC_avg;
+                val_poly_min = metrics.at(m).VPC_poly_min;
+                val_poly_max = metrics.at(m).VPC_poly_max;
+                val_poly_avg = metrics.at(m).VPC_poly_avg;
+                min_id = metrics.at(m).VPC_min_id;
+                max_id = metrics.at(m).VPC_max_id;
+                min_poly_id = metrics.at(m).VPC_poly_min_id;
+                max_poly_id = metrics.at(m).VPC_poly_max_id;
+                break;
+            case 17: val_min = metrics.at(m).VSC_min;
+                val_max = metrics.at(m).VSC_max;
+                val_avg = metrics.at(m).VSC_avg;
+                val_poly_min = metrics.at(m).VSC_poly_min;
+                val_poly_max = metrics.at(m).VSC_poly_max;
+                val_poly_avg = metrics.at(m).VSC_poly_avg;
+                min_id = metrics.at(m).VSC_min_id;
+                max_id = metrics.at(m).VSC_max_id;
+                min_poly_id = metrics.at(m).VSC_poly_min_id;
+                max_poly_id = metrics.at(m).VSC_poly_max_id;
+                break;
             default:
                 std::cerr << "Invalid metric index" << std::endl;
             }
 
             if (min_id < UINT_MAX)
-                series_min->append(metric_id, val_min);
+                points_min.append(QPointF(metric_id, val_min));
 
             if (max_id < UINT_MAX)
-                series_max->append(metric_id, val_max);
+                points_max.append(QPointF(metric_id, val_max));
 
             if (min_id < UINT_MAX && max_id < UINT_MAX)
-                series_avg->append(metric_id, val_avg);
+                points_avg.append(QPointF(metric_id, val_avg));
 
             if (min_poly_id < UINT_MAX)
-                series_poly_min->append(metric_id, val_poly_min);
+                points_poly_min.append(QPointF(metric_id, val_poly_min));
 
             if (max_poly_id < UINT_MAX)
-                series_poly_max->append(metric_id, val_poly_max);
+                points_poly_max.append(QPointF(metric_id, val_poly_max));
 
             if (min_poly_id < UINT_MAX && max_poly_id < UINT_MAX)
-                series_poly_avg->append(metric_id, val_poly_avg);
+                points_poly_avg.append(QPointF(metric_id, val_poly_avg));
 
             metric_id++;
         }
 
         chart->legend()->hide();
 
+        series_min->set_points(points_min);
+        series_max->set_points(points_max);
+        series_avg->set_points(points_avg);
+
+        series_poly_min->set_points(points_poly_min);
+        series_poly_max->set_points(points_poly_max);
+        series_poly_avg->set_points(points_poly_avg);
+
         chart->addSeries(series_min);
         chart->addSeries(series_max);
         chart->addSeries(series_avg);
@@ -707,10 +799,17 @@ void MainWindow::show_sorted_mesh_metrics(const uint to_be_sort_id)
 
         chart->createDefaultAxes();
 
+        // the shown points follow the zoom of the x axis
+        QValueAxis *axis_x = static_cast<QValueAxis *>(chart->axisX());
+        for (DownsampledLineSeries *s : {series_min, series_max, series_avg,
+                                         series_poly_min, series_poly_max, series_poly_avg})
+            s->track_axis(axis_x);
+
         chart->setTitle(metrics_names.at(i).c_str());
 
         CustomizedChartView *chartView = new CustomizedChartView();
         chartView->setChart(chart);
+        chartView->set_wheel_zoom_enabled(true);
 
         if (i == to_be_sort_id)
             chartView->setBackgroundBrush(Qt::red);
@@ -732,34 +831,17 @@ void MainWindow::show_solver_results(const uint solution_id, const std::string f
 
     ui->solverResultsWidget->set_solution_id(solution_id);
     ui->scatterPlotsGPWidget->set_solution_id(solution_id);
+    ui->scatterPlotsGPWidget->set_dataset(&dataset);
 
     const std::string filepath = folder + QString(QDir::separator()).toStdString() + filename;
 
-    std::ifstream in;
-    in.open(filepath.c_str());
-
-    if (!in.is_open())
-    {
-        std::cerr << "Error opening " << filename << std::endl;
-        return;
-    }
-
-    std::vector<std::vector<double>> errs (5);
-    double e0,e1,e2,e3,e4;
+    std::vector<std::vector<double>> errs;
 
     std::vector<std::string> labels
         {"errS", "errInf", "errL2", "hEmax", "condVect"};
 
-    while ( in >> e0 >> e1 >> e2 >> e3 >> e4)
-    {
-        errs.at(0).push_back(e0);
-        errs.at(1).push_back(e1);
-        errs.at(2).push_back(e2);
-        errs.at(3).push_back(e3);
-        errs.at(4).push_back(e4);
-    }
-
-    in.close();
+    if (!read_error_table(filepath, static_cast<uint>(labels.size()), errs))
+        return;
 
     errsToScatterPlots.clear();
     errsToScatterPlots.push_back(errs.at(0));
@@ -813,10 +895,6 @@ void MainWindow::show_solver_results(const uint solution_id, const std::string f
             }
         }
 
-        for (uint v=0; v < errs.at(i).size(); v++)
-            std::cout << series->at(static_cast<int>(v)).y() << std::endl;
-        std::cout << std::endl;
-
         series->setPointsVisible(true);
         series->setName(labels.at(i).c_str());
 
@@ -862,115 +940,101 @@ void MainWindow::show_solver_results(const uint solution_id, const std::string f
     }
 
     const std::string postfix_sol = "-VEM-sol.txt";
+    const std::string postfix_gt  = "-GROUND-TRUTH-sol.txt";
 
-    for (uint i=0; i < dataset.get_parametric_meshes().size(); i++)
-    {       
-        std::string basename = dataset.get_parametric_mesh_filename(i);
-        basename = basename.substr(basename.find_last_of(QDir::separator().toLatin1())+1);
-        basename = basename.substr(0, basename.find_last_of("."));
-
-        std::string filepath = folder + QString(QDir::separator()).toStdString() +
-                               basename + postfix_sol;
+    // Solution and ground truth fields are read on worker threads, each one
+    // on its own meshes, and handed over to the results widget, that colors
+    // them whenever a mesh is displayed. The meshes are pinned a batch at a
+    // time, on the GUI thread, so that the whole dataset is never resident.
+    // The raw fields give the local errors of the per polygon scatter plots
+    const uint n_meshes = dataset.get_num_parametric_meshes();
 
-        std::cout << "Parsing file " << filepath << std::endl;
+    std::vector<std::vector<std::vector<double>>> local_errs (3, std::vector<std::vector<double>>(n_meshes));
 
-        std::ifstream in;
-        in.open(filepath.c_str());
+    std::vector<std::string> prefixes (n_meshes);
 
-        if (!in.is_open())
-        {
-            std::cerr << "Error opening " << filepath << std::endl;
-            continue;
-        }
-
-        std::vector<double> vals;
-        double val;
-
-        for (uint vid=0; vid < dataset.get_parametric_mesh(i)->num_verts(); vid++)
-        {
-            in >> val;
-            vals.push_back(val);
-        }
-
-        cinolib::ScalarField sf (vals);
-
-        double min = DBL_MAX, max = -DBL_MAX;
-        for (uint ii=0; ii < sf.size(); ii++)
-        {
-            if (sf[ii] < min) min = sf[ii];
-            if (sf[ii] > max) max = sf[ii];
-        }
-
-        if (min != max)
-            sf.normalize_in_01();
-
-        sf.copy_to_mesh(*dataset.get_parametric_mesh(i));
-
-        for (uint vid=0; vid < dataset.get_parametric_mesh(i)->num_verts(); vid++ )
-        {
-            dataset.get_parametric_mesh(i)->vert_data(vid).color = cinolib::Color::red_white_blue_ramp_01(sf[vid]);
-            std::cout << dataset.get_parametric_mesh(i)->vert(vid) <<  " -- " << sf[vid] << std::endl;
-        }
-
-        in.close();
-    }
-
-    const std::string postfix_gt = "-GROUND-TRUTH-sol.txt";
-
-    for (uint i=0; i < dataset.get_parametric_meshes().size(); i++)
+    for (uint i=0; i < n_meshes; i++)
     {
         std::string basename = dataset.get_parametric_mesh_filename(i);
         basename = basename.substr(basename.find_last_of(QDir::separator().toLatin1())+1);
         basename = basename.substr(0, basename.find_last_of("."));
 
-        std::string filepath = folder + QString(QDir::separator()).toStdString() +
-                               basename + postfix_sol;
+        prefixes.at(i) = folder + QString(QDir::separator()).toStdString() + basename;
+    }
+
+    BackgroundTask task (this, "Loading solver results ...", n_meshes);
 
-        std::cout << "Parsing file " << filepath << std::endl;
+    // the dataset is only touched on this thread, which runs the event loop
+    // of the task
+    auto on_gui_thread = [this](const std::function<void()> &f)
+    {
+        QMetaObject::invokeMethod(this, f, Qt::BlockingQueuedConnection);
+    };
 
-        std::ifstream in;
-        in.open(filepath.c_str());
+    uint batch_size = 16;
+#ifdef _OPENMP
+    batch_size = std::max(batch_size, 4 * static_cast<uint>(omp_get_max_threads()));
+#endif
 
-        if (!in.is_open())
+    task.run([&]()
+    {
+        for (uint first=0; first < n_meshes && !task.is_canceled(); first += batch_size)
         {
-            std::cerr << "Error opening " << filepath << std::endl;
-            continue;
-        }
+            const uint last = std::min(n_meshes, first + batch_size);
 
-        std::vector<double> vals;
-        double val;
+            std::vector<const cinolib::DrawablePolygonmesh<> *> batch;
+            std::vector<std::vector<double>> values[2];
 
-        for (uint vid=0; vid < dataset.get_parametric_mesh(i)->num_verts(); vid++)
-        {
-            in >> val;
-            vals.push_back(val);
-        }
+            values[0].resize(last - first);
+            values[1].resize(last - first);
 
-        cinolib::ScalarField sf (vals);
+            on_gui_thread([&]()
+            {
+                for (uint i=first; i < last; i++)
+                    batch.push_back(dataset.pin_parametric_mesh(i));
+            });
 
-        double min = DBL_MAX, max = -DBL_MAX;
-        for (uint ii=0; ii < sf.size(); ii++)
-        {
-            if (sf[ii] < min) min = sf[ii];
-            if (sf[ii] > max) max = sf[ii];
-        }
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (int b=0; b < static_cast<int>(batch.size()); b++)
+            {
+                if (task.is_canceled()) continue;
 
-        if (min != max)
-            sf.normalize_in_01();
+                const uint i = first + static_cast<uint>(b);
 
-        sf.copy_to_mesh(*ui->solverResultsWidget->get_gt_mesh(i));
+                const std::string files[2] = { prefixes.at(i) + postfix_sol, prefixes.at(i) + postfix_gt };
+                const cinolib::DrawablePolygonmesh<> *m = batch.at(b);
 
+                bool read[2];
 
-        for (uint vid=0; vid < ui->solverResultsWidget->get_gt_mesh(i)->num_verts(); vid++ )
-        {
-            ui->solverResultsWidget->get_gt_mesh(i)->vert_data(vid).color = cinolib::Color::red_white_blue_ramp_01(sf[vid]);
-            std::cout << ui->solverResultsWidget->get_gt_mesh(i)->vert(vid) <<  " -- " << sf[vid] << std::endl;
-        }
+                for (uint k=0; k < 2; k++)
+                {
+                    read[k] = read_vertex_field(files[k], m->num_verts(), values[k].at(b));
+                    if (!read[k]) values[k].at(b).clear();
+                }
 
-        in.close();
-    }
+                // one mesh at a time per thread, the polygons of a mesh are not
+                // split any further. The reference is the ground truth field
+                // loaded with the solution, not a guessed analytical one
+                if (read[0] && read[1])
+                    compute_local_errors(*m, values[0].at(b), values[1].at(b), nullptr,
+                                         local_errs.at(0).at(i), local_errs.at(1).at(i), local_errs.at(2).at(i));
+
+                task.step_done();
+            }
 
-    ui->solverResultsWidget->show_mesh_solution_and_groundtruth();
+            // canceled meshes are shown without fields
+            on_gui_thread([&]()
+            {
+                for (uint b=0; b < batch.size(); b++)
+                {
+                    ui->solverResultsWidget->set_fields(first + b, values[0].at(b), values[1].at(b));
+                    dataset.unpin_parametric_mesh(batch.at(b));
+                }
+            });
+        }
+    });
+
+    ui->scatterPlotsGPWidget->set_local_errors(local_errs);
 
     ui->tab_widgets->setTabEnabled(3, true);
     ui->tab_widgets->setCurrentIndex(3);
@@ -978,12 +1042,18 @@ void MainWindow::show_solver_results(const uint solution_id, const std::string f
 
 void MainWindow::on_reset_btn_clicked()
 {
+    ui->solverResultsWidget->clear();
+
     delete ui->datasetWidget;
     delete ui->metricsWidget;
     delete ui->graphicMeshMetricWidget;
     delete ui->solverWidget;
     delete ui->solverResultsWidget;
 
+    // the new widgets start on an empty dataset
+    metrics.clear();
+    dataset.clean();
+
     ui->datasetWidget = new DatasetWidget(this);
     ui->datasetWidget->set_dataset(&dataset);
     ui->dataset_tab->layout()->addWidget(ui->datasetWidget);
@@ -1008,44 +1078,49 @@ void MainWindow::on_reset_btn_clicked()
     connect(ui->solverWidget, SIGNAL (solver_completed (const uint, const std::string, const std::string)), this, SLOT (show_solver_results (const uint, const std::string, const std::string)));
 
     connect(ui->datasetWidget, SIGNAL (saved_in(const std::string)), this, SLOT (update_solver_input_folder (const std::string)));
+    connect(ui->datasetWidget, SIGNAL (meshes_edited()), ui->solverResultsWidget, SLOT (geometry_changed()));
 
     ui->tab_widgets->setCurrentIndex(ui->tab_widgets->count()-1);
 
     for (int i=1; i < ui->tab_widgets->count()-1; i++)
         ui->tab_widgets->setTabEnabled(i, false);
 
-    metrics.clear();
-    dataset.clean();
-
     folder = "";
 }
 
 void MainWindow::on_tab_widgets_currentChanged(int index)
 {
+    // the color modes of the solver results, still being switched, must
+    // not override the ones set below
+    ui->solverResultsWidget->get_render_queue()->flush();
+
+    // the render data prefetched by the widgets are about to be rebuilt in
+    // another color mode
+    ui->datasetWidget->drop_prefetched_meshes();
+    ui->solverWidget->drop_prefetched_meshes();
+    ui->solverResultsWidget->drop_prefetched_meshes();
+
     if (index == 0)
     {
-        if (dataset.get_parametric_meshes().size() == 0)
+        if (dataset.get_num_parametric_meshes() == 0)
             return;
 
-        for (cinolib::DrawablePolygonmesh<> * p : ui->datasetWidget->get_dataset()->get_parametric_meshes())
+        for (cinolib::DrawablePolygonmesh<> * p : dataset.get_resident_parametric_meshes())
             p->show_vert_color();
     }
     else
     if (index == 1)
     {
-        ui->graphicMeshMetricWidget->set_slider_max(static_cast<const uint>( dataset.get_parametric_meshes().size()-1));
+        ui->graphicMeshMetricWidget->set_slider_max(static_cast<const uint>( dataset.get_num_parametric_meshes()-1));
 
-        for (cinolib::DrawablePolygonmesh<> * p : ui->datasetWidget->get_dataset()->get_parametric_meshes())
+        for (cinolib::DrawablePolygonmesh<> * p : dataset.get_resident_parametric_meshes())
             p->show_poly_color();
     }
     else
     if (index == 2) // solver widget
     {
-        for (uint m=0; m < dataset.get_parametric_meshes().size(); m++)
-        {
-            dataset.get_parametric_mesh(m)->poly_set_color(cinolib::Color(1,1,1));
-            dataset.get_parametric_mesh(m)->show_poly_color();
-        }
+        for (cinolib::DrawablePolygonmesh<> * p : dataset.get_resident_parametric_meshes())
+            p->show_poly_color();
 
         ui->solverWidget->update();
     }
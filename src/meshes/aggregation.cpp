@@ -0,0 +1,521 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "aggregation.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+
+using namespace cinolib;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool merge_poly_loops (const std::vector<uint> & loop_a,
+                       const std::vector<uint> & loop_b,
+                       PolyMergeScratch        & scratch,
+                       std::vector<uint>       & merged)
+{
+    const uint na = static_cast<uint>(loop_a.size());
+    const uint nb = static_cast<uint>(loop_b.size());
+
+    if (na < 3 || nb < 3) return false;
+
+    if (++scratch.epoch == 0)
+    {
+        std::fill(scratch.stamp.begin(), scratch.stamp.end(), 0);
+        scratch.epoch = 1;
+    }
+
+    // position of each vertex of B along its loop
+    for (uint i=0; i < nb; i++)
+    {
+        uint v = loop_b.at(i);
+
+        if (v >= scratch.stamp.size())
+        {
+            scratch.stamp.resize(v+1, 0);
+            scratch.pos.resize(v+1, 0);
+        }
+
+        if (scratch.stamp.at(v) == scratch.epoch) return false; // B is not simple
+
+        scratch.stamp.at(v) = scratch.epoch;
+        scratch.pos.at(v)   = i;
+    }
+
+    auto in_b = [&](const uint v)
+    {
+        return v < scratch.stamp.size() && scratch.stamp.at(v) == scratch.epoch;
+    };
+
+    // with consistent winding a shared edge a_i -> a_i+1 is traversed by B
+    // as a_i+1 -> a_i. If B has the opposite winding, it is walked backwards.
+    int dir = 0;
+    for (uint i=0; i < na && dir == 0; i++)
+    {
+        uint v0 = loop_a.at(i);
+        uint v1 = loop_a.at((i+1)%na);
+
+        if (!in_b(v0) || !in_b(v1)) continue;
+
+        uint p1 = scratch.pos.at(v1);
+
+        if      (loop_b.at((p1+1)%nb)    == v0) dir =  1;
+        else if (loop_b.at((p1+nb-1)%nb) == v0) dir = -1;
+    }
+
+    if (dir == 0) return false; // no shared edge
+
+    auto b_next = [&](const uint p)
+    {
+        return (dir > 0) ? (p+1)%nb : (p+nb-1)%nb;
+    };
+
+    auto is_shared = [&](const uint i)
+    {
+        uint v0 = loop_a.at(i);
+        uint v1 = loop_a.at((i+1)%na);
+
+        return in_b(v0) && in_b(v1) && loop_b.at(b_next(scratch.pos.at(v1))) == v0;
+    };
+
+    // the shared edges must form a single chain a_s -> ... -> a_s+k
+    uint k      = 0;
+    uint n_runs = 0;
+    uint s      = 0;
+    uint n_common_verts = 0;
+
+    bool prev_shared = is_shared(na-1);
+    for (uint i=0; i < na; i++)
+    {
+        bool curr_shared = is_shared(i);
+
+        if (curr_shared)
+        {
+            k++;
+
+            if (!prev_shared)
+            {
+                n_runs++;
+                s = i;
+            }
+        }
+
+        if (in_b(loop_a.at(i))) n_common_verts++;
+
+        prev_shared = curr_shared;
+    }
+
+    if (n_runs != 1 || k >= na || k >= nb) return false;
+
+    // any common vertex outside the chain would be a pinch point
+    if (n_common_verts != k+1) return false;
+
+    merged.clear();
+    merged.reserve(na + nb - 2*k);
+
+    // A from the end of the chain back to its beginning ...
+    for (uint t=0; t < na-k; t++)
+        merged.push_back(loop_a.at((s+k+t)%na));
+
+    // ... then B from the beginning of the chain to its end
+    uint p = scratch.pos.at(loop_a.at(s));
+    for (uint t=0; t < nb-k; t++)
+    {
+        merged.push_back(loop_b.at(p));
+        p = b_next(p);
+    }
+
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+double aggregation_value (const Polygonmesh<> & m,
+                          const uint            pid,
+                          const uint            adj_pid,
+                          const int             aggregation_type)
+{
+    const std::vector<uint> & points_pid = m.adj_p2v(pid);
+    const std::vector<uint> & points_adj = m.adj_p2v(adj_pid);
+
+    // shared vertices are visited twice, which does not affect the max
+    double diameter = 0.0;
+    for (uint i=0; i < points_pid.size() + points_adj.size(); i++)
+    {
+        const vec3d & p = (i < points_pid.size()) ? m.vert(points_pid.at(i)) : m.vert(points_adj.at(i-points_pid.size()));
+
+        for (uint j=i+1; j < points_pid.size() + points_adj.size(); j++)
+        {
+            const vec3d & q = (j < points_pid.size()) ? m.vert(points_pid.at(j)) : m.vert(points_adj.at(j-points_pid.size()));
+            diameter = std::max(diameter, p.dist(q));
+        }
+    }
+
+    if (aggregation_type == 0) return diameter;
+
+    double min_e = inf_double;
+    for (auto eid : m.adj_p2e(pid))
+        if(!(m.poly_contains_edge(adj_pid,eid)))
+            min_e = std::min(min_e, m.edge_length(eid));
+
+    for (auto eid : m.adj_p2e(adj_pid))
+        if(!(m.poly_contains_edge(pid,eid)))
+            min_e = std::min(min_e, m.edge_length(eid));
+
+    double area = m.poly_area(pid) + m.poly_area(adj_pid);
+    double rho = diameter / std::min(sqrt(area), min_e);
+
+    if (aggregation_type == 2) return rho;
+
+    return rho * rho * area;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void aggregate_triangles (Polygonmesh<> &dm, const double value_b, const int aggregation_type)
+{
+    if (aggregation_type < 0 || aggregation_type > 3) return;
+
+    PolyMergeScratch scratch;
+    std::set<std::pair<uint,uint>> rejected; // pairs that cannot be merged into a simple polygon
+
+    bool ok = false;
+    while (!ok)
+    {
+        std::map<double, std::pair<uint,uint>> value2pid; // = (value, (pid1,pid2))
+        std::set<std::pair<uint,uint>> already;
+
+        for (uint pid = 0; pid < dm.num_polys(); pid++)
+        {
+            if (dm.poly_data(pid).flags.test(1)) continue;
+
+            for (uint adj_pid : dm.adj_p2p(pid))    // poligoni adiacenti a pid
+            {
+                if (dm.poly_data(adj_pid).flags.test(1)) continue;
+
+                if (already.find(std::pair<uint,uint>(adj_pid, pid)) != already.end() ) continue;
+
+                already.insert(std::pair<uint,uint> (adj_pid, pid));
+                already.insert(std::pair<uint,uint> (pid, adj_pid));
+
+                if (rejected.find(std::pair<uint,uint>(adj_pid, pid)) != rejected.end()) continue;
+
+                if (aggregation_type == 1)
+                {
+                    double val = rand() % 1000;
+
+                    if (dm.num_polys() <= 50)
+                        val = 1000 + val;
+
+                    value2pid.insert(std::pair<double, std::pair<uint,uint>> (val, std::pair<uint,uint> (adj_pid, pid)));
+
+                    break;
+                }
+
+                double value = aggregation_value(dm, pid, adj_pid, aggregation_type);
+
+                value2pid.insert(std::pair<double, std::pair<uint,uint>> (value, std::pair<uint,uint> (adj_pid, pid)));
+            }
+        }
+
+        if (value2pid.empty())
+        {
+            ok = true;
+            break;
+        }
+
+        uint pid_tb_merged = (*value2pid.begin()).second.first;
+        uint pid_tb_merged_2 = (*value2pid.begin()).second.second;
+        double value = (*value2pid.begin()).first;
+
+        if (value > value_b )    ok = true;
+        else        //se il valore è < di quello di bound, unisco
+        {
+            std::vector<uint> verts;
+
+            if (merge_poly_loops(dm.adj_p2v(pid_tb_merged), dm.adj_p2v(pid_tb_merged_2), scratch, verts))
+            {
+                dm.poly_add(verts);
+
+                dm.poly_remove(std::max (pid_tb_merged_2, pid_tb_merged));
+                dm.poly_remove(std::min (pid_tb_merged_2, pid_tb_merged));
+
+                rejected.clear(); // poly ids have changed
+            }
+            else
+                rejected.insert(std::pair<uint,uint> (pid_tb_merged, pid_tb_merged_2));
+        }
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+typedef struct
+{
+    double value;
+    uint   pid_a;
+    uint   pid_b;
+} MergeCandidate;
+
+bool operator< (const MergeCandidate &c0, const MergeCandidate &c1)
+{
+    if (c0.value != c1.value) return c0.value < c1.value;
+    if (c0.pid_a != c1.pid_a) return c0.pid_a < c1.pid_a;
+    return c0.pid_b < c1.pid_b;
+}
+
+// splitmix64, used in place of rand() so that random aggregation is
+// reproducible and does not depend on the order threads visit the pairs
+uint64_t mix_hash (uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+double random_value (const uint seed, const uint round, const uint pid_a, const uint pid_b)
+{
+    uint64_t h = mix_hash(seed);
+    h = mix_hash(h ^ round);
+    h = mix_hash(h ^ ((static_cast<uint64_t>(pid_a) << 32) | pid_b));
+    return static_cast<double>(h % 1000);
+}
+
+// scores and validates every candidate pair below value_b, concurrently.
+// Pairs are listed once, from their lower id, in the same order whatever
+// the number of threads.
+void collect_candidates (const Polygonmesh<>          & m,
+                         const double                   value_b,
+                         const int                      aggregation_type,
+                         const uint                     seed,
+                         const uint                     round,
+                         std::vector<MergeCandidate>  & candidates)
+{
+    const int n_polys = static_cast<int>(m.num_polys());
+
+    std::vector<std::vector<MergeCandidate>> poly_candidates (n_polys);
+
+    #pragma omp parallel
+    {
+        PolyMergeScratch scratch;
+        std::vector<uint> loop;
+
+        #pragma omp for schedule(dynamic, 256)
+        for (int pid = 0; pid < n_polys; pid++)
+        {
+            if (m.poly_data(pid).flags.test(1)) continue;
+
+            for (uint adj_pid : m.adj_p2p(pid))
+            {
+                if (adj_pid < static_cast<uint>(pid)) continue;
+                if (m.poly_data(adj_pid).flags.test(1)) continue;
+
+                double value;
+
+                if (aggregation_type == 1)
+                {
+                    value = random_value(seed, round, pid, adj_pid);
+
+                    if (n_polys <= 50)
+                        value = 1000 + value;
+                }
+                else
+                    value = aggregation_value(m, pid, adj_pid, aggregation_type);
+
+                if (value > value_b) continue;
+
+                if (!merge_poly_loops(m.adj_p2v(pid), m.adj_p2v(adj_pid), scratch, loop)) continue;
+
+                MergeCandidate c;
+                c.value = value;
+                c.pid_a = pid;
+                c.pid_b = adj_pid;
+                poly_candidates.at(pid).push_back(c);
+            }
+        }
+    }
+
+    candidates.clear();
+    for (const std::vector<MergeCandidate> &pc : poly_candidates)
+        candidates.insert(candidates.end(), pc.begin(), pc.end());
+}
+
+// merges each selected (pid_a, pid_b) pair in one batch. Pairs must not
+// share polygons, so their merged loops can be built concurrently.
+void apply_merges (Polygonmesh<> & m, const std::vector<MergeCandidate> & merges)
+{
+    std::vector<std::vector<uint>> loops (merges.size());
+
+    #pragma omp parallel
+    {
+        PolyMergeScratch scratch;
+
+        #pragma omp for schedule(dynamic, 256)
+        for (int i = 0; i < static_cast<int>(merges.size()); i++)
+            merge_poly_loops(m.adj_p2v(merges.at(i).pid_a), m.adj_p2v(merges.at(i).pid_b), scratch, loops.at(i));
+    }
+
+    std::vector<uint> poly_tb_rem;
+    poly_tb_rem.reserve(2*merges.size());
+
+    for (uint i=0; i < merges.size(); i++)
+    {
+        m.poly_add(loops.at(i));
+        poly_tb_rem.push_back(merges.at(i).pid_a);
+        poly_tb_rem.push_back(merges.at(i).pid_b);
+    }
+
+    // removing from the highest id keeps the pending ids valid
+    std::sort(poly_tb_rem.begin(), poly_tb_rem.end(), std::greater<uint>());
+
+    for (uint pid : poly_tb_rem)
+        m.poly_remove(pid);
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void aggregate_triangles_parallel (Polygonmesh<> &m, const double value_b, const int aggregation_type, const uint seed)
+{
+    if (aggregation_type < 0 || aggregation_type > 3) return;
+
+    std::vector<MergeCandidate> candidates;
+
+    for (uint round = 0; ; round++)
+    {
+        const int n_polys = static_cast<int>(m.num_polys());
+
+        collect_candidates(m, value_b, aggregation_type, seed, round, candidates);
+
+        if (candidates.empty()) break;
+
+        std::sort(candidates.begin(), candidates.end());
+
+        // best pairs first, skipping those touching an already selected neighborhood
+        std::vector<bool> locked (n_polys, false);
+        std::vector<MergeCandidate> selected;
+
+        for (const MergeCandidate &c : candidates)
+        {
+            if (locked.at(c.pid_a) || locked.at(c.pid_b)) continue;
+
+            // random aggregation stops at 50 polygons
+            if (aggregation_type == 1 && n_polys - static_cast<int>(selected.size()) <= 50) break;
+
+            selected.push_back(c);
+
+            locked.at(c.pid_a) = true;
+            locked.at(c.pid_b) = true;
+            for (uint pid : m.adj_p2p(c.pid_a)) locked.at(pid) = true;
+            for (uint pid : m.adj_p2p(c.pid_b)) locked.at(pid) = true;
+        }
+
+        if (selected.empty()) break;
+
+        apply_merges(m, selected);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void aggregate_triangles_multilevel (Polygonmesh<> &m, const double value_b, const int aggregation_type, const uint target_polys, const uint seed)
+{
+    if (aggregation_type < 0 || aggregation_type > 3) return;
+
+    std::vector<MergeCandidate> candidates;
+
+    for (uint level = 0; m.num_polys() > target_polys; level++)
+    {
+        const uint n_polys = m.num_polys();
+
+        collect_candidates(m, value_b, aggregation_type, seed, level, candidates);
+
+        if (candidates.empty()) break;
+
+        // dual graph restricted to the admissible edges
+        std::vector<std::vector<uint>> poly2cand (n_polys);
+        for (uint i=0; i < candidates.size(); i++)
+        {
+            poly2cand.at(candidates.at(i).pid_a).push_back(i);
+            poly2cand.at(candidates.at(i).pid_b).push_back(i);
+        }
+
+        std::vector<uint> order (n_polys);
+        for (uint pid=0; pid < n_polys; pid++) order.at(pid) = pid;
+
+        std::mt19937 rng (seed + level);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        // heavy-edge matching: each unmatched polygon, in random order, is
+        // paired with the unmatched neighbor giving the lowest value
+        std::vector<bool> matched (n_polys, false);
+        std::vector<MergeCandidate> selected;
+
+        for (uint pid : order)
+        {
+            if (n_polys - selected.size() <= target_polys) break;
+
+            if (matched.at(pid)) continue;
+
+            int best = -1;
+            for (uint i : poly2cand.at(pid))
+            {
+                const MergeCandidate &c = candidates.at(i);
+                uint adj_pid = (c.pid_a == pid) ? c.pid_b : c.pid_a;
+
+                if (matched.at(adj_pid)) continue;
+
+                if (best < 0 || c < candidates.at(best)) best = static_cast<int>(i);
+            }
+
+            if (best < 0) continue;
+
+            const MergeCandidate &c = candidates.at(best);
+            matched.at(c.pid_a) = true;
+            matched.at(c.pid_b) = true;
+            selected.push_back(c);
+        }
+
+        if (selected.empty()) break;
+
+        apply_merges(m, selected);
+    }
+}
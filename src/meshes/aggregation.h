@@ -0,0 +1,96 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef AGGREGATION_H
+#define AGGREGATION_H
+
+#include <cinolib/meshes/meshes.h>
+
+#include <vector>
+
+// Aggregation modes. Whatever the mode, polygons with flags.test(1) set
+// (PEM elements) are never merged.
+typedef enum
+{
+    GREEDY_AGGREGATION,             // one pair at a time, best pair first
+    PARALLEL_AGGREGATION,           // batches of independent pairs per round
+    MULTILEVEL_AGGREGATION          // heavy-edge matching of the dual graph
+}
+AGGREGATION_MODES;
+
+// Scratch buffers reused across merge tests. Vertex ids are stamped rather
+// than cleared, so once the buffers have grown to the mesh size a test
+// costs O(k) in the number of polygon sides and does not allocate.
+typedef struct
+{
+    std::vector<uint> stamp;
+    std::vector<uint> pos;
+    uint              epoch = 0;
+} PolyMergeScratch;
+
+// Checks whether the polygons bounded by loop_a and loop_b can be merged
+// into a single simple polygon: they must share exactly one contiguous
+// chain of edges and no other vertex (no pinch points). On success the
+// ordered vertex loop of the merged polygon, with the winding of loop_a,
+// is returned in merged.
+bool merge_poly_loops (const std::vector<uint> & loop_a,
+                       const std::vector<uint> & loop_b,
+                       PolyMergeScratch        & scratch,
+                       std::vector<uint>       & merged);
+
+// Value of merging the adjacent polygons pid and adj_pid according to the
+// aggregation type (0: diameter, 2: VEM rho, 3: VEM rho * area). Lower is
+// better. The random type (1) is handled by the callers.
+double aggregation_value (const cinolib::Polygonmesh<> & m,
+                          const uint                     pid,
+                          const uint                     adj_pid,
+                          const int                      aggregation_type);
+
+void aggregate_triangles (cinolib::Polygonmesh<> &m, const double value_b, const int aggregation_type);
+
+// Each round collects every candidate pair below value_b, scoring and
+// validating them concurrently, selects a maximal set of pairs whose
+// neighborhoods do not overlap and merges them in a batch. The result
+// only depends on the seed, not on the number of threads.
+void aggregate_triangles_parallel (cinolib::Polygonmesh<> &m, const double value_b, const int aggregation_type, const uint seed);
+
+
+// Multilevel coarsening of the polygon dual graph, as in METIS. At each
+// level a heavy-edge matching is computed, visiting polygons in a seeded
+// random order and pairing each one with the unmatched neighbor giving the
+// lowest aggregation value below value_b, and all matched pairs are merged.
+// Stops when the mesh has at most target_polys polygons or no pair can be
+// matched. Each level is linear in the number of polygons.
+void aggregate_triangles_multilevel (cinolib::Polygonmesh<> &m, const double value_b, const int aggregation_type, const uint target_polys, const uint seed);
+
+
+#endif // AGGREGATION_H
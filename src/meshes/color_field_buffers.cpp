@@ -0,0 +1,207 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+
+#include "color_field_buffers.h"
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+void upload(const GLenum target, uint &buffer, const void *data, const size_t bytes, const GLenum usage)
+{
+    if (buffer == 0) glGenBuffers(1, &buffer);
+
+    glBindBuffer(target, buffer);
+    glBufferData(target, static_cast<GLsizeiptr>(bytes), data, usage);
+    glBindBuffer(target, 0);
+}
+
+void delete_buffer(uint &buffer)
+{
+    if (buffer != 0) glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+ColorFieldBuffers::~ColorFieldBuffers()
+{
+    delete_buffer(vbo_coords);
+    delete_buffer(vbo_colors);
+    delete_buffer(vbo_edge_coords);
+    delete_buffer(ibo_tris);
+    delete_buffer(ibo_edges);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void ColorFieldBuffers::upload_coords(const std::vector<float> &coords)
+{
+    upload(GL_ARRAY_BUFFER, vbo_coords, coords.data(), coords.size() * sizeof(float), GL_STATIC_DRAW);
+    n_verts = coords.size() / 3;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void ColorFieldBuffers::upload_tris(const std::vector<uint> &tris)
+{
+    upload(GL_ELEMENT_ARRAY_BUFFER, ibo_tris, tris.data(), tris.size() * sizeof(uint), GL_STATIC_DRAW);
+    n_tri_ids = tris.size();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void ColorFieldBuffers::upload_edges(const std::vector<uint> &edges)
+{
+    upload(GL_ELEMENT_ARRAY_BUFFER, ibo_edges, edges.data(), edges.size() * sizeof(uint), GL_STATIC_DRAW);
+    n_edge_ids = edges.size();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void ColorFieldBuffers::upload_edge_coords(const std::vector<float> &edge_coords)
+{
+    upload(GL_ARRAY_BUFFER, vbo_edge_coords, edge_coords.data(), edge_coords.size() * sizeof(float), GL_STATIC_DRAW);
+    n_edge_verts = edge_coords.size() / 3;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void ColorFieldBuffers::upload_colors(const std::vector<unsigned char> &colors)
+{
+    // same geometry, the buffer is overwritten in place
+    if (vbo_colors != 0 && colors_bytes == colors.size())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_colors);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(colors.size()), colors.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return;
+    }
+
+    upload(GL_ARRAY_BUFFER, vbo_colors, colors.data(), colors.size(), GL_DYNAMIC_DRAW);
+    colors_bytes = colors.size();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void ColorFieldBuffers::draw() const
+{
+    if (vbo_coords == 0 || vbo_colors == 0) return;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_POLYGON_BIT | GL_LINE_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.0, 1.0);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_coords);
+    glVertexPointer(3, GL_FLOAT, 0, nullptr);
+
+    glEnableClientState(GL_COLOR_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_colors);
+    glColorPointer(3, GL_UNSIGNED_BYTE, 0, nullptr);
+
+    if (ibo_tris != 0)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_tris);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(n_tri_ids), GL_UNSIGNED_INT, nullptr);
+    }
+    else glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(n_verts));
+
+    glDisableClientState(GL_COLOR_ARRAY);
+
+    // edges, in front of the triangles pushed back by the polygon offset
+    glColor3f(0.f, 0.f, 0.f);
+    glLineWidth(1.f);
+
+    if (ibo_edges != 0)
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_edges);
+        glDrawElements(GL_LINES, static_cast<GLsizei>(n_edge_ids), GL_UNSIGNED_INT, nullptr);
+    }
+    else if (vbo_edge_coords != 0)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_edge_coords);
+        glVertexPointer(3, GL_FLOAT, 0, nullptr);
+        glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(n_edge_verts));
+    }
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glPopAttrib();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void field_scene_bounds(const Polygonmesh<> &m, vec3d &center, float &radius)
+{
+    if (m.num_verts() == 0) return;
+
+    vec3d bb_min( std::numeric_limits<double>::max(),  std::numeric_limits<double>::max(),  std::numeric_limits<double>::max());
+    vec3d bb_max(-std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(), -std::numeric_limits<double>::max());
+
+    for (uint vid=0; vid < m.num_verts(); vid++)
+    {
+        const vec3d &p = m.vert(vid);
+        for (uint k=0; k < 3; k++)
+        {
+            bb_min[k] = std::min(bb_min[k], p[k]);
+            bb_max[k] = std::max(bb_max[k], p[k]);
+        }
+    }
+
+    center = (bb_min + bb_max) * 0.5;
+    radius = static_cast<float>((bb_max - bb_min).norm() * 0.5);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void color_to_rgb8(const Color &c, unsigned char *rgb)
+{
+    rgb[0] = static_cast<unsigned char>(std::round(255.f * std::min(std::max(c.r, 0.f), 1.f)));
+    rgb[1] = static_cast<unsigned char>(std::round(255.f * std::min(std::max(c.g, 0.f), 1.f)));
+    rgb[2] = static_cast<unsigned char>(std::round(255.f * std::min(std::max(c.b, 0.f), 1.f)));
+}
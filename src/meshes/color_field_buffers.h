@@ -0,0 +1,106 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+
+#ifndef COLOR_FIELD_BUFFERS_H
+#define COLOR_FIELD_BUFFERS_H
+
+#include <cinolib/meshes/polygonmesh.h>
+
+#include <vector>
+
+using namespace cinolib;
+
+// GPU buffers of a color field drawn on triangles, flat (without lighting),
+// with black edges on top. Shared by the drawable objects that show fields
+// on a mesh without the full rebuild of DrawablePolygonmesh::updateGL
+// (PolygonHeatmap, VertexFieldView). Triangles and edges are either listed
+// by vertex ids or, if no ids are given, drawn in the order of their vertex
+// coordinates.
+//
+// Buffers are created and uploaded in the draw() of the owner, in the
+// context of the canvas; they must be deleted with that context current.
+
+class ColorFieldBuffers
+{
+    public:
+
+        ColorFieldBuffers() {}
+        ~ColorFieldBuffers();
+
+        ColorFieldBuffers (const ColorFieldBuffers &) = delete;
+        ColorFieldBuffers & operator= (const ColorFieldBuffers &) = delete;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // xyz per vertex
+        void upload_coords(const std::vector<float> &coords);
+
+        // 3 vertex ids per triangle and 2 per edge
+        void upload_tris (const std::vector<uint> &tris);
+        void upload_edges(const std::vector<uint> &edges);
+
+        // xyz of 2 vertices per edge, for edges not listed by vertex ids
+        void upload_edge_coords(const std::vector<float> &edge_coords);
+
+        // rgb per vertex. A buffer of the same size is overwritten in place
+        void upload_colors(const std::vector<unsigned char> &colors);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void draw() const;
+
+    private:
+
+        uint vbo_coords      = 0;
+        uint vbo_colors      = 0;
+        uint vbo_edge_coords = 0;
+        uint ibo_tris        = 0;
+        uint ibo_edges       = 0;
+
+        size_t n_verts      = 0;
+        size_t n_tri_ids    = 0;
+        size_t n_edge_ids   = 0;
+        size_t n_edge_verts = 0;
+        size_t colors_bytes = 0;    // allocated on the GPU
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// center and radius of the bounding sphere of the bounding box of m, as
+// returned by the scene_center and scene_radius of a drawable object
+void field_scene_bounds(const Polygonmesh<> &m, vec3d &center, float &radius);
+
+// r, g, b of c, clamped to [0,1] and scaled to [0,255]
+void color_to_rgb8(const Color &c, unsigned char *rgb);
+
+#endif // COLOR_FIELD_BUFFERS_H
@@ -0,0 +1,270 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "dataset_container.h"
+
+#include <cstring>
+#include <iostream>
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+inline uint64_t align8 (const uint64_t offset)
+{
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+// size of a mesh record, up to (excluded) the padding before the metrics
+inline uint64_t arrays_size (const DatasetContainerEntry &e)
+{
+    return 2 * sizeof(double)   * static_cast<uint64_t>(e.num_verts) +
+               sizeof(uint32_t) * (static_cast<uint64_t>(e.num_polys) + 1) +
+               sizeof(uint32_t) * static_cast<uint64_t>(e.num_corners) +
+               sizeof(uint8_t)  * static_cast<uint64_t>(e.num_polys);
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+DatasetContainerWriter::~DatasetContainerWriter()
+{
+    if (f != nullptr) fclose(f);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool DatasetContainerWriter::write(const void *data, const size_t size)
+{
+    if (size == 0) return true;
+    if (fwrite(data, 1, size, f) != size) return false;
+    offset += size;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool DatasetContainerWriter::open(const std::string &filename)
+{
+    f = fopen(filename.c_str(), "wb");
+    if (f == nullptr)
+    {
+        std::cerr << "ERROR: cannot write " << filename << std::endl;
+        return false;
+    }
+
+    index.clear();
+    offset = 0;
+
+    // the header is rewritten on close, once the index offset is known
+    DatasetContainerHeader header;
+    memset(&header, 0, sizeof(header));
+    return write(&header, sizeof(header));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool DatasetContainerWriter::add_mesh(const FlatPolygonMesh      & m,
+                                      const std::vector<uint8_t> & poly_flags,
+                                      const uint                   class_id,
+                                      const double                 t,
+                                      const MeshMetrics          * metrics,
+                                      const std::string          & name)
+{
+    if (f == nullptr || poly_flags.size() != m.num_polys()) return false;
+
+    static const char padding[8] = { 0 };
+
+    if (!write(padding, align8(offset) - offset)) return false;
+
+    DatasetContainerEntry e;
+    memset(&e, 0, sizeof(e));
+    e.offset      = offset;
+    e.num_verts   = m.num_verts();
+    e.num_polys   = m.num_polys();
+    e.num_corners = static_cast<uint32_t>(m.poly_verts.size());
+    e.class_id    = class_id;
+    e.t           = t;
+    e.has_metrics = (metrics != nullptr) ? 1 : 0;
+    e.name_length = static_cast<uint32_t>(name.size());
+
+    bool ok = write(m.coords.data(),       sizeof(double)   * m.coords.size())       &&
+              write(m.poly_offsets.data(), sizeof(uint32_t) * m.poly_offsets.size()) &&
+              write(m.poly_verts.data(),   sizeof(uint32_t) * m.poly_verts.size())   &&
+              write(poly_flags.data(),     sizeof(uint8_t)  * poly_flags.size());
+
+    if (ok && metrics != nullptr)
+        ok = write(padding, align8(offset) - offset) && write(metrics, sizeof(MeshMetrics));
+
+    ok = ok && write(name.data(), name.size());
+
+    if (ok) index.push_back(e);
+    return ok;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool DatasetContainerWriter::close()
+{
+    if (f == nullptr) return false;
+
+    static const char padding[8] = { 0 };
+
+    bool ok = write(padding, align8(offset) - offset);
+
+    DatasetContainerHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DATASET_CONTAINER_MAGIC, sizeof(header.magic));
+    header.version      = DATASET_CONTAINER_VERSION;
+    header.num_meshes   = static_cast<uint32_t>(index.size());
+    header.metrics_size = sizeof(MeshMetrics);
+    header.index_offset = offset;
+
+    ok = ok && write(index.data(), sizeof(DatasetContainerEntry) * index.size());
+    ok = ok && (fseek(f, 0, SEEK_SET) == 0) && (fwrite(&header, sizeof(header), 1, f) == 1);
+    ok = (fclose(f) == 0) && ok;
+    f  = nullptr;
+
+    return ok;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool DatasetContainerReader::open(const std::string &filename)
+{
+    index.clear();
+
+    if (!file.open(filename))
+    {
+        std::cerr << "ERROR: cannot open " << filename << std::endl;
+        return false;
+    }
+
+    DatasetContainerHeader header;
+
+    if (file.size() < sizeof(header)) return false;
+    memcpy(&header, file.data(), sizeof(header));
+
+    if (memcmp(header.magic, DATASET_CONTAINER_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DATASET_CONTAINER_VERSION)
+    {
+        std::cerr << "ERROR: " << filename << " is not a PEMesh dataset container" << std::endl;
+        return false;
+    }
+
+    if (header.index_offset + sizeof(DatasetContainerEntry) * static_cast<uint64_t>(header.num_meshes) > file.size())
+    {
+        std::cerr << "ERROR: " << filename << " is truncated" << std::endl;
+        return false;
+    }
+
+    metrics_size = header.metrics_size;
+
+    index.resize(header.num_meshes);
+    memcpy(index.data(), file.data() + header.index_offset, sizeof(DatasetContainerEntry) * index.size());
+
+    for (const DatasetContainerEntry &e : index)
+    {
+        uint64_t end = e.offset + arrays_size(e) + e.name_length;
+        if (e.has_metrics) end = align8(e.offset + arrays_size(e)) + metrics_size + e.name_length;
+
+        if (end > header.index_offset)
+        {
+            std::cerr << "ERROR: " << filename << " has a corrupted index" << std::endl;
+            index.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+std::string DatasetContainerReader::name(const uint i) const
+{
+    const DatasetContainerEntry &e = index.at(i);
+
+    uint64_t offset = e.offset + arrays_size(e);
+    if (e.has_metrics) offset = align8(offset) + metrics_size;
+
+    return std::string(file.data() + offset, e.name_length);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool DatasetContainerReader::read_mesh(const uint i, FlatPolygonMesh &m, std::vector<uint8_t> &poly_flags) const
+{
+    if (i >= index.size()) return false;
+
+    const DatasetContainerEntry &e = index.at(i);
+    const char *p = file.data() + e.offset;
+
+    m.coords.resize(2 * static_cast<size_t>(e.num_verts));
+    memcpy(m.coords.data(), p, sizeof(double) * m.coords.size());
+    p += sizeof(double) * m.coords.size();
+
+    m.poly_offsets.resize(static_cast<size_t>(e.num_polys) + 1);
+    memcpy(m.poly_offsets.data(), p, sizeof(uint32_t) * m.poly_offsets.size());
+    p += sizeof(uint32_t) * m.poly_offsets.size();
+
+    m.poly_verts.resize(e.num_corners);
+    memcpy(m.poly_verts.data(), p, sizeof(uint32_t) * m.poly_verts.size());
+    p += sizeof(uint32_t) * m.poly_verts.size();
+
+    poly_flags.resize(e.num_polys);
+    memcpy(poly_flags.data(), p, poly_flags.size());
+
+    if (m.poly_offsets.back() != e.num_corners) return false;
+
+    for (uint vid : m.poly_verts)
+        if (vid >= e.num_verts) return false;
+
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool DatasetContainerReader::read_metrics(const uint i, MeshMetrics &metrics) const
+{
+    if (i >= index.size()) return false;
+
+    const DatasetContainerEntry &e = index.at(i);
+
+    // metrics written by a build with a different MeshMetrics layout are ignored
+    if (!e.has_metrics || metrics_size != sizeof(MeshMetrics)) return false;
+
+    memcpy(&metrics, file.data() + align8(e.offset + arrays_size(e)), sizeof(MeshMetrics));
+    return true;
+}
@@ -0,0 +1,129 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef DATASET_CONTAINER_H
+#define DATASET_CONTAINER_H
+
+#include "mapped_file.h"
+#include "mesh_metrics.h"
+#include "polygon_mesh_io.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Single-file binary container for a whole dataset (.pemd), in native
+// byte order. The file starts with a fixed header and ends with an index
+// holding one entry per mesh, so any mesh is read without scanning the
+// others. Each mesh record is 8-byte aligned and stores:
+//
+//   double   coords       [2 * num_verts]     (x,y)
+//   uint32   poly_offsets [num_polys + 1]     (CSR connectivity)
+//   uint32   poly_verts   [num_corners]
+//   uint8    poly_flags   [num_polys]         (bit 0: PEM element)
+//   MeshMetrics                               (optional)
+//   char     name         [name_length]
+
+static const char     DATASET_CONTAINER_MAGIC[8] = { 'P','E','M','D','S','E','T','\0' };
+static const uint32_t DATASET_CONTAINER_VERSION  = 1;
+
+typedef struct
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t num_meshes;
+    uint32_t metrics_size;      // sizeof(MeshMetrics) of the writer
+    uint32_t reserved;
+    uint64_t index_offset;
+} DatasetContainerHeader;
+
+typedef struct
+{
+    uint64_t offset;            // start of the mesh record
+    uint32_t num_verts;
+    uint32_t num_polys;
+    uint32_t num_corners;
+    uint32_t class_id;
+    double   t;
+    uint32_t has_metrics;
+    uint32_t name_length;
+} DatasetContainerEntry;
+
+class DatasetContainerWriter
+{
+    public:
+
+        DatasetContainerWriter() {}
+        ~DatasetContainerWriter();
+
+        bool open  (const std::string &filename);
+        bool add_mesh (const FlatPolygonMesh      & m,
+                       const std::vector<uint8_t> & poly_flags,
+                       const uint                   class_id,
+                       const double                 t,
+                       const MeshMetrics          * metrics,
+                       const std::string          & name);
+        bool close ();
+
+    private:
+
+        bool write (const void *data, const size_t size);
+
+        FILE                              * f = nullptr;
+        uint64_t                            offset = 0;
+        std::vector<DatasetContainerEntry>  index;
+};
+
+class DatasetContainerReader
+{
+    public:
+
+        bool open (const std::string &filename);
+
+        uint num_meshes () const { return static_cast<uint>(index.size()); }
+
+        const DatasetContainerEntry & entry (const uint i) const { return index.at(i); }
+
+        std::string name (const uint i) const;
+
+        bool read_mesh    (const uint i, FlatPolygonMesh &m, std::vector<uint8_t> &poly_flags) const;
+        bool read_metrics (const uint i, MeshMetrics &metrics) const;
+
+    private:
+
+        MappedFile                          file;
+        uint32_t                            metrics_size = 0;
+        std::vector<DatasetContainerEntry>  index;
+};
+
+#endif // DATASET_CONTAINER_H
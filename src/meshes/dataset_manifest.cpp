@@ -0,0 +1,225 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "dataset_manifest.h"
+#include "mapped_file.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+const uint64_t FNV_OFFSET = 14695981039346656037ull;
+const uint64_t FNV_PRIME  = 1099511628211ull;
+
+inline uint64_t fnv1a (const void *data, const size_t size, uint64_t h)
+{
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+
+    for (size_t i=0; i < size; i++)
+    {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+
+    return h;
+}
+
+const char     METRICS_CACHE_MAGIC[8] = { 'P','E','M','M','E','T','R','\0' };
+const uint32_t MANIFEST_VERSION       = 1;
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+uint64_t hash_bytes(const void *data, const size_t size, const uint64_t h)
+{
+    return fnv1a(data, size, h);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+uint64_t mesh_content_hash(const FlatPolygonMesh &m)
+{
+    uint64_t h = FNV_OFFSET;
+    h = fnv1a(m.coords.data(),       sizeof(double) * m.coords.size(),       h);
+    h = fnv1a(m.poly_offsets.data(), sizeof(uint)   * m.poly_offsets.size(), h);
+    h = fnv1a(m.poly_verts.data(),   sizeof(uint)   * m.poly_verts.size(),   h);
+    return h;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+uint64_t metrics_cache_key(const uint64_t content_hash)
+{
+    const uint64_t layout = sizeof(MeshMetrics);
+
+    uint64_t h = FNV_OFFSET;
+    h = fnv1a(&content_hash, sizeof(content_hash), h);
+    h = fnv1a(&layout,       sizeof(layout),       h);
+    return h;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool write_dataset_manifest(const std::string &filename, const std::vector<ManifestEntry> &entries)
+{
+    std::string buffer;
+    buffer.reserve(128 * (entries.size() + 1));
+
+    buffer += "# PEMesh dataset manifest " + std::to_string(MANIFEST_VERSION) + "\n";
+    buffer += "# filename\tclass_id\tt\tnum_verts\tnum_polys\tcontent_hash\tmetrics_key\n";
+
+    char line[128];
+
+    for (const ManifestEntry &e : entries)
+    {
+        buffer += e.filename;
+
+        snprintf(line, sizeof(line), "\t%u\t%.17g\t%u\t%u\t%016" PRIx64 "\t%016" PRIx64 "\n",
+                 e.class_id, e.t, e.num_verts, e.num_polys, e.content_hash, e.metrics_key);
+
+        buffer += line;
+    }
+
+    return write_buffer(filename, buffer);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool read_dataset_manifest(const std::string &filename, std::vector<ManifestEntry> &entries)
+{
+    entries.clear();
+
+    std::ifstream in (filename);
+
+    if (!in.is_open())
+    {
+        std::cerr << "ERROR: cannot open " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    uint line_number = 0;
+
+    while (std::getline(in, line))
+    {
+        line_number++;
+
+        if (line.empty() || line.at(0) == '#') continue;
+
+        // the file name may contain spaces, but not tabs
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos)
+        {
+            std::cerr << "ERROR: " << filename << ":" << line_number << ": malformed entry" << std::endl;
+            entries.clear();
+            return false;
+        }
+
+        ManifestEntry e;
+        e.filename = line.substr(0, tab);
+
+        if (sscanf(line.c_str() + tab + 1, "%u %lf %u %u %" SCNx64 " %" SCNx64,
+                   &e.class_id, &e.t, &e.num_verts, &e.num_polys, &e.content_hash, &e.metrics_key) != 6)
+        {
+            std::cerr << "ERROR: " << filename << ":" << line_number << ": malformed entry" << std::endl;
+            entries.clear();
+            return false;
+        }
+
+        entries.push_back(e);
+    }
+
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool write_metrics_cache(const std::string &filename, const std::vector<uint64_t> &keys, const std::vector<MeshMetrics> &metrics)
+{
+    if (keys.size() != metrics.size()) return false;
+
+    const uint64_t record_size = sizeof(MeshMetrics);
+
+    std::string buffer;
+    buffer.reserve(sizeof(METRICS_CACHE_MAGIC) + sizeof(record_size) + keys.size() * (sizeof(uint64_t) + sizeof(MeshMetrics)));
+
+    buffer.append(METRICS_CACHE_MAGIC, sizeof(METRICS_CACHE_MAGIC));
+    buffer.append(reinterpret_cast<const char *>(&record_size), sizeof(record_size));
+
+    for (size_t i=0; i < keys.size(); i++)
+    {
+        buffer.append(reinterpret_cast<const char *>(&keys.at(i)),    sizeof(uint64_t));
+        buffer.append(reinterpret_cast<const char *>(&metrics.at(i)), sizeof(MeshMetrics));
+    }
+
+    return write_buffer(filename, buffer);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool read_metrics_cache(const std::string &filename, std::unordered_map<uint64_t, MeshMetrics> &metrics)
+{
+    metrics.clear();
+
+    MappedFile file;
+    if (!file.open(filename)) return false;
+
+    const size_t header_size = sizeof(METRICS_CACHE_MAGIC) + sizeof(uint64_t);
+
+    if (file.size() < header_size || memcmp(file.data(), METRICS_CACHE_MAGIC, sizeof(METRICS_CACHE_MAGIC)) != 0)
+        return false;
+
+    // records written with a different MeshMetrics layout are not reusable
+    uint64_t record_size;
+    memcpy(&record_size, file.data() + sizeof(METRICS_CACHE_MAGIC), sizeof(record_size));
+    if (record_size != sizeof(MeshMetrics)) return false;
+
+    const size_t stride = sizeof(uint64_t) + sizeof(MeshMetrics);
+
+    for (size_t offset = header_size; offset + stride <= file.size(); offset += stride)
+    {
+        uint64_t key;
+        memcpy(&key, file.data() + offset, sizeof(key));
+        memcpy(&metrics[key], file.data() + offset + sizeof(key), sizeof(MeshMetrics));
+    }
+
+    return true;
+}
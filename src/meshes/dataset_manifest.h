@@ -0,0 +1,79 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef DATASET_MANIFEST_H
+#define DATASET_MANIFEST_H
+
+#include "mesh_metrics.h"
+#include "polygon_mesh_io.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Text manifest of a saved dataset: one tab separated line per mesh, in
+// dataset order, so that a dataset is reopened without listing the folder
+// or parsing its meshes. Lines starting with '#' are comments.
+//
+//   filename  class_id  t  num_verts  num_polys  content_hash  metrics_key
+
+typedef struct
+{
+    std::string filename;       // relative to the manifest folder
+    uint        class_id;
+    double      t;
+    uint        num_verts;
+    uint        num_polys;
+    uint64_t    content_hash;
+    uint64_t    metrics_key;
+}
+ManifestEntry;
+
+// FNV-1a hash of a byte range, chained through h
+uint64_t hash_bytes (const void *data, const size_t size, const uint64_t h = 14695981039346656037ull);
+
+// FNV-1a hash of coordinates and connectivity
+uint64_t mesh_content_hash (const FlatPolygonMesh &m);
+
+// metrics computed on a mesh are reusable as long as both the mesh and
+// the MeshMetrics layout are unchanged
+uint64_t metrics_cache_key (const uint64_t content_hash);
+
+bool write_dataset_manifest (const std::string &filename, const std::vector<ManifestEntry> &entries);
+bool read_dataset_manifest  (const std::string &filename, std::vector<ManifestEntry> &entries);
+
+// binary cache of MeshMetrics records, each one stored with its key
+bool write_metrics_cache (const std::string &filename, const std::vector<uint64_t> &keys, const std::vector<MeshMetrics> &metrics);
+bool read_metrics_cache  (const std::string &filename, std::unordered_map<uint64_t, MeshMetrics> &metrics);
+
+#endif // DATASET_MANIFEST_H
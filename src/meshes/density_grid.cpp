@@ -0,0 +1,124 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "density_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void compute_density_grid (const std::vector<float> &x,
+                           const std::vector<float> &y,
+                           const uint                nx,
+                           const uint                ny,
+                           DensityGrid              &grid)
+{
+    grid = DensityGrid();
+    grid.nx = nx;
+    grid.ny = ny;
+    grid.counts.assign(static_cast<size_t>(nx) * ny, 0);
+
+    const long n = static_cast<long>(std::min(x.size(), y.size()));
+
+    double x_min =  std::numeric_limits<double>::max();
+    double x_max = -std::numeric_limits<double>::max();
+    double y_min =  std::numeric_limits<double>::max();
+    double y_max = -std::numeric_limits<double>::max();
+
+    #pragma omp parallel for reduction(min:x_min,y_min) reduction(max:x_max,y_max)
+    for (long k=0; k < n; k++)
+    {
+        if (!std::isfinite(x.at(k)) || !std::isfinite(y.at(k))) continue;
+
+        x_min = std::min(x_min, static_cast<double>(x.at(k)));
+        x_max = std::max(x_max, static_cast<double>(x.at(k)));
+        y_min = std::min(y_min, static_cast<double>(y.at(k)));
+        y_max = std::max(y_max, static_cast<double>(y.at(k)));
+    }
+
+    if (nx == 0 || ny == 0 || x_min > x_max || y_min > y_max) return;
+
+    // degenerate ranges get a unit width, centered on the data
+    if (x_max == x_min) { x_min -= 0.5; x_max += 0.5; }
+    if (y_max == y_min) { y_min -= 0.5; y_max += 0.5; }
+
+    grid.x_min = x_min;
+    grid.x_max = x_max;
+    grid.y_min = y_min;
+    grid.y_max = y_max;
+
+    const double sx = nx / (x_max - x_min);
+    const double sy = ny / (y_max - y_min);
+
+    size_t n_points = 0;
+
+    // each thread fills its own histogram, integer sums make the merge exact
+    #pragma omp parallel reduction(+:n_points)
+    {
+        std::vector<uint> counts (grid.counts.size(), 0);
+
+        #pragma omp for nowait
+        for (long k=0; k < n; k++)
+        {
+            if (!std::isfinite(x.at(k)) || !std::isfinite(y.at(k))) continue;
+
+            const uint i = std::min(nx-1, static_cast<uint>((x.at(k) - x_min) * sx));
+            const uint j = std::min(ny-1, static_cast<uint>((y.at(k) - y_min) * sy));
+
+            counts.at(static_cast<size_t>(j) * nx + i)++;
+            n_points++;
+        }
+
+        #pragma omp critical
+        {
+            for (size_t b=0; b < counts.size(); b++)
+                grid.counts.at(b) += counts.at(b);
+        }
+    }
+
+    grid.n_points  = n_points;
+    grid.max_count = *std::max_element(grid.counts.begin(), grid.counts.end());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+double density_grid_x (const DensityGrid &grid, const uint i)
+{
+    return grid.x_min + (i + 0.5) * (grid.x_max - grid.x_min) / grid.nx;
+}
+
+double density_grid_y (const DensityGrid &grid, const uint j)
+{
+    return grid.y_min + (j + 0.5) * (grid.y_max - grid.y_min) / grid.ny;
+}
@@ -0,0 +1,70 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef DENSITY_GRID_H
+#define DENSITY_GRID_H
+
+#include <sys/types.h>
+
+#include <vector>
+
+// 2D histogram of a point cloud, to draw scatter plots with too many points
+// for one marker each (e.g. one point per polygon of a whole dataset).
+// Points with a non finite coordinate are skipped.
+
+typedef struct
+{
+    uint   nx = 0;
+    uint   ny = 0;
+    double x_min = 0.0;
+    double x_max = 0.0;
+    double y_min = 0.0;
+    double y_max = 0.0;
+
+    std::vector<uint> counts;       // nx * ny, bin (i,j) at j*nx + i
+    uint   max_count = 0;
+    size_t n_points  = 0;           // binned points
+}
+DensityGrid;
+
+// Bounds and counts are computed in parallel (OpenMP), counts are exact
+void compute_density_grid (const std::vector<float> &x,
+                           const std::vector<float> &y,
+                           const uint                nx,
+                           const uint                ny,
+                           DensityGrid              &grid);
+
+// center of bin (i,j)
+double density_grid_x (const DensityGrid &grid, const uint i);
+double density_grid_y (const DensityGrid &grid, const uint j);
+
+#endif // DENSITY_GRID_H
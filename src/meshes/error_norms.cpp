@@ -0,0 +1,253 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "error_norms.h"
+#include "vem_poisson_solver.h"
+
+#include <algorithm>
+#include <cmath>
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+// the energy norm of u_I is round-off (u constant) when its square is below
+// this fraction of sum_i K_ii u_i^2, and errS is then reported as absolute
+const double VANISHING_ENERGY = 1e-12;
+
+inline double relative (const double err, const double norm)
+{
+    return (norm > 0.0) ? err / norm : err;
+}
+
+// contributions of polygon pid: squared energy error, squared energy norm,
+// squared L2 error, squared L2 norm, sum_i K_ii u_i^2, diameter
+void poly_error_terms (const cinolib::Polygonmesh<> &m,
+                       const uint                    pid,
+                       const std::vector<double>    &solution,
+                       const std::vector<double>    &ground_truth,
+                       const ExactSolution          &exact,
+                       double                       *terms)
+{
+    const std::vector<uint> &vids = m.poly_verts_id(pid);
+    const uint n = static_cast<uint>(vids.size());
+
+    VEMLocalMatrices local;
+    vem_local_matrices(m, pid, local);
+
+    Eigen::VectorXd uh (n), uI (n);
+    for (uint i=0; i < n; i++)
+    {
+        uh(i) = solution.at(vids.at(i));
+        uI(i) = ground_truth.at(vids.at(i));
+    }
+
+    const Eigen::VectorXd e = uh - uI;
+    terms[0] = e.dot(local.K * e);
+    terms[1] = uI.dot(local.K * uI);
+    terms[4] = uI.dot(local.K.diagonal().asDiagonal() * uI);
+    terms[5] = local.diameter;
+
+    // L2 norms with a fan of triangles from the centroid and the edge
+    // midpoint rule (exact for the quadratic |Pi(u_h)|^2)
+    const Eigen::Vector3d c_h = local.Pi_star * uh;
+    const Eigen::Vector3d c_I = local.Pi_star * uI;
+    const double h = local.diameter;
+
+    // triangle areas are signed, so that the fan also covers polygons
+    // that are not star-shaped with respect to the centroid
+    std::vector<double> tri_areas (n);
+    double signed_area = 0.0;
+
+    for (uint i=0; i < n; i++)
+    {
+        const cinolib::vec3d &a = m.vert(vids.at(i));
+        const cinolib::vec3d &b = m.vert(vids.at((i+1)%n));
+
+        tri_areas.at(i) = 0.5 * ((a.x()-local.xE)*(b.y()-local.yE) - (b.x()-local.xE)*(a.y()-local.yE));
+        signed_area += tri_areas.at(i);
+    }
+
+    const double sign = (signed_area < 0.0) ? -1.0 : 1.0;
+
+    double e_L2 = 0.0, u_L2 = 0.0;
+
+    for (uint i=0; i < n; i++)
+    {
+        const cinolib::vec3d &a = m.vert(vids.at(i));
+        const cinolib::vec3d &b = m.vert(vids.at((i+1)%n));
+
+        const double w = sign * tri_areas.at(i) / 3.0;
+
+        const double qx[3] = { 0.5*(local.xE + a.x()), 0.5*(a.x() + b.x()), 0.5*(b.x() + local.xE) };
+        const double qy[3] = { 0.5*(local.yE + a.y()), 0.5*(a.y() + b.y()), 0.5*(b.y() + local.yE) };
+
+        for (uint k=0; k < 3; k++)
+        {
+            const double sx = (qx[k]-local.xE)/h;
+            const double sy = (qy[k]-local.yE)/h;
+
+            const double pi_uh = c_h(0) + c_h(1)*sx + c_h(2)*sy;
+            const double u     = exact ? exact(qx[k], qy[k]) : c_I(0) + c_I(1)*sx + c_I(2)*sy;
+
+            e_L2 += w * (pi_uh - u) * (pi_uh - u);
+            u_L2 += w * u * u;
+        }
+    }
+
+    terms[2] = e_L2;
+    terms[3] = u_L2;
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool compute_error_norms (const cinolib::Polygonmesh<> &m,
+                          const std::vector<double>    &solution,
+                          const std::vector<double>    &ground_truth,
+                          const ExactSolution          &exact,
+                          ErrorNorms                   &errs)
+{
+    const uint nv = m.num_verts();
+    const uint np = m.num_polys();
+
+    errs = ErrorNorms();
+
+    if (solution.size() != nv || ground_truth.size() != nv) return false;
+
+    std::vector<double> poly_errs (6*np, 0.0);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int p=0; p < static_cast<int>(np); p++)
+    {
+        poly_error_terms(m, static_cast<uint>(p), solution, ground_truth, exact, &poly_errs.at(6*p));
+    }
+
+    double err_S = 0.0, norm_S = 0.0, err_L2 = 0.0, norm_L2 = 0.0, ref_S = 0.0;
+
+    for (uint pid=0; pid < np; pid++)
+    {
+        err_S   += poly_errs.at(6*pid  );
+        norm_S  += poly_errs.at(6*pid+1);
+        err_L2  += poly_errs.at(6*pid+2);
+        norm_L2 += poly_errs.at(6*pid+3);
+        ref_S   += poly_errs.at(6*pid+4);
+
+        errs.hEmax = std::max(errs.hEmax, poly_errs.at(6*pid+5));
+    }
+
+    if (norm_S <= VANISHING_ENERGY * ref_S) norm_S = 0.0;
+
+    double err_inf = 0.0, norm_inf = 0.0;
+
+    for (uint vid=0; vid < nv; vid++)
+    {
+        err_inf  = std::max(err_inf,  std::fabs(solution.at(vid) - ground_truth.at(vid)));
+        norm_inf = std::max(norm_inf, std::fabs(ground_truth.at(vid)));
+    }
+
+    errs.errS   = relative(std::sqrt(std::max(err_S, 0.0)), std::sqrt(std::max(norm_S, 0.0)));
+    errs.errInf = relative(err_inf, norm_inf);
+    errs.errL2  = relative(std::sqrt(std::max(err_L2, 0.0)), std::sqrt(std::max(norm_L2, 0.0)));
+
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool compute_local_errors (const cinolib::Polygonmesh<> &m,
+                           const std::vector<double>    &solution,
+                           const std::vector<double>    &ground_truth,
+                           const ExactSolution          &exact,
+                           std::vector<double>          &errS,
+                           std::vector<double>          &errInf,
+                           std::vector<double>          &errL2)
+{
+    const uint nv = m.num_verts();
+    const uint np = m.num_polys();
+
+    errS.assign(np, 0.0);
+    errInf.assign(np, 0.0);
+    errL2.assign(np, 0.0);
+
+    if (solution.size() != nv || ground_truth.size() != nv) return false;
+
+    std::vector<double> poly_errs (6*np, 0.0);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int p=0; p < static_cast<int>(np); p++)
+    {
+        const uint pid = static_cast<uint>(p);
+
+        double *terms = &poly_errs.at(6*pid);
+        poly_error_terms(m, pid, solution, ground_truth, exact, terms);
+
+        double err_inf = 0.0;
+        for (uint vid : m.poly_verts_id(pid))
+            err_inf = std::max(err_inf, std::fabs(solution.at(vid) - ground_truth.at(vid)));
+
+        errS.at(pid)   = std::sqrt(std::max(terms[0], 0.0));
+        errInf.at(pid) = err_inf;
+        errL2.at(pid)  = std::sqrt(std::max(terms[2], 0.0));
+    }
+
+    // the norms of the reference solution of compute_error_norms, summed in
+    // the same order, so that the local errors are relative to them too
+    double norm_S = 0.0, norm_L2 = 0.0, ref_S = 0.0;
+
+    for (uint pid=0; pid < np; pid++)
+    {
+        norm_S  += poly_errs.at(6*pid+1);
+        norm_L2 += poly_errs.at(6*pid+3);
+        ref_S   += poly_errs.at(6*pid+4);
+    }
+
+    if (norm_S <= VANISHING_ENERGY * ref_S) norm_S = 0.0;
+
+    double norm_inf = 0.0;
+    for (uint vid=0; vid < nv; vid++)
+        norm_inf = std::max(norm_inf, std::fabs(ground_truth.at(vid)));
+
+    norm_S  = std::sqrt(std::max(norm_S, 0.0));
+    norm_L2 = std::sqrt(std::max(norm_L2, 0.0));
+
+    for (uint pid=0; pid < np; pid++)
+    {
+        errS.at(pid)   = relative(errS.at(pid),   norm_S);
+        errInf.at(pid) = relative(errInf.at(pid), norm_inf);
+        errL2.at(pid)  = relative(errL2.at(pid),  norm_L2);
+    }
+
+    return true;
+}
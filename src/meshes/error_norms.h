@@ -0,0 +1,87 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef ERROR_NORMS_H
+#define ERROR_NORMS_H
+
+#include <cinolib/meshes/meshes.h>
+
+#include <functional>
+#include <vector>
+
+// Errors of a lowest order (k=1) VEM solution, given at the vertices, with
+// respect to a reference solution. The reference is the ground truth at the
+// vertices and, when available, the analytical solution, which is used for
+// the L2 error. Polygons are processed in parallel (OpenMP) and their
+// contributions summed in polygon order, so results do not depend on the
+// number of threads.
+
+typedef std::function<double(const double x, const double y)> ExactSolution;
+
+typedef struct
+{
+    // the first four columns of the results table. Errors are relative,
+    // unless the norm of the reference solution vanishes:
+    // errS   - energy norm of u_h - u_I, with the local stiffness matrices
+    // errInf - max norm of u_h - u_I at the vertices
+    // errL2  - L2 norm of Pi(u_h) - u, with the elementwise projection Pi,
+    //          or of Pi(u_h - u_I) without an analytical solution
+    // hEmax  - max polygon diameter
+    double errS   = 0.0;
+    double errInf = 0.0;
+    double errL2  = 0.0;
+    double hEmax  = 0.0;
+}
+ErrorNorms;
+
+// returns false if the fields do not have one value per vertex
+bool compute_error_norms (const cinolib::Polygonmesh<> &m,
+                          const std::vector<double>    &solution,
+                          const std::vector<double>    &ground_truth,
+                          const ExactSolution          &exact,
+                          ErrorNorms                   &errs);
+
+// Local error indicators, one value per polygon: energy norm of u_h - u_I,
+// max of |u_h - u_I| at the vertices and L2 error, restricted to each
+// polygon and divided by the same (global) norms of the reference solution
+// as the errors of compute_error_norms. The squares of the local errS and
+// errL2 sum up to the squared global ones, and the max of the local errInf
+// is the global one, given the same exact solution (or none).
+bool compute_local_errors (const cinolib::Polygonmesh<> &m,
+                           const std::vector<double>    &solution,
+                           const std::vector<double>    &ground_truth,
+                           const ExactSolution          &exact,
+                           std::vector<double>          &errS,
+                           std::vector<double>          &errInf,
+                           std::vector<double>          &errL2);
+
+#endif // ERROR_NORMS_H
@@ -0,0 +1,119 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool MappedFile::open(const std::string &filename)
+{
+    close();
+
+#ifdef _WIN32
+    std::ifstream in (filename, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) return false;
+
+    buffer.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!in) { buffer.clear(); return false; }
+
+    ptr    = buffer.data();
+    length = buffer.size();
+    return true;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    length = static_cast<size_t>(st.st_size);
+
+    if (length > 0)
+    {
+        void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (addr == MAP_FAILED)
+        {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+
+        madvise(addr, length, MADV_SEQUENTIAL);
+
+        ptr    = static_cast<const char *>(addr);
+        mapped = true;
+    }
+
+    // the mapping stays valid after closing the descriptor
+    ::close(fd);
+    return true;
+#endif
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    buffer.clear();
+    buffer.shrink_to_fit();
+#else
+    if (mapped) munmap(const_cast<char *>(ptr), length);
+    mapped = false;
+#endif
+
+    ptr    = nullptr;
+    length = 0;
+}
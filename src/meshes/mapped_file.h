@@ -0,0 +1,69 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. On POSIX systems the file is memory
+// mapped, elsewhere it is read into a buffer.
+class MappedFile
+{
+    public:
+
+        MappedFile() {}
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile & operator= (const MappedFile &) = delete;
+
+        bool open  (const std::string &filename);
+        void close ();
+
+        const char * data () const { return ptr; }
+        size_t       size () const { return length; }
+
+    private:
+
+        const char * ptr    = nullptr;
+        size_t       length = 0;
+
+#ifdef _WIN32
+        std::vector<char> buffer;
+#else
+        bool mapped = false;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -31,6 +31,7 @@
 *********************************************************************************/
 
 #include "mesh_metrics.h"
+#include "vem_poisson_solver.h"
 
 #include <cinolib/polygon_kernel.h>
 #include <cinolib/polygon_maximum_inscribed_circle.h>
@@ -241,10 +242,154 @@ void save_to_file(const char *filename, const MeshMetrics & metrics)
         fprintf(f, "VEMA_poly_min %f %d\n", metrics.VEMA_poly_min, metrics.VEMA_poly_min_id);
         fprintf(f, "VEMA_poly_max %f %d\n", metrics.VEMA_poly_max, metrics.VEMA_poly_max_id);
         fprintf(f, "VEMA_poly_avg %f\n"   , metrics.VEMA_poly_avg);
+        fprintf(f, "VPC_min %f %d\n", metrics.VPC_min, metrics.VPC_min_id);
+        fprintf(f, "VPC_max %f %d\n", metrics.VPC_max, metrics.VPC_max_id);
+        fprintf(f, "VPC_avg %f\n"   , metrics.VPC_avg);
+        fprintf(f, "VPC_poly_min %f %d\n", metrics.VPC_poly_min, metrics.VPC_poly_min_id);
+        fprintf(f, "VPC_poly_max %f %d\n", metrics.VPC_poly_max, metrics.VPC_poly_max_id);
+        fprintf(f, "VPC_poly_avg %f\n"   , metrics.VPC_poly_avg);
+        fprintf(f, "VPC_B_max %f\n"   , metrics.VPC_B_max);
+        fprintf(f, "VPC_D_max %f\n"   , metrics.VPC_D_max);
+        fprintf(f, "VSC_min %f %d\n", metrics.VSC_min, metrics.VSC_min_id);
+        fprintf(f, "VSC_max %f %d\n", metrics.VSC_max, metrics.VSC_max_id);
+        fprintf(f, "VSC_avg %f\n"   , metrics.VSC_avg);
+        fprintf(f, "VSC_poly_min %f %d\n", metrics.VSC_poly_min, metrics.VSC_poly_min_id);
+        fprintf(f, "VSC_poly_max %f %d\n", metrics.VSC_poly_max, metrics.VSC_poly_max_id);
+        fprintf(f, "VSC_poly_avg %f\n"   , metrics.VSC_poly_avg);
         fclose(f);
     }
 }
 
+void compute_poly_metrics(const Polygonmesh<> &m, const uint pid, PolyMetrics &pm)
+{
+    std::vector<vec3d> points = m.poly_verts(pid);
+    pm.is_triangle = (points.size() == 3);
+
+    vec3d  dummy;
+    double ic, cc;
+    polygon_maximum_inscribed_circle(points, dummy, ic);
+    smallest_enclosing_disk(points, dummy, cc);
+
+    pm.IC = ic;
+    pm.CC = cc;
+    pm.CR = ic/cc;
+
+    std::vector<double> a;
+    for(uint vid : m.adj_p2v(pid)) a.push_back(m.poly_angle_at_vert(pid, vid, DEG));
+    pm.MA  = *std::min_element(a.begin(), a.end());
+    pm.MXA = *std::max_element(a.begin(), a.end());
+
+    std::vector<double> e;
+    for(uint eid : m.adj_p2e(pid)) {e.push_back(m.edge_length(eid)); }
+    double min_e = *std::min_element(e.begin(), e.end());
+    double max_e = *std::max_element(e.begin(), e.end());
+
+    pm.SE  = min_e;
+    pm.ER  = min_e/max_e;
+    pm.MDR = min_e/ic;
+
+    std::vector<vec3d> dummy2;
+    double perim  = std::accumulate(e.begin(), e.end(), 0.0);
+    double area   = m.poly_area(pid);
+    double kernel = polygon_kernel(points, dummy2);
+
+    double radius = 0.0;
+    vec3d center;
+
+    if (dummy2.size() > 0)
+        polygon_maximum_inscribed_circle(dummy2, center, radius);
+
+    pm.AR  = area;
+    pm.APR = area/(perim*perim);
+    pm.KE  = kernel;
+    pm.KAR = (area>0) ? kernel/area : 0.0;
+    pm.SR  = (radius > 0.0) ? cc/radius : DBL_MAX;
+
+    double d = inf_double, he = -inf_double;
+    for(uint i=0;   i<points.size()-1; ++i)
+        for(uint j=i+1; j<points.size();   ++j)
+        {
+            d = std::min(d, points.at(i).dist(points.at(j)));
+            he = std::max(he, points.at(i).dist(points.at(j)));
+        }
+    double rho = he / std::min(sqrt(area), min_e);
+
+    pm.MPD  = d;
+    pm.NS   = static_cast<uint>(m.adj_p2e(pid).size());
+    pm.VEM  = rho;
+    pm.VEMA = rho * rho * area;
+
+    VEMLocalMatrices local;
+    vem_local_matrices(m, pid, local);
+    vem_local_condition_numbers(local, pm.VPC, pm.VPC_B, pm.VPC_D, pm.VSC);
+}
+
+double poly_metric_value(const PolyMetrics &pm, const uint metric_id)
+{
+    switch (metric_id)
+    {
+        case 0: return pm.IC;
+        case 1: return pm.CC;
+        case 2: return pm.CR;
+        case 3: return pm.AR;
+        case 4: return pm.KE;
+        case 5: return pm.KAR;
+        case 6: return pm.APR;
+        case 7: return pm.MA;
+        case 8: return pm.SE;
+        case 9: return pm.ER;
+        case 10: return pm.MPD;
+        case 11: return pm.NS;
+        case 12: return pm.MXA;
+        case 13: return pm.SR;
+        case 14: return pm.VEM;
+        case 15: return pm.VEMA;
+        case 16: return pm.VPC;
+        case 17: return pm.VSC;
+    }
+
+    return DBL_MAX;
+}
+
+// worst value between the triangles and the other polygons of a mesh,
+// or the only one of the two that exists
+static double worst_value(const double tri,  const uint tri_id,
+                          const double poly, const uint poly_id,
+                          const bool   take_max)
+{
+    if (tri_id  == UINT_MAX) return poly;
+    if (poly_id == UINT_MAX) return tri;
+
+    return take_max ? std::max(tri, poly) : std::min(tri, poly);
+}
+
+double mesh_metric_value(const MeshMetrics &mm, const uint metric_id)
+{
+    switch (metric_id)
+    {
+        case 0: return worst_value(mm.IC_min, mm.IC_min_id, mm.IC_poly_min, mm.IC_poly_min_id, false);
+        case 1: return worst_value(mm.CC_min, mm.CC_min_id, mm.CC_poly_min, mm.CC_poly_min_id, false);
+        case 2: return worst_value(mm.CR_min, mm.CR_min_id, mm.CR_poly_min, mm.CR_poly_min_id, false);
+        case 3: return worst_value(mm.AR_min, mm.AR_min_id, mm.AR_poly_min, mm.AR_poly_min_id, false);
+        case 4: return worst_value(mm.KE_min, mm.KE_min_id, mm.KE_poly_min, mm.KE_poly_min_id, false);
+        case 5: return worst_value(mm.KAR_min, mm.KAR_min_id, mm.KAR_poly_min, mm.KAR_poly_min_id, false);
+        case 6: return worst_value(mm.APR_min, mm.APR_min_id, mm.APR_poly_min, mm.APR_poly_min_id, false);
+        case 7: return worst_value(mm.MA_min, mm.MA_min_id, mm.MA_poly_min, mm.MA_poly_min_id, false);
+        case 8: return worst_value(mm.SE_min, mm.SE_min_id, mm.SE_poly_min, mm.SE_poly_min_id, false);
+        case 9: return worst_value(mm.ER_min, mm.ER_min_id, mm.ER_poly_min, mm.ER_poly_min_id, false);
+        case 10: return worst_value(mm.MPD_min, mm.MPD_min_id, mm.MPD_poly_min, mm.MPD_poly_min_id, false);
+        case 11: return worst_value(mm.NS_min, mm.NS_min_id, mm.NS_poly_min, mm.NS_poly_min_id, false);
+        case 12: return worst_value(mm.MXA_min, mm.MXA_min_id, mm.MXA_poly_min, mm.MXA_poly_min_id, false);
+        case 13: return worst_value(mm.SR_min, mm.SR_min_id, mm.SR_poly_min, mm.SR_poly_min_id, false);
+        case 14: return worst_value(mm.VEM_max, mm.VEM_max_id, mm.VEM_poly_max, mm.VEM_poly_max_id, true);
+        case 15: return std::sqrt(mm.VEMA_sum + mm.VEMA_poly_sum);
+        case 16: return worst_value(mm.VPC_max, mm.VPC_max_id, mm.VPC_poly_max, mm.VPC_poly_max_id, true);
+        case 17: return worst_value(mm.VSC_max, mm.VSC_max_id, mm.VSC_poly_max, mm.VSC_poly_max_id, true);
+    }
+
+    return DBL_MAX;
+}
+
 void compute_mesh_metrics(const Polygonmesh<> &m, MeshMetrics &metrics)
 {
     // convenient compact representations for each item
@@ -265,6 +410,8 @@ void compute_mesh_metrics(const Polygonmesh<> &m, MeshMetrics &metrics)
     std::vector<std::pair<double,uint>> SR;
     std::vector<std::pair<double,uint>> VEM;
     std::vector<std::pair<double,uint>> VEMA;
+    std::vector<std::pair<double,uint>> VPC;
+    std::vector<std::pair<double,uint>> VSC;
 
     std::vector<std::pair<double,uint>> IC_poly;
     std::vector<std::pair<double,uint>> CC_poly;
@@ -283,137 +430,69 @@ void compute_mesh_metrics(const Polygonmesh<> &m, MeshMetrics &metrics)
     std::vector<std::pair<double,uint>> SR_poly;
     std::vector<std::pair<double,uint>> VEM_poly;
     std::vector<std::pair<double,uint>> VEMA_poly;
+    std::vector<std::pair<double,uint>> VPC_poly;
+    std::vector<std::pair<double,uint>> VSC_poly;
 
-    for(uint pid=0; pid<m.num_polys(); ++pid)
-    {
-        //std::cout << "[pid " << pid << "] " << std::endl;
-
-        std::vector<vec3d> points = m.poly_verts(pid);
-        bool is_triangle = (points.size() == 3);
-
-        vec3d  dummy;
-        double ic, cc;
-        polygon_maximum_inscribed_circle(points, dummy, ic);
-        //std::cout << "[polygon_maximum_inscribed_circle] " << ic << std::endl;
-
-        smallest_enclosing_disk(points, dummy, cc);
-        //std::cout << "[smallest_enclosing_disk] " << cc << std::endl;
-
-        if (is_triangle)
-        {
-            IC.push_back(std::make_pair(ic,pid));
-            CC.push_back(std::make_pair(cc,pid));
-            CR.push_back(std::make_pair(ic/cc,pid));
-        }
-        else
-        {
-            IC_poly.push_back(std::make_pair(ic,pid));
-            CC_poly.push_back(std::make_pair(cc,pid));
-            CR_poly.push_back(std::make_pair(ic/cc,pid));
-        }
-
-        std::vector<double> a;
-        for(uint vid : m.adj_p2v(pid)) a.push_back(m.poly_angle_at_vert(pid, vid, DEG));
-        double min_a = *std::min_element(a.begin(), a.end());
-        double max_a = *std::max_element(a.begin(), a.end());
-
-        //std::cout << "[min/max angle] " << min_a << " - " << max_a << std::endl;
-
-        if (is_triangle)
-        {
-            MA.push_back(std::make_pair(min_a,pid));
-            MXA.push_back(std::make_pair(max_a,pid));
-        }
-        else
-        {
-            MA_poly.push_back(std::make_pair(min_a,pid));
-            MXA_poly.push_back(std::make_pair(max_a,pid));
-
-            for (double d : a) std::cout << d << std::endl;
-            std::cout << "===============" << std::endl;
-        }
-
-
-        std::vector<double> e;
-        for(uint eid : m.adj_p2e(pid)) {e.push_back(m.edge_length(eid)); }
-        double min_e = *std::min_element(e.begin(), e.end());
-        double max_e = *std::max_element(e.begin(), e.end());
-
-//        std::cout << "[min_max edge] " << min_e << " - " << max_e << std::endl;
-
-        if (is_triangle)
-        {
-            SE.push_back(std::make_pair(min_e,pid));
-            ER.push_back(std::make_pair(min_e/max_e,pid));
-            MDR.push_back(std::make_pair(min_e/ic,pid));
-        }
-        else
-        {
-            SE_poly.push_back(std::make_pair(min_e,pid));
-            ER_poly.push_back(std::make_pair(min_e/max_e,pid));
-            MDR_poly.push_back(std::make_pair(min_e/ic,pid));
-        }
-
-        std::vector<vec3d> dummy2;
-        double perim  = std::accumulate(e.begin(), e.end(), 0.0);
-        double area   = m.poly_area(pid);
-        double kernel = polygon_kernel(points, dummy2);
-
-        double radius = 0.0;
-        vec3d center;
-
-        if (dummy2.size() > 0)
-            polygon_maximum_inscribed_circle(dummy2, center, radius);
-
-        double shape_regularity = (radius > 0.0) ? cc/radius : DBL_MAX;
+    // polygons are independent: their metrics are computed in parallel, and
+    // collected in polygon order
+    std::vector<PolyMetrics> poly_metrics(m.num_polys());
 
-        //std::cout << "[perim area kernel] " << perim << " - " << area << " - " << kernel << std::endl;
-
-        if (is_triangle)
-        {
-            AR.push_back(std::make_pair(area,pid));
-            APR.push_back(std::make_pair(area/(perim*perim),pid));
-            KE.push_back(std::make_pair(kernel,pid));
-            if(area>0) KAR.push_back(std::make_pair(kernel/area,pid));
-
-            SR.push_back(std::make_pair(shape_regularity, pid));
-        }
-        else
-        {
-            AR_poly.push_back(std::make_pair(area,pid));
-            APR_poly.push_back(std::make_pair(area/(perim*perim),pid));
-            KE_poly.push_back(std::make_pair(kernel,pid));
-            if(area>0) KAR_poly.push_back(std::make_pair(kernel/area,pid));
-
-            SR_poly.push_back(std::make_pair(shape_regularity, pid));
-        }
+    #pragma omp parallel for schedule(dynamic, 256)
+    for(int pid=0; pid<static_cast<int>(m.num_polys()); ++pid)
+    {
+        compute_poly_metrics(m, static_cast<uint>(pid), poly_metrics.at(pid));
+    }
 
-        double d = inf_double, he = -inf_double;
-        for(uint i=0;   i<points.size()-1; ++i)
-            for(uint j=i+1; j<points.size();   ++j)
-            {
-                d = std::min(d, points.at(i).dist(points.at(j)));
-                he = std::max(he, points.at(i).dist(points.at(j)));
-            }
-        double rho = he / std::min(sqrt(area), min_e);
-//        double angle = std::min(min_a, 1/max_a);
-        double rho_a = rho * rho * area;
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    {
+        const PolyMetrics &pm = poly_metrics.at(pid);
 
-    //    std::cout << "[ro] " << ro << std::endl;
+        metrics.VPC_B_max = std::max(metrics.VPC_B_max, pm.VPC_B);
+        metrics.VPC_D_max = std::max(metrics.VPC_D_max, pm.VPC_D);
 
-        if (is_triangle)
+        if (pm.is_triangle)
         {
-            MPD.push_back(std::make_pair(d,pid));
-            NS.push_back(std::make_pair(m.adj_p2e(pid).size(),pid));
-            VEM.push_back(std::make_pair(rho, pid));
-            VEMA.push_back(std::make_pair(rho_a, pid));
+            IC.push_back(std::make_pair(pm.IC,pid));
+            CC.push_back(std::make_pair(pm.CC,pid));
+            CR.push_back(std::make_pair(pm.CR,pid));
+            MA.push_back(std::make_pair(pm.MA,pid));
+            MXA.push_back(std::make_pair(pm.MXA,pid));
+            SE.push_back(std::make_pair(pm.SE,pid));
+            ER.push_back(std::make_pair(pm.ER,pid));
+            MDR.push_back(std::make_pair(pm.MDR,pid));
+            AR.push_back(std::make_pair(pm.AR,pid));
+            APR.push_back(std::make_pair(pm.APR,pid));
+            KE.push_back(std::make_pair(pm.KE,pid));
+            if(pm.AR>0) KAR.push_back(std::make_pair(pm.KAR,pid));
+            SR.push_back(std::make_pair(pm.SR, pid));
+            MPD.push_back(std::make_pair(pm.MPD,pid));
+            NS.push_back(std::make_pair(pm.NS,pid));
+            VEM.push_back(std::make_pair(pm.VEM, pid));
+            VEMA.push_back(std::make_pair(pm.VEMA, pid));
+            VPC.push_back(std::make_pair(pm.VPC, pid));
+            VSC.push_back(std::make_pair(pm.VSC, pid));
         }
         else
         {
-            MPD_poly.push_back(std::make_pair(d,pid));
-            NS_poly.push_back(std::make_pair(m.adj_p2e(pid).size(),pid));
-            VEM_poly.push_back(std::make_pair(rho, pid));
-            VEMA_poly.push_back(std::make_pair(rho_a, pid));
+            IC_poly.push_back(std::make_pair(pm.IC,pid));
+            CC_poly.push_back(std::make_pair(pm.CC,pid));
+            CR_poly.push_back(std::make_pair(pm.CR,pid));
+            MA_poly.push_back(std::make_pair(pm.MA,pid));
+            MXA_poly.push_back(std::make_pair(pm.MXA,pid));
+            SE_poly.push_back(std::make_pair(pm.SE,pid));
+            ER_poly.push_back(std::make_pair(pm.ER,pid));
+            MDR_poly.push_back(std::make_pair(pm.MDR,pid));
+            AR_poly.push_back(std::make_pair(pm.AR,pid));
+            APR_poly.push_back(std::make_pair(pm.APR,pid));
+            KE_poly.push_back(std::make_pair(pm.KE,pid));
+            if(pm.AR>0) KAR_poly.push_back(std::make_pair(pm.KAR,pid));
+            SR_poly.push_back(std::make_pair(pm.SR, pid));
+            MPD_poly.push_back(std::make_pair(pm.MPD,pid));
+            NS_poly.push_back(std::make_pair(pm.NS,pid));
+            VEM_poly.push_back(std::make_pair(pm.VEM, pid));
+            VEMA_poly.push_back(std::make_pair(pm.VEMA, pid));
+            VPC_poly.push_back(std::make_pair(pm.VPC, pid));
+            VSC_poly.push_back(std::make_pair(pm.VSC, pid));
         }
     }
 
@@ -437,6 +516,8 @@ void compute_mesh_metrics(const Polygonmesh<> &m, MeshMetrics &metrics)
     get_min_max_avg(VEM, metrics.VEM_min, metrics.VEM_max, metrics.VEM_avg, metrics.VEM_min_id, metrics.VEM_max_id);
     get_min_max_avg(VEMA, metrics.VEMA_min, metrics.VEMA_max, metrics.VEMA_avg, metrics.VEMA_min_id, metrics.VEMA_max_id);
     get_sum(VEMA, metrics.VEMA_sum);
+    get_min_max_avg(VPC, metrics.VPC_min, metrics.VPC_max, metrics.VPC_avg, metrics.VPC_min_id, metrics.VPC_max_id);
+    get_min_max_avg(VSC, metrics.VSC_min, metrics.VSC_max, metrics.VSC_avg, metrics.VSC_min_id, metrics.VSC_max_id);
 
     get_min_max_avg(IC_poly,  metrics.IC_poly_min,  metrics.IC_poly_max,  metrics.IC_poly_avg,  metrics.IC_poly_min_id,  metrics.IC_poly_max_id );
     get_min_max_avg(CC_poly,  metrics.CC_poly_min,  metrics.CC_poly_max,  metrics.CC_poly_avg,  metrics.CC_poly_min_id,  metrics.CC_poly_max_id );
@@ -456,6 +537,8 @@ void compute_mesh_metrics(const Polygonmesh<> &m, MeshMetrics &metrics)
     get_min_max_avg(VEM_poly, metrics.VEM_poly_min, metrics.VEM_poly_max, metrics.VEM_poly_avg, metrics.VEM_poly_min_id, metrics.VEM_poly_max_id);
     get_min_max_avg(VEMA_poly, metrics.VEMA_poly_min, metrics.VEMA_poly_max, metrics.VEMA_poly_avg, metrics.VEMA_poly_min_id, metrics.VEMA_poly_max_id);
     get_sum(VEMA_poly, metrics.VEMA_poly_sum);
+    get_min_max_avg(VPC_poly, metrics.VPC_poly_min, metrics.VPC_poly_max, metrics.VPC_poly_avg, metrics.VPC_poly_min_id, metrics.VPC_poly_max_id);
+    get_min_max_avg(VSC_poly, metrics.VSC_poly_min, metrics.VSC_poly_max, metrics.VSC_poly_avg, metrics.VSC_poly_min_id, metrics.VSC_poly_max_id);
 
 
     get_global_avg_norm(IC, IC_poly, metrics.IC_global_avg, metrics.IC_global_norm);
@@ -473,4 +556,6 @@ void compute_mesh_metrics(const Polygonmesh<> &m, MeshMetrics &metrics)
     get_global_avg_norm(MDR, MDR_poly, metrics.MDR_global_avg, metrics.MDR_global_norm);
     get_global_avg_norm(NS, NS_poly, metrics.NS_global_avg, metrics.NS_global_norm);
     get_global_avg_norm(SR, SR_poly, metrics.SR_global_avg, metrics.SR_global_norm);
+    get_global_avg_norm(VPC, VPC_poly, metrics.VPC_global_avg, metrics.VPC_global_norm);
+    get_global_avg_norm(VSC, VSC_poly, metrics.VSC_global_avg, metrics.VSC_global_norm);
 }
@@ -280,6 +280,36 @@ typedef struct
     uint   VEMA_max_id    = UINT_MAX;
     uint   VEMA_poly_min_id = UINT_MAX;
     uint   VEMA_poly_max_id = UINT_MAX;
+
+    // VPC - VEM Projector Conditioning, cond(G) with G = BD - Range: [1,inf) - low is good - scale INdependent
+    double VPC_min       = 0.0;
+    double VPC_max       = 0.0;
+    double VPC_avg       = 0.0;
+    double VPC_poly_min  = 0.0;
+    double VPC_poly_max  = 0.0;
+    double VPC_poly_avg  = 0.0;
+    double VPC_global_avg   = 0.0;
+    double VPC_global_norm  = 0.0;
+    double VPC_B_max     = 0.0;     // max cond(B) over all the polygons
+    double VPC_D_max     = 0.0;     // max cond(D) over all the polygons
+    uint   VPC_min_id    = UINT_MAX;
+    uint   VPC_max_id    = UINT_MAX;
+    uint   VPC_poly_min_id = UINT_MAX;
+    uint   VPC_poly_max_id = UINT_MAX;
+
+    // VSC - VEM Stiffness Conditioning, k=1 local stiffness - Range: [1,inf) - low is good - scale INdependent
+    double VSC_min       = 0.0;
+    double VSC_max       = 0.0;
+    double VSC_avg       = 0.0;
+    double VSC_poly_min  = 0.0;
+    double VSC_poly_max  = 0.0;
+    double VSC_poly_avg  = 0.0;
+    double VSC_global_avg   = 0.0;
+    double VSC_global_norm  = 0.0;
+    uint   VSC_min_id    = UINT_MAX;
+    uint   VSC_max_id    = UINT_MAX;
+    uint   VSC_poly_min_id = UINT_MAX;
+    uint   VSC_poly_max_id = UINT_MAX;
 }
 MeshMetrics;
 
@@ -291,6 +321,44 @@ void get_min_max_avg(std::vector<std::pair<T,uint>> & list,
                      uint                           & min_id,
                      uint                           & max_id);
 
+// metrics of a single polygon, the values aggregated in MeshMetrics
+typedef struct
+{
+    bool   is_triangle = false;
+    double IC   = 0.0;
+    double CC   = 0.0;
+    double CR   = 0.0;
+    double AR   = 0.0;
+    double KE   = 0.0;
+    double KAR  = 0.0;
+    double APR  = 0.0;
+    double MA   = 0.0;
+    double SE   = 0.0;
+    double ER   = 0.0;
+    double MPD  = 0.0;
+    uint   NS   = 0;
+    double MXA  = 0.0;
+    double MDR  = 0.0;
+    double SR   = 0.0;
+    double VEM  = 0.0;
+    double VEMA = 0.0;
+    double VPC  = 0.0;
+    double VPC_B = 0.0;
+    double VPC_D = 0.0;
+    double VSC  = 0.0;
+}
+PolyMetrics;
+
+void compute_poly_metrics(const Polygonmesh<> &m, const uint pid, PolyMetrics &pm);
+
+// value of metric metric_id (the index in metrics_names) of a polygon
+double poly_metric_value(const PolyMetrics &pm, const uint metric_id);
+
+// value of metric metric_id of a whole mesh, as shown in the scatter plots:
+// the worst one between triangles and polygons (the square root of the sum
+// for VEMA)
+double mesh_metric_value(const MeshMetrics &mm, const uint metric_id);
+
 void save_to_file(const char *filename, const MeshMetrics & metrics);
 
 void compute_mesh_metrics(const Polygonmesh<> &m, MeshMetrics &metrics);
@@ -34,6 +34,11 @@
 #include "non_uniform_scaling_01.h"
 #include "cinolib/vertex_clustering.h"
 
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <iostream>
+
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 void translate(cinolib::Polygonmesh<> &tin, const cinolib::vec3d &t)
@@ -173,3 +178,224 @@ void apply_mirroring (cinolib::Polygonmesh<> &mesh)
 
     non_uniform_scaling(mesh);
 }
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+// matches the vertices of two opposite sides by their coordinate along the side
+void match_sides (const std::vector<std::pair<double,uint>> & side_a,
+                  const std::vector<std::pair<double,uint>> & side_b,
+                  const double                                tol,
+                  std::vector<uint>                         & a2b)
+{
+    uint j = 0;
+    for (const std::pair<double,uint> &a : side_a)
+    {
+        while (j < side_b.size() && side_b.at(j).first < a.first - tol) j++;
+
+        if (j < side_b.size() && std::fabs(side_b.at(j).first - a.first) <= tol)
+            a2b.at(a.second) = side_b.at(j).second;
+    }
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void tile_mesh (const cinolib::Polygonmesh<>     & tile,
+                const uint                         nx,
+                const uint                         ny,
+                const int                          mode,
+                std::vector<cinolib::vec3d>      & verts,
+                std::vector<std::vector<uint>>   & polys)
+{
+    verts.clear();
+    polys.clear();
+
+    const uint nv = tile.num_verts();
+    const uint np = tile.num_polys();
+
+    if (nv == 0 || nx == 0 || ny == 0) return;
+
+    double minX = tile.bbox().min.x(), maxX = tile.bbox().max.x();
+    double minY = tile.bbox().min.y(), maxY = tile.bbox().max.y();
+    const double w = maxX - minX;
+    const double h = maxY - minY;
+    const double tol = 1e-10 * std::max(w, h);
+
+    const uint NONE = UINT_MAX;
+
+    // sides of the tile: 0 left, 1 right, 2 bottom, 3 top
+    std::vector<bool> on_side[4];
+    for (uint s=0; s < 4; s++) on_side[s].assign(nv, false);
+
+    std::vector<std::pair<double,uint>> side_verts[4];
+
+    for (uint vid=0; vid < nv; vid++)
+    {
+        const cinolib::vec3d &p = tile.vert(vid);
+
+        if (std::fabs(p.x() - minX) <= tol) { on_side[0].at(vid) = true; side_verts[0].push_back(std::make_pair(p.y(), vid)); }
+        if (std::fabs(p.x() - maxX) <= tol) { on_side[1].at(vid) = true; side_verts[1].push_back(std::make_pair(p.y(), vid)); }
+        if (std::fabs(p.y() - minY) <= tol) { on_side[2].at(vid) = true; side_verts[2].push_back(std::make_pair(p.x(), vid)); }
+        if (std::fabs(p.y() - maxY) <= tol) { on_side[3].at(vid) = true; side_verts[3].push_back(std::make_pair(p.x(), vid)); }
+    }
+
+    for (uint s=0; s < 4; s++) std::sort(side_verts[s].begin(), side_verts[s].end());
+
+    // twin[s][vid]: vertex on the side opposite to s at the same position
+    std::vector<uint> twin[4];
+    for (uint s=0; s < 4; s++) twin[s].assign(nv, NONE);
+
+    match_sides(side_verts[0], side_verts[1], tol, twin[0]);
+    match_sides(side_verts[1], side_verts[0], tol, twin[1]);
+    match_sides(side_verts[2], side_verts[3], tol, twin[2]);
+    match_sides(side_verts[3], side_verts[2], tol, twin[3]);
+
+    if (mode == PERIODIC_TILING)
+    {
+        uint n_unmatched = 0;
+        for (uint s=0; s < 4; s++)
+            for (const std::pair<double,uint> &sv : side_verts[s])
+                if (twin[s].at(sv.second) == NONE) n_unmatched++;
+
+        if (n_unmatched > 0)
+            std::cerr << "tile_mesh: " << n_unmatched << " side vertices have no periodic counterpart, "
+                      << "the tiled mesh will be non-conforming" << std::endl;
+    }
+
+    verts.reserve(static_cast<size_t>(nx) * ny * nv);
+    polys.reserve(static_cast<size_t>(nx) * ny * np);
+
+    // global vertex ids of the tiles in the previous and in the current row
+    std::vector<uint> prev_row (static_cast<size_t>(nx) * nv, NONE);
+    std::vector<uint> curr_row (static_cast<size_t>(nx) * nv, NONE);
+
+    const double scale_x = 1.0 / (nx * w);
+    const double scale_y = 1.0 / (ny * h);
+
+    for (uint j=0; j < ny; j++)
+    {
+        const bool flip_y = (mode == REFLECTED_TILING) && (j % 2 == 1);
+
+        // world bottom side of this tile, and world top side of the one below
+        const uint bottom = flip_y ? 3 : 2;
+        const uint top_below = (mode == REFLECTED_TILING && !flip_y) ? 2 : 3;
+
+        for (uint i=0; i < nx; i++)
+        {
+            const bool flip_x = (mode == REFLECTED_TILING) && (i % 2 == 1);
+
+            const uint left = flip_x ? 1 : 0;
+            const uint right_prev = (mode == REFLECTED_TILING && !flip_x) ? 0 : 1;
+
+            uint *ids = curr_row.data() + static_cast<size_t>(i) * nv;
+
+            for (uint vid=0; vid < nv; vid++)
+            {
+                uint id = NONE;
+
+                if (i > 0 && on_side[left].at(vid))
+                {
+                    uint t = (left == right_prev) ? vid : twin[left].at(vid);
+                    if (t != NONE) id = curr_row.at(static_cast<size_t>(i-1) * nv + t);
+                }
+
+                if (id == NONE && j > 0 && on_side[bottom].at(vid))
+                {
+                    uint t = (bottom == top_below) ? vid : twin[bottom].at(vid);
+                    if (t != NONE) id = prev_row.at(static_cast<size_t>(i) * nv + t);
+                }
+
+                if (id == NONE)
+                {
+                    const cinolib::vec3d &p = tile.vert(vid);
+                    double x = flip_x ? (maxX - p.x()) : (p.x() - minX);
+                    double y = flip_y ? (maxY - p.y()) : (p.y() - minY);
+
+                    id = static_cast<uint>(verts.size());
+                    verts.push_back(cinolib::vec3d((i * w + x) * scale_x, (j * h + y) * scale_y, 0.0));
+                }
+
+                ids[vid] = id;
+            }
+
+            for (uint pid=0; pid < np; pid++)
+            {
+                std::vector<uint> poly;
+                poly.reserve(tile.adj_p2v(pid).size());
+
+                for (uint vid : tile.adj_p2v(pid))
+                    poly.push_back(ids[vid]);
+
+                if (flip_x != flip_y) std::reverse(poly.begin(), poly.end());
+
+                polys.push_back(std::move(poly));
+            }
+        }
+
+        std::swap(prev_row, curr_row);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void apply_tiling (cinolib::Polygonmesh<> &mesh, const uint nx, const uint ny, const int mode)
+{
+    const uint np = mesh.num_polys();
+
+    std::vector<cinolib::vec3d> verts;
+    std::vector<std::vector<uint>> polys;
+    tile_mesh(mesh, nx, ny, mode, verts, polys);
+
+    if (polys.empty()) return;
+
+    auto mesh_data = mesh.mesh_data();
+
+    std::vector<std::decay<decltype(mesh.poly_data(0))>::type> poly_data (np);
+    for (uint pid=0; pid < np; pid++) poly_data.at(pid) = mesh.poly_data(pid);
+
+    // edge attributes are looked up through the first and second vertex of
+    // the edge inside one of its polygons, which is valid on every copy
+    std::vector<std::pair<uint,uint>> edge_offsets;
+    std::vector<std::decay<decltype(mesh.edge_data(0))>::type> edge_data;
+    for (uint eid=0; eid < mesh.num_edges(); eid++)
+    {
+        if (mesh.adj_e2p(eid).empty()) continue;
+
+        uint pid = mesh.adj_e2p(eid).front();
+        edge_offsets.push_back(std::make_pair(pid, mesh.poly_vert_offset(pid, mesh.edge_vert_id(eid,0))));
+        edge_offsets.push_back(std::make_pair(pid, mesh.poly_vert_offset(pid, mesh.edge_vert_id(eid,1))));
+        edge_data.push_back(mesh.edge_data(eid));
+    }
+
+    mesh = cinolib::Polygonmesh<>(verts, polys);
+    mesh.mesh_data() = mesh_data;
+
+    for (uint pid=0; pid < mesh.num_polys(); pid++)
+        mesh.poly_data(pid) = poly_data.at(pid%np);
+
+    for (uint j=0; j < ny; j++)
+        for (uint i=0; i < nx; i++)
+        {
+            const uint t = j*nx + i;
+            const bool reversed = (mode == REFLECTED_TILING) && (i % 2 != j % 2);
+
+            for (uint e=0; e < edge_data.size(); e++)
+            {
+                const std::pair<uint,uint> &o0 = edge_offsets.at(2*e);
+                const std::pair<uint,uint> &o1 = edge_offsets.at(2*e+1);
+
+                const std::vector<uint> &poly = polys.at(t*np + o0.first);
+                const uint n = static_cast<uint>(poly.size());
+
+                uint v0 = reversed ? poly.at(n-1-o0.second) : poly.at(o0.second);
+                uint v1 = reversed ? poly.at(n-1-o1.second) : poly.at(o1.second);
+
+                int eid = mesh.edge_id(v0, v1);
+                if (eid >= 0) mesh.edge_data(eid) = edge_data.at(e);
+            }
+        }
+}
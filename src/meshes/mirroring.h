@@ -39,7 +39,34 @@ void translate(cinolib::Polygonmesh<> &tin, const cinolib::vec3d &t);
 void mirror_x(cinolib::Polygonmesh<> &tin);
 void mirror_y(cinolib::Polygonmesh<> &tin);
 
+// Builds the 2x2 mirrored mesh, rescaled to the unit square. Seam vertices
+// are welded by repeated vertex clustering and vert_merge: the element order
+// of the output is the one saved datasets rely on.
 void apply_mirroring (cinolib::Polygonmesh<> &tin);
 
+typedef enum
+{
+    PERIODIC_TILING,        // tiles are translated copies
+    REFLECTED_TILING        // odd columns/rows are mirrored, as in apply_mirroring
+}
+TILING_MODES;
+
+// Arranges nx * ny copies of the tile in the unit square. Shared tile
+// boundaries are welded through an index map built once on the tile (with
+// periodic tiling, opposite sides are matched by coordinate; vertices with
+// no counterpart are left unwelded). Time and memory are linear in the
+// output size. Polygons are emitted tile by tile, so output polygon pid
+// is a copy of tile polygon pid % tile.num_polys().
+void tile_mesh (const cinolib::Polygonmesh<>     & tile,
+                const uint                         nx,
+                const uint                         ny,
+                const int                          mode,
+                std::vector<cinolib::vec3d>      & verts,
+                std::vector<std::vector<uint>>   & polys);
+
+// Replaces the mesh with its nx * ny tiling, replicating polygon and
+// edge attributes (e.g. PEM element flags) on every copy.
+void apply_tiling (cinolib::Polygonmesh<> &mesh, const uint nx, const uint ny, const int mode);
+
 
 #endif // MIRRORING_H
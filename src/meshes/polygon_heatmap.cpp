@@ -0,0 +1,170 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "polygon_heatmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void PolygonHeatmap::set_geometry(const Polygonmesh<> &m)
+{
+    poly_tris.assign(m.num_polys()+1, 0);
+
+    for (uint pid=0; pid < m.num_polys(); pid++)
+        poly_tris.at(pid+1) = poly_tris.at(pid) + static_cast<uint>(m.poly_tessellation(pid).size()/3);
+
+    const uint n_tris = poly_tris.back();
+
+    coords.resize(9 * static_cast<size_t>(n_tris));
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int pid=0; pid < static_cast<int>(m.num_polys()); pid++)
+    {
+        const std::vector<uint> &tess = m.poly_tessellation(static_cast<uint>(pid));
+
+        float *c = coords.data() + 9 * static_cast<size_t>(poly_tris.at(pid));
+
+        for (uint vid : tess)
+        {
+            const vec3d &p = m.vert(vid);
+            *c++ = static_cast<float>(p.x());
+            *c++ = static_cast<float>(p.y());
+            *c++ = static_cast<float>(p.z());
+        }
+    }
+
+    edge_coords.resize(6 * static_cast<size_t>(m.num_edges()));
+
+    #pragma omp parallel for
+    for (int eid=0; eid < static_cast<int>(m.num_edges()); eid++)
+    {
+        float *c = edge_coords.data() + 6 * static_cast<size_t>(eid);
+
+        for (uint i=0; i < 2; i++)
+        {
+            const vec3d &p = m.vert(m.edge_vert_id(static_cast<uint>(eid), i));
+            *c++ = static_cast<float>(p.x());
+            *c++ = static_cast<float>(p.y());
+            *c++ = static_cast<float>(p.z());
+        }
+    }
+
+    field_scene_bounds(m, center, radius);
+
+    colors.assign(coords.size(), 255);
+
+    coords_dirty = true;
+    colors_dirty = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void PolygonHeatmap::set_poly_colors(const std::vector<Color> &poly_colors)
+{
+    const int n_polys = static_cast<int>(std::min(static_cast<size_t>(num_polys()), poly_colors.size()));
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int pid=0; pid < n_polys; pid++)
+    {
+        const Color &col = poly_colors.at(static_cast<size_t>(pid));
+
+        unsigned char rgb[3];
+        color_to_rgb8(col, rgb);
+
+        unsigned char *c   = colors.data() + 9 * static_cast<size_t>(poly_tris.at(pid));
+        unsigned char *end = colors.data() + 9 * static_cast<size_t>(poly_tris.at(pid+1));
+
+        for (; c < end; c += 3) std::copy(rgb, rgb+3, c);
+    }
+
+    colors_dirty = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void PolygonHeatmap::set_poly_values(const std::vector<double> &values, const bool log_scale)
+{
+    std::vector<double> v (values.size());
+
+    double min =  std::numeric_limits<double>::max();
+    double max = -std::numeric_limits<double>::max();
+
+    for (size_t i=0; i < values.size(); i++)
+    {
+        v.at(i) = log_scale ? std::log(values.at(i)) : values.at(i);
+
+        if (std::isfinite(v.at(i)))
+        {
+            min = std::min(min, v.at(i));
+            max = std::max(max, v.at(i));
+        }
+    }
+
+    const double delta = (max > min) ? (max - min) : 1.0;
+
+    std::vector<Color> poly_colors (values.size());
+
+    #pragma omp parallel for
+    for (int i=0; i < static_cast<int>(values.size()); i++)
+    {
+        const double t = std::isfinite(v.at(i)) ? (v.at(i) - min) / delta : 1.0;
+        poly_colors.at(i) = Color::red_white_blue_ramp_01(static_cast<float>(t));
+    }
+
+    set_poly_colors(poly_colors);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void PolygonHeatmap::draw(const float) const
+{
+    if (coords.empty()) return;
+
+    if (coords_dirty)
+    {
+        buffers.upload_coords(coords);
+        buffers.upload_edge_coords(edge_coords);
+
+        coords_dirty = false;
+    }
+
+    if (colors_dirty)
+    {
+        buffers.upload_colors(colors);
+        colors_dirty = false;
+    }
+
+    buffers.draw();
+}
@@ -0,0 +1,99 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef POLYGON_HEATMAP_H
+#define POLYGON_HEATMAP_H
+
+#include "color_field_buffers.h"
+
+#include <cinolib/drawable_object.h>
+#include <cinolib/meshes/polygonmesh.h>
+
+#include <vector>
+
+using namespace cinolib;
+
+// Per polygon color field of a mesh, drawn flat (without lighting) with the
+// mesh edges on top, from GPU buffers: the triangle and edge coordinates,
+// uploaded once per mesh, and the triangle colors. Changing the colors
+// re-uploads the color buffer only, so the same geometry can show different
+// fields (e.g. a heatmap of each polygon metric) without the full rebuild of
+// DrawablePolygonmesh::updateGL. It is drawn instead of the mesh.
+//
+// GPU buffers are created in draw(), in the context of the canvas; the
+// object must be deleted with that context current.
+
+class PolygonHeatmap : public DrawableObject
+{
+    public:
+
+        PolygonHeatmap() {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // triangulates the polygons of m and copies its edges. Colors are
+        // reset to white
+        void set_geometry(const Polygonmesh<> &m);
+
+        // one color per polygon, in the polygon order of the mesh
+        void set_poly_colors(const std::vector<Color> &poly_colors);
+
+        // maps one value per polygon to colors (red for the minimum, blue for
+        // the maximum of the finite values). Non finite values take the color
+        // of the maximum. With log_scale, the log of the values is mapped
+        void set_poly_values(const std::vector<double> &values, const bool log_scale = false);
+
+        uint num_polys() const { return poly_tris.empty() ? 0 : static_cast<uint>(poly_tris.size()-1); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        ObjectType object_type()  const { return DRAWABLE_POLYGONMESH; }
+        void       draw(const float scene_size=1) const;
+        vec3d      scene_center() const { return center; }
+        float      scene_radius() const { return radius; }
+
+    private:
+
+        std::vector<float>         coords;      // 3 vertices per triangle, xyz
+        std::vector<float>         edge_coords; // 2 vertices per edge, xyz
+        std::vector<unsigned char> colors;      // 3 vertices per triangle, rgb
+        std::vector<uint>          poly_tris;   // first triangle of each polygon, plus the number of triangles
+
+        vec3d center;
+        float radius = 0.f;
+
+        mutable ColorFieldBuffers buffers;
+        mutable bool              coords_dirty = true;
+        mutable bool              colors_dirty = true;
+};
+
+#endif // POLYGON_HEATMAP_H
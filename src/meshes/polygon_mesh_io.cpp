@@ -0,0 +1,529 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "polygon_mesh_io.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+inline bool is_blank (const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char * skip_blanks (const char *p, const char *end)
+{
+    while (p < end && is_blank(*p)) p++;
+    return p;
+}
+
+inline const char * skip_line (const char *p, const char *end)
+{
+    while (p < end && *p != '\n') p++;
+    return (p < end) ? p+1 : end;
+}
+
+// skips blank and comment ('#') lines
+inline const char * next_data_line (const char *p, const char *end)
+{
+    while (p < end)
+    {
+        const char *q = skip_blanks(p, end);
+        if (q < end && *q != '\n' && *q != '#') return q;
+        p = skip_line(q, end);
+    }
+    return end;
+}
+
+template<typename T>
+inline bool parse_number (const char *&p, const char *end, T &value)
+{
+    p = skip_blanks(p, end);
+    if (p < end && *p == '+') p++;
+
+    std::from_chars_result res = std::from_chars(p, end, value);
+    if (res.ec != std::errc()) return false;
+
+    p = res.ptr;
+    return true;
+}
+
+// index of an OBJ face corner ("v", "v/vt", "v//vn" or "v/vt/vn"),
+// relative indices are resolved against the current number of vertices
+inline bool parse_obj_index (const char *&p, const char *end, const uint nv, uint &vid)
+{
+    long idx;
+    if (!parse_number(p, end, idx)) return false;
+
+    while (p < end && !is_blank(*p) && *p != '\n') p++; // texture/normal ids
+
+    if      (idx > 0) vid = static_cast<uint>(idx - 1);
+    else if (idx < 0) vid = static_cast<uint>(static_cast<long>(nv) + idx);
+    else              return false;
+
+    return true;
+}
+
+inline bool line_has_data (const char *p, const char *end)
+{
+    p = skip_blanks(p, end);
+    return p < end && *p != '\n' && *p != '#';
+}
+
+bool report (const std::string &filename, const std::string &what)
+{
+    std::cerr << "ERROR: " << filename << ": " << what << std::endl;
+    return false;
+}
+
+void clear (FlatPolygonMesh &m)
+{
+    m.coords.clear();
+    m.poly_offsets.assign(1, 0);
+    m.poly_verts.clear();
+}
+
+bool check_indices (const std::string &filename, const FlatPolygonMesh &m)
+{
+    for (uint vid : m.poly_verts)
+        if (vid >= m.num_verts())
+            return report(filename, "vertex index out of range");
+
+    return true;
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool read_OBJ_2D (const std::string &filename, FlatPolygonMesh &m)
+{
+    clear(m);
+
+    MappedFile file;
+    if (!file.open(filename)) return report(filename, "cannot open file");
+
+    const char *p   = file.data();
+    const char *end = p + file.size();
+
+    // a rough guess of the sizes avoids most reallocations
+    m.coords.reserve(file.size() / 24);
+    m.poly_verts.reserve(file.size() / 8);
+
+    while (p < end)
+    {
+        p = skip_blanks(p, end);
+
+        if (end - p > 1 && p[0] == 'v' && is_blank(p[1]))
+        {
+            p += 2;
+
+            double x, y;
+            if (!parse_number(p, end, x) || !parse_number(p, end, y))
+                return report(filename, "bad vertex");
+
+            m.coords.push_back(x);
+            m.coords.push_back(y);
+        }
+        else if (end - p > 1 && p[0] == 'f' && is_blank(p[1]))
+        {
+            p += 2;
+
+            const uint nv = m.num_verts();
+
+            while (line_has_data(p, end))
+            {
+                uint vid;
+                if (!parse_obj_index(p, end, nv, vid))
+                    return report(filename, "bad face");
+
+                m.poly_verts.push_back(vid);
+            }
+
+            m.poly_offsets.push_back(static_cast<uint>(m.poly_verts.size()));
+        }
+
+        p = skip_line(p, end);
+    }
+
+    return check_indices(filename, m);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool read_OFF_2D (const std::string &filename, FlatPolygonMesh &m)
+{
+    clear(m);
+
+    MappedFile file;
+    if (!file.open(filename)) return report(filename, "cannot open file");
+
+    const char *p   = file.data();
+    const char *end = p + file.size();
+
+    p = next_data_line(p, end);
+    if (end - p < 3 || p[0] != 'O' || p[1] != 'F' || p[2] != 'F')
+        return report(filename, "missing OFF header");
+
+    // counts may follow the keyword on the same line
+    p += 3;
+    if (!line_has_data(p, end)) p = next_data_line(p, end);
+
+    uint nv, nf;
+    if (!parse_number(p, end, nv) || !parse_number(p, end, nf))
+        return report(filename, "bad OFF counts");
+
+    m.coords.reserve(2*static_cast<size_t>(nv));
+    m.poly_offsets.reserve(static_cast<size_t>(nf) + 1);
+    m.poly_verts.reserve(3*static_cast<size_t>(nf));
+
+    for (uint vid=0; vid < nv; vid++)
+    {
+        p = next_data_line(skip_line(p, end), end);
+
+        double x, y;
+        if (!parse_number(p, end, x) || !parse_number(p, end, y))
+            return report(filename, "bad vertex");
+
+        m.coords.push_back(x);
+        m.coords.push_back(y);
+    }
+
+    for (uint pid=0; pid < nf; pid++)
+    {
+        p = next_data_line(skip_line(p, end), end);
+
+        uint n;
+        if (!parse_number(p, end, n)) return report(filename, "bad face");
+
+        for (uint i=0; i < n; i++)
+        {
+            uint vid;
+            if (!parse_number(p, end, vid)) return report(filename, "bad face");
+            m.poly_verts.push_back(vid);
+        }
+
+        // optional face colors are ignored
+        m.poly_offsets.push_back(static_cast<uint>(m.poly_verts.size()));
+    }
+
+    return check_indices(filename, m);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool read_NODE_ELE_2D (const std::string &basename, FlatPolygonMesh &m)
+{
+    clear(m);
+
+    const std::string node_filename = basename + ".node";
+    const std::string ele_filename  = basename + ".ele";
+
+    MappedFile node_file;
+    if (!node_file.open(node_filename)) return report(node_filename, "cannot open file");
+
+    const char *p   = node_file.data();
+    const char *end = p + node_file.size();
+
+    p = next_data_line(p, end);
+
+    uint nv;
+    if (!parse_number(p, end, nv)) return report(node_filename, "bad header");
+
+    m.coords.reserve(2*static_cast<size_t>(nv));
+
+    long base = 0;
+
+    for (uint vid=0; vid < nv; vid++)
+    {
+        p = next_data_line(skip_line(p, end), end);
+
+        long id;
+        double x, y;
+        if (!parse_number(p, end, id) || !parse_number(p, end, x) || !parse_number(p, end, y))
+            return report(node_filename, "bad vertex");
+
+        if (vid == 0) base = id; // numbering starts at 0 or 1
+
+        m.coords.push_back(x);
+        m.coords.push_back(y);
+    }
+
+    MappedFile ele_file;
+    if (!ele_file.open(ele_filename)) return report(ele_filename, "cannot open file");
+
+    p   = ele_file.data();
+    end = p + ele_file.size();
+
+    p = next_data_line(p, end);
+
+    uint nf;
+    if (!parse_number(p, end, nf)) return report(ele_filename, "bad header");
+
+    // header: number of elements, corners per element, attributes per
+    // element (as written by Triangle: 3 and 0 if omitted). Zero corners
+    // declare polygons of any size, with the number of vertices after the
+    // element id
+    uint n_corners = 3, n_attributes = 0;
+    if (line_has_data(p, end) && !parse_number(p, end, n_corners))    return report(ele_filename, "bad header");
+    if (line_has_data(p, end) && !parse_number(p, end, n_attributes)) return report(ele_filename, "bad header");
+
+    m.poly_offsets.reserve(static_cast<size_t>(nf) + 1);
+    m.poly_verts.reserve((n_corners > 0 ? n_corners : 4) * static_cast<size_t>(nf));
+
+    std::vector<double> fields;
+
+    for (uint pid=0; pid < nf; pid++)
+    {
+        p = next_data_line(skip_line(p, end), end);
+
+        // element id, vertex ids and attributes (which may be real numbers)
+        fields.clear();
+        while (line_has_data(p, end))
+        {
+            double x;
+            if (!parse_number(p, end, x)) return report(ele_filename, "bad element");
+            fields.push_back(x);
+        }
+
+        if (fields.size() < 1 + n_attributes) return report(ele_filename, "bad element");
+
+        size_t first = 1, n = fields.size() - 1 - n_attributes;
+
+        if (n_corners == 0)
+        {
+            if (n == 0 || static_cast<size_t>(fields.at(1)) != n - 1) return report(ele_filename, "bad element");
+            first = 2;
+            n     = n - 1;
+        }
+        else if (n != n_corners) return report(ele_filename, "bad element");
+
+        for (size_t i=first; i < first + n; i++)
+            m.poly_verts.push_back(static_cast<uint>(static_cast<long>(fields.at(i)) - base));
+
+        m.poly_offsets.push_back(static_cast<uint>(m.poly_verts.size()));
+    }
+
+    return check_indices(ele_filename, m);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool read_polygon_mesh_2D (const std::string &filename, FlatPolygonMesh &m)
+{
+    std::string ext = filename.substr(filename.find_last_of(".") + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    if (ext == "obj") return read_OBJ_2D(filename, m);
+    if (ext == "off") return read_OFF_2D(filename, m);
+    if (ext == "node" || ext == "ele") return read_NODE_ELE_2D(filename.substr(0, filename.find_last_of(".")), m);
+
+    return report(filename, "unsupported file format");
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+template<typename T>
+inline void append_number (std::string &buffer, const T value)
+{
+    char tmp[32];
+    std::to_chars_result res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    buffer.append(tmp, res.ptr);
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void serialize_OBJ_2D (const FlatPolygonMesh &m, std::string &buffer)
+{
+    buffer.clear();
+    buffer.reserve(48 * static_cast<size_t>(m.num_verts()) + 8 * m.poly_verts.size() + 4 * static_cast<size_t>(m.num_polys()));
+
+    for (uint vid=0; vid < m.num_verts(); vid++)
+    {
+        buffer += "v ";
+        append_number(buffer, m.coords.at(2*vid));
+        buffer += ' ';
+        append_number(buffer, m.coords.at(2*vid+1));
+        buffer += " 0\n";
+    }
+
+    for (uint pid=0; pid < m.num_polys(); pid++)
+    {
+        buffer += 'f';
+        for (uint i=m.poly_offsets.at(pid); i < m.poly_offsets.at(pid+1); i++)
+        {
+            buffer += ' ';
+            append_number(buffer, m.poly_verts.at(i) + 1);
+        }
+        buffer += '\n';
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void serialize_OFF_2D (const FlatPolygonMesh &m, std::string &buffer)
+{
+    buffer.clear();
+    buffer.reserve(48 * static_cast<size_t>(m.num_verts()) + 8 * m.poly_verts.size() + 8 * static_cast<size_t>(m.num_polys()));
+
+    buffer += "OFF\n";
+    append_number(buffer, m.num_verts());
+    buffer += ' ';
+    append_number(buffer, m.num_polys());
+    buffer += " 0\n";
+
+    for (uint vid=0; vid < m.num_verts(); vid++)
+    {
+        append_number(buffer, m.coords.at(2*vid));
+        buffer += ' ';
+        append_number(buffer, m.coords.at(2*vid+1));
+        buffer += " 0\n";
+    }
+
+    for (uint pid=0; pid < m.num_polys(); pid++)
+    {
+        append_number(buffer, m.poly_offsets.at(pid+1) - m.poly_offsets.at(pid));
+        for (uint i=m.poly_offsets.at(pid); i < m.poly_offsets.at(pid+1); i++)
+        {
+            buffer += ' ';
+            append_number(buffer, m.poly_verts.at(i));
+        }
+        buffer += '\n';
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool write_buffer (const std::string &filename, const std::string &buffer)
+{
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (f == nullptr) return report(filename, "cannot open file for writing");
+
+    bool ok = (fwrite(buffer.data(), 1, buffer.size(), f) == buffer.size());
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok) return report(filename, "write failed");
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool sync_file (const std::string &filename)
+{
+#ifdef _WIN32
+    (void) filename;
+    return true;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return report(filename, "cannot open file for syncing");
+
+    bool ok = (::fsync(fd) == 0);
+    ::close(fd);
+
+    if (!ok) return report(filename, "fsync failed");
+    return true;
+#endif
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool write_OBJ_2D (const std::string &filename, const FlatPolygonMesh &m)
+{
+    std::string buffer;
+    serialize_OBJ_2D(m, buffer);
+    return write_buffer(filename, buffer);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool write_OFF_2D (const std::string &filename, const FlatPolygonMesh &m)
+{
+    std::string buffer;
+    serialize_OFF_2D(m, buffer);
+    return write_buffer(filename, buffer);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void flat_polygon_mesh (const cinolib::Polygonmesh<> &mesh, FlatPolygonMesh &m)
+{
+    clear(m);
+
+    m.coords.reserve(2*static_cast<size_t>(mesh.num_verts()));
+    for (uint vid=0; vid < mesh.num_verts(); vid++)
+    {
+        m.coords.push_back(mesh.vert(vid).x());
+        m.coords.push_back(mesh.vert(vid).y());
+    }
+
+    m.poly_offsets.reserve(static_cast<size_t>(mesh.num_polys()) + 1);
+    for (uint pid=0; pid < mesh.num_polys(); pid++)
+    {
+        const std::vector<uint> &poly = mesh.adj_p2v(pid);
+        m.poly_verts.insert(m.poly_verts.end(), poly.begin(), poly.end());
+        m.poly_offsets.push_back(static_cast<uint>(m.poly_verts.size()));
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void flat_polygon_mesh_to_vectors (const FlatPolygonMesh                & m,
+                                   std::vector<cinolib::vec3d>          & verts,
+                                   std::vector<std::vector<uint>>       & polys)
+{
+    verts.resize(m.num_verts());
+    for (uint vid=0; vid < m.num_verts(); vid++)
+        verts.at(vid) = cinolib::vec3d(m.coords.at(2*vid), m.coords.at(2*vid+1), 0.0);
+
+    polys.resize(m.num_polys());
+    for (uint pid=0; pid < m.num_polys(); pid++)
+        polys.at(pid).assign(m.poly_verts.begin() + m.poly_offsets.at(pid),
+                             m.poly_verts.begin() + m.poly_offsets.at(pid+1));
+}
@@ -0,0 +1,95 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef POLYGON_MESH_IO_H
+#define POLYGON_MESH_IO_H
+
+#include <cinolib/meshes/meshes.h>
+
+#include <string>
+#include <vector>
+
+// 2D polygon mesh stored in flat arrays: vertex vid is at
+// (coords[2*vid], coords[2*vid+1]) and polygon pid is the loop
+// poly_verts[poly_offsets[pid] ... poly_offsets[pid+1]-1] (CSR layout)
+typedef struct
+{
+    std::vector<double> coords;
+    std::vector<uint>   poly_offsets = std::vector<uint>(1, 0);
+    std::vector<uint>   poly_verts;
+
+    uint num_verts () const { return static_cast<uint>(coords.size()/2); }
+    uint num_polys () const { return static_cast<uint>(poly_offsets.size()-1); }
+} FlatPolygonMesh;
+
+// Readers memory-map the file and parse numbers with std::from_chars, with
+// no per-line allocation. The z coordinate, if any, is ignored. They return
+// false (and print the reason on std::cerr) if the file cannot be read.
+
+bool read_OBJ_2D (const std::string &filename, FlatPolygonMesh &m);
+bool read_OFF_2D (const std::string &filename, FlatPolygonMesh &m);
+
+// reads basename.node and basename.ele, as written by write_NODE_ELE_2D.
+// Both 0 and 1 based numbering are accepted. The .ele header gives the
+// layout of the element lines: with n > 0 corners per element they are
+// "id v0 ... vn-1", with 0 corners "id n v0 ... vn-1", followed in both
+// cases by the number of attributes in the header
+bool read_NODE_ELE_2D (const std::string &basename, FlatPolygonMesh &m);
+
+// dispatches on the extension (.obj, .off, .node or .ele)
+bool read_polygon_mesh_2D (const std::string &filename, FlatPolygonMesh &m);
+
+// Writers serialize the whole mesh in memory, with the shortest decimal
+// representation that reads back to the same double (std::to_chars), and
+// write it with a single call. Serialization is split from writing, so that
+// it can run on worker threads while another thread does the I/O.
+
+void serialize_OBJ_2D (const FlatPolygonMesh &m, std::string &buffer);
+void serialize_OFF_2D (const FlatPolygonMesh &m, std::string &buffer);
+
+bool write_buffer (const std::string &filename, const std::string &buffer);
+
+// flushes a written file to the storage device (fsync). No-op on Windows
+bool sync_file (const std::string &filename);
+
+bool write_OBJ_2D (const std::string &filename, const FlatPolygonMesh &m);
+bool write_OFF_2D (const std::string &filename, const FlatPolygonMesh &m);
+
+// conversions from/to cinolib meshes
+
+void flat_polygon_mesh (const cinolib::Polygonmesh<> &mesh, FlatPolygonMesh &m);
+
+void flat_polygon_mesh_to_vectors (const FlatPolygonMesh                & m,
+                                   std::vector<cinolib::vec3d>          & verts,
+                                   std::vector<std::vector<uint>>       & polys);
+
+#endif // POLYGON_MESH_IO_H
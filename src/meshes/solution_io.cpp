@@ -0,0 +1,192 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "solution_io.h"
+#include "mapped_file.h"
+#include "polygon_mesh_io.h"
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+inline bool is_space (const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool parse_double (const char *&p, const char *end, double &value)
+{
+    while (p < end && is_space(*p)) p++;
+    if (p < end && *p == '+') p++;
+
+    std::from_chars_result res = std::from_chars(p, end, value);
+    if (res.ec != std::errc()) return false;
+
+    p = res.ptr;
+    return true;
+}
+
+inline void append_double (std::string &buffer, const double value)
+{
+    char tmp[32];
+    std::to_chars_result res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+    buffer.append(tmp, res.ptr);
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool read_vertex_field(const std::string &filename, const uint n, std::vector<double> &values)
+{
+    values.clear();
+
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        std::cerr << "Error opening " << filename << std::endl;
+        return false;
+    }
+
+    values.resize(n);
+
+    const char *p   = file.data();
+    const char *end = p + file.size();
+
+    for (uint i=0; i < n; i++)
+    {
+        if (!parse_double(p, end, values.at(i)))
+        {
+            std::cerr << "ERROR: " << filename << " has " << i << " values, " << n << " expected" << std::endl;
+            values.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool read_error_table(const std::string &filename, const uint n_cols, std::vector<std::vector<double>> &cols)
+{
+    cols.assign(n_cols, std::vector<double>());
+
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        std::cerr << "Error opening " << filename << std::endl;
+        return false;
+    }
+
+    const char *p   = file.data();
+    const char *end = p + file.size();
+
+    std::vector<double> row (n_cols);
+
+    // as with ifstream >>, reading stops at the first incomplete row
+    while (true)
+    {
+        uint c = 0;
+        while (c < n_cols && parse_double(p, end, row.at(c))) c++;
+
+        if (c < n_cols) break;
+
+        for (uint i=0; i < n_cols; i++)
+            cols.at(i).push_back(row.at(i));
+    }
+
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool write_vertex_field(const std::string &filename, const std::vector<double> &values)
+{
+    std::string buffer;
+    buffer.reserve(values.size() * 24);
+
+    for (const double v : values)
+    {
+        append_double(buffer, v);
+        buffer.push_back('\n');
+    }
+
+    return write_buffer(filename, buffer);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool write_error_table(const std::string &filename, const std::vector<std::vector<double>> &cols)
+{
+    const size_t n_rows = cols.empty() ? 0 : cols.front().size();
+
+    std::string buffer;
+    buffer.reserve(n_rows * cols.size() * 24);
+
+    for (size_t r=0; r < n_rows; r++)
+    {
+        for (size_t c=0; c < cols.size(); c++)
+        {
+            if (c > 0) buffer.push_back(' ');
+            append_double(buffer, cols.at(c).at(r));
+        }
+        buffer.push_back('\n');
+    }
+
+    return write_buffer(filename, buffer);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void vertex_field_colors(std::vector<double> &values, std::vector<cinolib::Color> &colors)
+{
+    colors.resize(values.size());
+
+    if (values.empty()) return;
+
+    auto range = std::minmax_element(values.begin(), values.end());
+    const double min = *range.first;
+    const double max = *range.second;
+
+    if (min != max)
+        for (double &v : values)
+            v = (v - min) / (max - min);
+
+    for (size_t i=0; i < values.size(); i++)
+        colors.at(i) = cinolib::Color::red_white_blue_ramp_01(static_cast<float>(values.at(i)));
+}
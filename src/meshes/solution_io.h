@@ -0,0 +1,64 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef SOLUTION_IO_H
+#define SOLUTION_IO_H
+
+#include <cinolib/meshes/meshes.h>
+
+#include <string>
+#include <vector>
+
+// Readers for the text outputs of the PDE solver. Files are memory-mapped
+// and parsed with std::from_chars: they allocate nothing but the output and
+// are safe to call concurrently on different files.
+
+// reads the first n whitespace separated values of a per-vertex solution file
+bool read_vertex_field (const std::string &filename, const uint n, std::vector<double> &values);
+
+// reads a results table with one row per mesh and n_cols values per row,
+// returned column by column
+bool read_error_table (const std::string &filename, const uint n_cols, std::vector<std::vector<double>> &cols);
+
+// Writers produce the same formats, with the shortest decimal representation
+// that reads back to the same double, and write them with a single call
+
+bool write_vertex_field (const std::string &filename, const std::vector<double> &values);
+
+// cols are the columns of the table, all of the same size (one row per mesh)
+bool write_error_table (const std::string &filename, const std::vector<std::vector<double>> &cols);
+
+// normalizes a field in [0,1] (unless it is constant) and maps it to the
+// red-white-blue ramp used to display solutions
+void vertex_field_colors (std::vector<double> &values, std::vector<cinolib::Color> &colors);
+
+#endif // SOLUTION_IO_H
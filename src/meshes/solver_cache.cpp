@@ -0,0 +1,183 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "solver_cache.h"
+#include "dataset_manifest.h"
+#include "mapped_file.h"
+#include "polygon_mesh_io.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+const char     SOLVER_CACHE_MAGIC[8] = { 'P','E','M','S','O','L','V','\0' };
+const uint32_t SOLVER_CACHE_VERSION  = 1;
+
+// magic, version, number of errs, key, number of vertices
+const size_t HEADER_SIZE = sizeof(SOLVER_CACHE_MAGIC) + 2*sizeof(uint32_t) + 2*sizeof(uint64_t);
+
+std::string entry_filename (const std::string &folder, const uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".sol", key);
+    return (std::filesystem::path(folder) / name).string();
+}
+
+template <typename T>
+inline void append_raw (std::string &buffer, const T *data, const size_t n)
+{
+    buffer.append(reinterpret_cast<const char *>(data), n * sizeof(T));
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+const char * const SOLVER_CACHE_FOLDER = ".solver_cache";
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+uint64_t file_fingerprint(const std::string &filename)
+{
+    MappedFile file;
+    if (!file.open(filename)) return 0;
+
+    return hash_bytes(file.data(), file.size());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+uint64_t string_fingerprint(const std::string &description)
+{
+    return hash_bytes(description.data(), description.size());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+uint64_t solver_cache_key(const uint64_t content_hash, const unsigned int solution_id, const uint64_t solver_fingerprint)
+{
+    const uint64_t id = solution_id;
+
+    uint64_t h = hash_bytes(&content_hash, sizeof(content_hash));
+    h = hash_bytes(&id,                 sizeof(id),                 h);
+    h = hash_bytes(&solver_fingerprint, sizeof(solver_fingerprint), h);
+    return h;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool read_solver_cache_entry(const std::string &folder, const uint64_t key, SolverCacheEntry &entry)
+{
+    const std::string filename = entry_filename(folder, key);
+
+    std::error_code ec;
+    if (!std::filesystem::exists(filename, ec)) return false;
+
+    MappedFile file;
+    if (!file.open(filename)) return false;
+
+    if (file.size() < HEADER_SIZE || memcmp(file.data(), SOLVER_CACHE_MAGIC, sizeof(SOLVER_CACHE_MAGIC)) != 0)
+        return false;
+
+    const char *p = file.data() + sizeof(SOLVER_CACHE_MAGIC);
+
+    uint32_t version, n_errs;
+    uint64_t file_key, n_verts;
+
+    memcpy(&version,  p, sizeof(version));  p += sizeof(version);
+    memcpy(&n_errs,   p, sizeof(n_errs));   p += sizeof(n_errs);
+    memcpy(&file_key, p, sizeof(file_key)); p += sizeof(file_key);
+    memcpy(&n_verts,  p, sizeof(n_verts));  p += sizeof(n_verts);
+
+    if (version != SOLVER_CACHE_VERSION || file_key != key) return false;
+    if (file.size() != HEADER_SIZE + sizeof(double) * (n_errs + 2*n_verts)) return false;
+
+    entry.errs.resize(n_errs);
+    entry.solution.resize(n_verts);
+    entry.ground_truth.resize(n_verts);
+
+    memcpy(entry.errs.data(),         p, sizeof(double) * n_errs);  p += sizeof(double) * n_errs;
+    memcpy(entry.solution.data(),     p, sizeof(double) * n_verts); p += sizeof(double) * n_verts;
+    memcpy(entry.ground_truth.data(), p, sizeof(double) * n_verts);
+
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool write_solver_cache_entry(const std::string &folder, const uint64_t key, const SolverCacheEntry &entry)
+{
+    if (entry.solution.size() != entry.ground_truth.size()) return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(folder, ec);
+    if (ec) return false;
+
+    const uint32_t version = SOLVER_CACHE_VERSION;
+    const uint32_t n_errs  = static_cast<uint32_t>(entry.errs.size());
+    const uint64_t n_verts = entry.solution.size();
+
+    std::string buffer;
+    buffer.reserve(HEADER_SIZE + sizeof(double) * (n_errs + 2*n_verts));
+
+    buffer.append(SOLVER_CACHE_MAGIC, sizeof(SOLVER_CACHE_MAGIC));
+    append_raw(buffer, &version, 1);
+    append_raw(buffer, &n_errs,  1);
+    append_raw(buffer, &key,     1);
+    append_raw(buffer, &n_verts, 1);
+    append_raw(buffer, entry.errs.data(),         entry.errs.size());
+    append_raw(buffer, entry.solution.data(),     entry.solution.size());
+    append_raw(buffer, entry.ground_truth.data(), entry.ground_truth.size());
+
+    // the same key may be written by two threads (identical meshes)
+    const std::string filename = entry_filename(folder, key);
+    const std::string tmp      = filename + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+    if (!write_buffer(tmp, buffer)) return false;
+
+    std::filesystem::rename(tmp, filename, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,71 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef SOLVER_CACHE_H
+#define SOLVER_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk cache of solver results, one binary file per mesh and solver
+// configuration, named after the hex key. An entry holds the row of the
+// results table and the solution and ground truth fields of the mesh, so a
+// cache hit restores every output of the solver. Entries are written to a
+// temporary file and renamed, so concurrent writers never expose partial
+// files, and entries of meshes added to a sweep just add files.
+
+typedef struct
+{
+    std::vector<double> errs;           // errS, errInf, errL2, hEmax, condVect
+    std::vector<double> solution;
+    std::vector<double> ground_truth;
+}
+SolverCacheEntry;
+
+// the name of the cache folder, inside the folder of the solved meshes
+extern const char * const SOLVER_CACHE_FOLDER;
+
+// content hash of a solver script (or any file), 0 if it cannot be read
+uint64_t file_fingerprint (const std::string &filename);
+
+// fingerprint of a solver that is not a file (e.g. the native solver and
+// its settings)
+uint64_t string_fingerprint (const std::string &description);
+
+uint64_t solver_cache_key (const uint64_t content_hash, const unsigned int solution_id, const uint64_t solver_fingerprint);
+
+// a missing, truncated or stale entry is a miss (false)
+bool read_solver_cache_entry  (const std::string &folder, const uint64_t key, SolverCacheEntry &entry);
+bool write_solver_cache_entry (const std::string &folder, const uint64_t key, const SolverCacheEntry &entry);
+
+#endif // SOLVER_CACHE_H
@@ -0,0 +1,441 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "vem_poisson_solver.h"
+#include "error_norms.h"
+
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+namespace
+{
+
+typedef Eigen::SparseMatrix<double> SparseMatrix;
+
+const double PI = 3.14159265358979323846;
+
+// Franke term a*exp(q): value and laplacian, from q_x, q_y, q_xx, q_yy
+inline void franke_term (const double a,  const double q,
+                         const double qx, const double qy,
+                         const double qxx, const double qyy,
+                         double &value, double &laplacian)
+{
+    const double t = a * std::exp(q);
+    value     += t;
+    laplacian += t * (qxx + qyy + qx*qx + qy*qy);
+}
+
+void franke (const double x, const double y, double &value, double &laplacian)
+{
+    value = laplacian = 0.0;
+
+    const double x2 = 9.0*x - 2.0, y2 = 9.0*y - 2.0;
+    franke_term( 0.75, -(x2*x2 + y2*y2)/4.0,
+                -4.5*x2, -4.5*y2, -40.5, -40.5, value, laplacian);
+
+    const double x1 = 9.0*x + 1.0, y1 = 9.0*y + 1.0;
+    franke_term( 0.75, -x1*x1/49.0 - y1/10.0,
+                -18.0*x1/49.0, -0.9, -162.0/49.0, 0.0, value, laplacian);
+
+    const double x7 = 9.0*x - 7.0, y3 = 9.0*y - 3.0;
+    franke_term( 0.5, -(x7*x7 + y3*y3)/4.0,
+                -4.5*x7, -4.5*y3, -40.5, -40.5, value, laplacian);
+
+    const double x4 = 9.0*x - 4.0, y7 = 9.0*y - 7.0;
+    franke_term(-0.2, -x4*x4 - y7*y7,
+                -18.0*x4, -18.0*y7, -162.0, -162.0, value, laplacian);
+}
+
+// 2-norm condition number of an SPD matrix: the largest eigenvalue comes
+// from power iterations, the smallest from inverse iterations with the
+// factorization (or solver) already set up for the system
+double condition_number (const SparseMatrix &A,
+                         const std::function<Eigen::VectorXd(const Eigen::VectorXd &)> &solve)
+{
+    const int    max_iters = 200;
+    const double tolerance = 1e-8;
+
+    const Eigen::Index n = A.rows();
+
+    Eigen::VectorXd x0 (n);
+    for (Eigen::Index i=0; i < n; i++)
+        x0(i) = 1.0 + 0.5 * std::sin(static_cast<double>(i+1));
+    x0.normalize();
+
+    Eigen::VectorXd x = x0;
+    double l_max = 0.0;
+
+    for (int it=0; it < max_iters; it++)
+    {
+        Eigen::VectorXd y = A * x;
+        const double l = x.dot(y);
+        x = y.normalized();
+
+        const bool converged = std::fabs(l - l_max) <= tolerance * l;
+        l_max = l;
+        if (converged) break;
+    }
+
+    x = x0;
+    double inv_l_min = 0.0;
+
+    for (int it=0; it < max_iters; it++)
+    {
+        Eigen::VectorXd y = solve(x);
+        const double l = x.dot(y);
+        x = y.normalized();
+
+        const bool converged = std::fabs(l - inv_l_min) <= tolerance * l;
+        inv_l_min = l;
+        if (converged) break;
+    }
+
+    return l_max * inv_l_min;
+}
+
+// eigenvalues of a symmetric positive semi-definite 3x3 matrix are the
+// squared singular values of its factor
+double gram_condition_number (const Eigen::Matrix3d &gram)
+{
+    const Eigen::Vector3d ev = Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d>(gram, Eigen::EigenvaluesOnly).eigenvalues();
+
+    if (ev(0) <= 0.0) return std::numeric_limits<double>::infinity();
+
+    return std::sqrt(ev(2) / ev(0));
+}
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+double vem_exact_solution (const uint solution_id, const double x, const double y)
+{
+    switch (solution_id)
+    {
+        case VEM_CONSTANT_SOLUTION:         return 1.0;
+        case VEM_LINEAR_SOLUTION:           return x + y;
+        case VEM_QUADRATIC_SOLUTION:        return x*x + y*y;
+        case VEM_CUBIC_SOLUTION:            return x*x*x + y*y*y;
+        case VEM_CINF_HOMOGENEOUS_SOLUTION: return std::sin(PI*x) * std::sin(PI*y);
+        case VEM_CINF_SOLUTION:             return std::cos(PI*x) * std::cos(PI*y);
+        case VEM_FRANKE_SOLUTION:
+        {
+            double value, laplacian;
+            franke(x, y, value, laplacian);
+            return value;
+        }
+    }
+
+    std::cerr << "ERROR: unknown solution id " << solution_id << std::endl;
+    return 0.0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+double vem_source_term (const uint solution_id, const double x, const double y)
+{
+    switch (solution_id)
+    {
+        case VEM_CONSTANT_SOLUTION:         return 0.0;
+        case VEM_LINEAR_SOLUTION:           return 0.0;
+        case VEM_QUADRATIC_SOLUTION:        return -4.0;
+        case VEM_CUBIC_SOLUTION:            return -6.0 * (x + y);
+        case VEM_CINF_HOMOGENEOUS_SOLUTION: return 2.0*PI*PI * std::sin(PI*x) * std::sin(PI*y);
+        case VEM_CINF_SOLUTION:             return 2.0*PI*PI * std::cos(PI*x) * std::cos(PI*y);
+        case VEM_FRANKE_SOLUTION:
+        {
+            double value, laplacian;
+            franke(x, y, value, laplacian);
+            return -laplacian;
+        }
+    }
+
+    std::cerr << "ERROR: unknown solution id " << solution_id << std::endl;
+    return 0.0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void vem_local_matrices (const cinolib::Polygonmesh<> &m, const uint pid, VEMLocalMatrices &local)
+{
+    const std::vector<uint> &vids = m.poly_verts_id(pid);
+    const uint n = static_cast<uint>(vids.size());
+
+    // area and centroid (shoelace), any orientation
+    double a2 = 0.0, cx = 0.0, cy = 0.0;
+
+    for (uint i=0; i < n; i++)
+    {
+        const cinolib::vec3d &p = m.vert(vids.at(i));
+        const cinolib::vec3d &q = m.vert(vids.at((i+1)%n));
+
+        const double c = p.x()*q.y() - q.x()*p.y();
+        a2 += c;
+        cx += (p.x() + q.x()) * c;
+        cy += (p.y() + q.y()) * c;
+    }
+
+    const double sign = (a2 < 0.0) ? -1.0 : 1.0;
+
+    local.area = 0.5 * std::fabs(a2);
+    local.xE   = cx / (3.0 * a2);
+    local.yE   = cy / (3.0 * a2);
+
+    local.diameter = 0.0;
+    for (uint i=0; i < n; i++)
+        for (uint j=i+1; j < n; j++)
+        {
+            const double dx = m.vert(vids.at(i)).x() - m.vert(vids.at(j)).x();
+            const double dy = m.vert(vids.at(i)).y() - m.vert(vids.at(j)).y();
+            local.diameter = std::max(local.diameter, std::sqrt(dx*dx + dy*dy));
+        }
+
+    const double h = local.diameter;
+
+    local.D.resize(n, 3);
+    local.B.resize(3, n);
+
+    for (uint i=0; i < n; i++)
+    {
+        const cinolib::vec3d &v    = m.vert(vids.at(i));
+        const cinolib::vec3d &prev = m.vert(vids.at((i+n-1)%n));
+        const cinolib::vec3d &next = m.vert(vids.at((i+1)%n));
+
+        local.D(i,0) = 1.0;
+        local.D(i,1) = (v.x() - local.xE) / h;
+        local.D(i,2) = (v.y() - local.yE) / h;
+
+        // boundary integral of grad(m_a).n phi_i over the two edges at v,
+        // with outward normals (hence the orientation sign)
+        local.B(0,i) = 1.0 / n;
+        local.B(1,i) = sign * (next.y() - prev.y()) / (2.0 * h);
+        local.B(2,i) = sign * (prev.x() - next.x()) / (2.0 * h);
+    }
+
+    local.G       = local.B * local.D;
+    local.Pi_star = local.G.partialPivLu().solve(local.B);
+
+    Eigen::Matrix3d G_tilde = local.G;
+    G_tilde.row(0).setZero();
+
+    const Eigen::MatrixXd I_minus_Pi = Eigen::MatrixXd::Identity(n, n) - local.D * local.Pi_star;
+
+    local.K = local.Pi_star.transpose() * G_tilde * local.Pi_star
+            + I_minus_Pi.transpose() * I_minus_Pi;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void vem_local_condition_numbers (const VEMLocalMatrices &local,
+                                  double                 &cond_G,
+                                  double                 &cond_B,
+                                  double                 &cond_D,
+                                  double                 &cond_K)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+
+    const Eigen::Vector3d sv = Eigen::JacobiSVD<Eigen::Matrix3d>(local.G).singularValues();
+    cond_G = (sv(2) > 0.0) ? sv(0) / sv(2) : inf;
+
+    cond_B = gram_condition_number(local.B * local.B.transpose());
+    cond_D = gram_condition_number(local.D.transpose() * local.D);
+
+    // eigenvalues in increasing order, the first one is the (numerical) zero
+    const Eigen::VectorXd ev = Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(local.K, Eigen::EigenvaluesOnly).eigenvalues();
+    const long n = ev.size();
+
+    cond_K = (n > 1 && ev(1) > 0.0) ? ev(n-1) / ev(1) : inf;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool vem_poisson_solve (const cinolib::Polygonmesh<> &m,
+                        const uint                    solution_id,
+                        const VEMPoissonOptions       &options,
+                        VEMPoissonResult              &result)
+{
+    const uint nv = m.num_verts();
+    const uint np = m.num_polys();
+
+    result = VEMPoissonResult();
+    result.ground_truth.resize(nv);
+
+    for (uint vid=0; vid < nv; vid++)
+        result.ground_truth.at(vid) = vem_exact_solution(solution_id, m.vert(vid).x(), m.vert(vid).y());
+
+    // unknowns are the interior vertices, boundary ones take the exact solution
+    std::vector<int> dof (nv, -1);
+    int n_dofs = 0;
+
+    for (uint vid=0; vid < nv; vid++)
+        if (!m.vert_is_boundary(vid))
+            dof.at(vid) = n_dofs++;
+
+    // each polygon writes its own slots, so the assembly order (and the
+    // floating point sums) are the same whatever the number of threads
+    std::vector<size_t> k_offset (np+1, 0);
+    std::vector<size_t> v_offset (np+1, 0);
+
+    for (uint pid=0; pid < np; pid++)
+    {
+        const size_t n = m.poly_verts_id(pid).size();
+        k_offset.at(pid+1) = k_offset.at(pid) + n*n;
+        v_offset.at(pid+1) = v_offset.at(pid) + n;
+    }
+
+    // unused slots are left as zeros at (0,0), which is a diagonal entry anyway
+    std::vector<Eigen::Triplet<double>> triplets (k_offset.at(np));
+    std::vector<double> rhs_terms (v_offset.at(np), 0.0);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int p=0; p < static_cast<int>(np); p++)
+    {
+        const uint pid = static_cast<uint>(p);
+        const std::vector<uint> &vids = m.poly_verts_id(pid);
+        const uint n = static_cast<uint>(vids.size());
+
+        VEMLocalMatrices local;
+        vem_local_matrices(m, pid, local);
+
+        const double f_E = vem_source_term(solution_id, local.xE, local.yE) * local.area / n;
+
+        for (uint i=0; i < n; i++)
+        {
+            const int row = dof.at(vids.at(i));
+            if (row < 0) continue;
+
+            double b = f_E;
+
+            for (uint j=0; j < n; j++)
+            {
+                const int col = dof.at(vids.at(j));
+
+                if (col >= 0)
+                    triplets.at(k_offset.at(pid) + i*n + j) = Eigen::Triplet<double>(row, col, local.K(i,j));
+                else
+                    b -= local.K(i,j) * result.ground_truth.at(vids.at(j));
+            }
+
+            rhs_terms.at(v_offset.at(pid) + i) = b;
+        }
+    }
+
+    result.solution = result.ground_truth;
+
+    if (n_dofs > 0)
+    {
+        Eigen::VectorXd rhs = Eigen::VectorXd::Zero(n_dofs);
+
+        for (uint pid=0; pid < np; pid++)
+        {
+            const std::vector<uint> &vids = m.poly_verts_id(pid);
+
+            for (uint i=0; i < vids.size(); i++)
+                if (dof.at(vids.at(i)) >= 0)
+                    rhs(dof.at(vids.at(i))) += rhs_terms.at(v_offset.at(pid) + i);
+        }
+
+        SparseMatrix A (n_dofs, n_dofs);
+        A.setFromTriplets(triplets.begin(), triplets.end());
+
+        std::vector<Eigen::Triplet<double>>().swap(triplets);
+        std::vector<double>().swap(rhs_terms);
+
+        Eigen::SimplicialLDLT<SparseMatrix> ldlt;
+        Eigen::ConjugateGradient<SparseMatrix, Eigen::Lower|Eigen::Upper> cg;
+
+        std::function<Eigen::VectorXd(const Eigen::VectorXd &)> solve;
+
+        if (options.linear_solver == VEM_CONJUGATE_GRADIENT)
+        {
+            cg.setTolerance(options.cg_tolerance);
+            if (options.cg_max_iters > 0) cg.setMaxIterations(options.cg_max_iters);
+            cg.compute(A);
+
+            solve = [&cg](const Eigen::VectorXd &b) -> Eigen::VectorXd { return cg.solve(b); };
+        }
+        else
+        {
+            ldlt.compute(A);
+
+            if (ldlt.info() != Eigen::Success)
+            {
+                std::cerr << "ERROR: VEM stiffness matrix factorization failed" << std::endl;
+                return false;
+            }
+
+            solve = [&ldlt](const Eigen::VectorXd &b) -> Eigen::VectorXd { return ldlt.solve(b); };
+        }
+
+        const Eigen::VectorXd u = solve(rhs);
+
+        if (options.linear_solver == VEM_CONJUGATE_GRADIENT)
+        {
+            result.cg_iterations = static_cast<uint>(cg.iterations());
+
+            if (cg.info() != Eigen::Success)
+            {
+                std::cerr << "ERROR: VEM conjugate gradient did not converge in "
+                          << cg.iterations() << " iterations (error " << cg.error() << ")" << std::endl;
+                return false;
+            }
+        }
+
+        for (uint vid=0; vid < nv; vid++)
+            if (dof.at(vid) >= 0)
+                result.solution.at(vid) = u(dof.at(vid));
+
+        if (options.compute_condition_number)
+            result.condVect = condition_number(A, solve);
+    }
+
+    ErrorNorms errs;
+    compute_error_norms(m, result.solution, result.ground_truth,
+                        [solution_id](const double x, const double y) { return vem_exact_solution(solution_id, x, y); },
+                        errs);
+
+    result.errS   = errs.errS;
+    result.errInf = errs.errInf;
+    result.errL2  = errs.errL2;
+    result.hEmax  = errs.hEmax;
+
+    return true;
+}
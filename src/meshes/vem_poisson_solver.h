@@ -0,0 +1,141 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef VEM_POISSON_SOLVER_H
+#define VEM_POISSON_SOLVER_H
+
+#include <cinolib/meshes/meshes.h>
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+// Lowest order (k=1) Virtual Element Method for the Poisson problem
+// -laplacian(u) = f on a 2D polygon mesh, with Dirichlet boundary conditions
+// taken from the exact solution. Local matrices follow "The hitchhiker's
+// guide to the Virtual Element Method" (Beirao da Veiga et al., 2014), with
+// the scaled monomials 1, (x-xE)/hE, (y-yE)/hE and the dofi-dofi
+// stabilization. The load term is f(xE)|E|/n on each vertex of E.
+
+// Exact solutions on [0,1]^2, in the order of the solver widget
+typedef enum
+{
+    VEM_CONSTANT_SOLUTION,          // u = 1
+    VEM_LINEAR_SOLUTION,            // u = x + y
+    VEM_QUADRATIC_SOLUTION,         // u = x^2 + y^2
+    VEM_CUBIC_SOLUTION,             // u = x^3 + y^3
+    VEM_CINF_HOMOGENEOUS_SOLUTION,  // u = sin(pi x) sin(pi y)
+    VEM_CINF_SOLUTION,              // u = cos(pi x) cos(pi y)
+    VEM_FRANKE_SOLUTION             // Franke function
+}
+VEM_SOLUTIONS;
+
+typedef enum
+{
+    VEM_SPARSE_DIRECT,              // sparse Cholesky (LDLT)
+    VEM_CONJUGATE_GRADIENT          // Jacobi preconditioned CG
+}
+VEM_LINEAR_SOLVERS;
+
+typedef struct
+{
+    uint   linear_solver  = VEM_SPARSE_DIRECT;
+    double cg_tolerance   = 1e-12;
+    int    cg_max_iters   = 0;      // 0: Eigen default (twice the system size)
+
+    // 2-norm condition number of the stiffness matrix, estimated with
+    // power and inverse iterations (one extra solve per iteration)
+    bool   compute_condition_number = true;
+}
+VEMPoissonOptions;
+
+// Local matrices of a polygon with n vertices
+typedef struct
+{
+    Eigen::MatrixXd D;              // n x 3, monomials at the vertices
+    Eigen::MatrixXd B;              // 3 x n
+    Eigen::Matrix3d G;              // B * D
+    Eigen::MatrixXd Pi_star;        // 3 x n, G^-1 B: projector in the monomial basis
+    Eigen::MatrixXd K;              // n x n, consistency + stabilization
+
+    double area     = 0.0;
+    double diameter = 0.0;
+    double xE       = 0.0;          // centroid
+    double yE       = 0.0;
+}
+VEMLocalMatrices;
+
+typedef struct
+{
+    std::vector<double> solution;       // u_h at the vertices
+    std::vector<double> ground_truth;   // u at the vertices
+
+    // the columns of the results table: errS, errInf, errL2 and hEmax as in
+    // compute_error_norms (error_norms.h), against the exact solution, and
+    // condVect - condition number of the stiffness matrix
+    double errS     = 0.0;
+    double errInf   = 0.0;
+    double errL2    = 0.0;
+    double hEmax    = 0.0;
+    double condVect = 0.0;
+
+    uint   cg_iterations = 0;
+}
+VEMPoissonResult;
+
+double vem_exact_solution (const uint solution_id, const double x, const double y);
+
+// right hand side f = -laplacian(u)
+double vem_source_term (const uint solution_id, const double x, const double y);
+
+void vem_local_matrices (const cinolib::Polygonmesh<> &m, const uint pid, VEMLocalMatrices &local);
+
+// 2-norm condition numbers of the local matrices, from the singular values
+// of G and of the 3x3 Gram matrices of B and D. The stiffness matrix K has
+// the constants in its kernel, so cond_K is the ratio between its largest
+// and its smallest nonzero eigenvalue. Degenerate polygons give inf.
+void vem_local_condition_numbers (const VEMLocalMatrices &local,
+                                  double                 &cond_G,
+                                  double                 &cond_B,
+                                  double                 &cond_D,
+                                  double                 &cond_K);
+
+// Local matrices are computed in parallel (OpenMP) and assembled in a fixed
+// order, so results do not depend on the number of threads. When called from
+// inside a parallel region the assembly runs on the calling thread.
+// Returns false if the linear solver fails.
+bool vem_poisson_solve (const cinolib::Polygonmesh<> &m,
+                        const uint                    solution_id,
+                        const VEMPoissonOptions       &options,
+                        VEMPoissonResult              &result);
+
+#endif // VEM_POISSON_SOLVER_H
@@ -0,0 +1,145 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "vertex_field_view.h"
+
+#include <algorithm>
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void VertexFieldView::set_geometry(const Polygonmesh<> *m)
+{
+    mesh = m;
+
+    values.clear();
+    colors.clear();
+
+    geometry_changed();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void VertexFieldView::geometry_changed()
+{
+    tris.clear();
+    edges.clear();
+
+    if (mesh == nullptr)
+    {
+        values.clear();
+        colors.clear();
+        return;
+    }
+
+    for (uint pid=0; pid < mesh->num_polys(); pid++)
+    {
+        const std::vector<uint> &tess = mesh->poly_tessellation(pid);
+        tris.insert(tris.end(), tess.begin(), tess.end());
+    }
+
+    edges.resize(2 * static_cast<size_t>(mesh->num_edges()));
+
+    for (uint eid=0; eid < mesh->num_edges(); eid++)
+    {
+        edges.at(2*eid)   = mesh->edge_vert_id(eid, 0);
+        edges.at(2*eid+1) = mesh->edge_vert_id(eid, 1);
+    }
+
+    field_scene_bounds(*mesh, center, radius);
+
+    if (values.size() != mesh->num_verts())
+    {
+        values.assign(mesh->num_verts(), 0.0);
+        colors.assign(3 * static_cast<size_t>(mesh->num_verts()), 255);
+    }
+
+    geometry_dirty = true;
+    colors_dirty   = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void VertexFieldView::set_field(const std::vector<double> &values, const std::vector<Color> &colors)
+{
+    if (mesh == nullptr) return;
+
+    const size_t n_verts = mesh->num_verts();
+
+    this->values = values;
+    this->values.resize(n_verts, 0.0);
+
+    const size_t n_colors = std::min(n_verts, colors.size());
+
+    for (size_t vid=0; vid < n_colors; vid++)
+        color_to_rgb8(colors.at(vid), this->colors.data() + 3*vid);
+
+    colors_dirty = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void VertexFieldView::draw(const float) const
+{
+    if (mesh == nullptr || tris.empty()) return;
+
+    // the mesh has been edited and geometry_changed was not called: the
+    // indices are not valid
+    if (mesh->num_verts() != values.size()) return;
+
+    if (geometry_dirty)
+    {
+        // the positions are converted on the fly, the mesh keeps the only CPU copy
+        std::vector<float> coords (3 * static_cast<size_t>(mesh->num_verts()));
+
+        for (uint vid=0; vid < mesh->num_verts(); vid++)
+        {
+            const vec3d &p = mesh->vert(vid);
+            coords.at(3*vid)   = static_cast<float>(p.x());
+            coords.at(3*vid+1) = static_cast<float>(p.y());
+            coords.at(3*vid+2) = static_cast<float>(p.z());
+        }
+
+        buffers.upload_coords(coords);
+        buffers.upload_tris(tris);
+        buffers.upload_edges(edges);
+
+        geometry_dirty = false;
+    }
+
+    if (colors_dirty)
+    {
+        buffers.upload_colors(colors);
+        colors_dirty = false;
+    }
+
+    buffers.draw();
+}
@@ -0,0 +1,104 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef VERTEX_FIELD_VIEW_H
+#define VERTEX_FIELD_VIEW_H
+
+#include "color_field_buffers.h"
+
+#include <cinolib/drawable_object.h>
+#include <cinolib/meshes/polygonmesh.h>
+
+#include <vector>
+
+using namespace cinolib;
+
+// Per vertex scalar field drawn on the geometry of another mesh, with the
+// mesh edges on top. Vertex positions are read from the mesh, which is not
+// copied: it must outlive the view, and the view must be told when the mesh
+// is edited (geometry_changed), otherwise it stops drawing. The view only
+// owns the triangle and edge indices, the values and their colors, so that
+// several fields (e.g. a solution and its ground truth) can be shown on the
+// same mesh at a fraction of the memory of a copy. Changing the field
+// re-uploads the color buffer only.
+//
+// GPU buffers are created in draw(), in the context of the canvas; the
+// object must be deleted with that context current.
+
+class VertexFieldView : public DrawableObject
+{
+    public:
+
+        VertexFieldView() {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // triangulates the polygons of m and lists its edges. The field is
+        // reset to white
+        void set_geometry(const Polygonmesh<> *m);
+
+        // the mesh has been edited (moved vertices, or new connectivity): the
+        // geometry is uploaded again on the next draw. The field is kept if
+        // the number of vertices did not change, reset to white otherwise
+        void geometry_changed();
+
+        // one value and one color per vertex of the mesh
+        void set_field(const std::vector<double> &values, const std::vector<Color> &colors);
+
+        const Polygonmesh<>       * geometry()     const { return mesh; }
+        const std::vector<double> & field_values() const { return values; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        ObjectType object_type()  const { return DRAWABLE_POLYGONMESH; }
+        void       draw(const float scene_size=1) const;
+        vec3d      scene_center() const { return center; }
+        float      scene_radius() const { return radius; }
+
+    private:
+
+        const Polygonmesh<> *mesh = nullptr;
+
+        std::vector<uint>          tris;    // 3 vertex ids per triangle
+        std::vector<uint>          edges;   // 2 vertex ids per edge
+        std::vector<double>        values;  // one per vertex
+        std::vector<unsigned char> colors;  // one per vertex, rgb
+
+        vec3d center;
+        float radius = 0.f;
+
+        mutable ColorFieldBuffers buffers;
+        mutable bool              geometry_dirty = true;
+        mutable bool              colors_dirty   = true;
+};
+
+#endif // VERTEX_FIELD_VIEW_H
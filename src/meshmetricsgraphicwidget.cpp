@@ -35,6 +35,8 @@
 
 #include "quality_metrics.h"
 
+#include <algorithm>
+
 MeshMetricsGraphicWidget::MeshMetricsGraphicWidget(QWidget *parent) :
     QWidget(parent),
     ui(new Ui::MeshMetricsGraphicWidget)
@@ -58,11 +60,14 @@ MeshMetricsGraphicWidget::MeshMetricsGraphicWidget(QWidget *parent) :
     connect(ui->sr_rb, SIGNAL(clicked()), this, SLOT(show_sr()));
     connect(ui->vem_rb, SIGNAL(clicked()), this, SLOT(show_vem()));
     connect(ui->vema_rb, SIGNAL(clicked()), this, SLOT(show_vema()));
+    connect(ui->vpc_rb, SIGNAL(clicked()), this, SLOT(show_vpc()));
+    connect(ui->vsc_rb, SIGNAL(clicked()), this, SLOT(show_vsc()));
 
     connect(ui->min_rb, SIGNAL(clicked()), this, SLOT(show_min()));
     connect(ui->max_rb, SIGNAL(clicked()), this, SLOT(show_max()));
     connect(ui->avg_rb, SIGNAL(clicked()), this, SLOT(show_avg()));
     connect(ui->poly_rb, SIGNAL(clicked()), this, SLOT(show_poly()));
+    connect(ui->heatmap_rb, SIGNAL(clicked()), this, SLOT(show_heatmap()));
 
     ui->ic_rb->setText((metrics_acronym.at(0) + " - " + metrics_names.at(0)).c_str());
     ui->cc_rb->setText((metrics_acronym.at(1) + " - " + metrics_names.at(1)).c_str());
@@ -80,18 +85,30 @@ MeshMetricsGraphicWidget::MeshMetricsGraphicWidget(QWidget *parent) :
     ui->sr_rb->setText((metrics_acronym.at(13) + " - " + metrics_names.at(13)).c_str());
     ui->vem_rb->setText((metrics_acronym.at(14) + " - " + metrics_names.at(14)).c_str());
     ui->vema_rb->setText((metrics_acronym.at(15) + " - " + metrics_names.at(15)).c_str());
+    ui->vpc_rb->setText((metrics_acronym.at(16) + " - " + metrics_names.at(16)).c_str());
+    ui->vsc_rb->setText((metrics_acronym.at(17) + " - " + metrics_names.at(17)).c_str());
 
 }
 
 MeshMetricsGraphicWidget::~MeshMetricsGraphicWidget()
 {
+    clear_heatmaps();
     delete ui;
 }
 
 void MeshMetricsGraphicWidget::clean_canvas()
 {
+    if (shown_heatmap != nullptr)
+    {
+        ui->mesh_metrics_canvas->pop(shown_heatmap);
+        shown_heatmap = nullptr;
+    }
+
     for (const cinolib::DrawablePolygonmesh<> * p : mesh_with_metrics)
+    {
         ui->mesh_metrics_canvas->pop(p);
+        if (d != nullptr) d->unpin_parametric_mesh(p);
+    }
 
     mesh_with_metrics.clear();
 }
@@ -102,16 +119,27 @@ void MeshMetricsGraphicWidget::show_mesh (int i)
 
     clean_canvas();
 
-    d->get_parametric_mesh(static_cast<uint>(i))->updateGL();
-    ui->mesh_metrics_canvas->push_obj(d->get_parametric_mesh(static_cast<uint>(i)), update_scene);
-    ui->mesh_metrics_canvas->updateGL();
-
-    update_scene=false;
+    cinolib::DrawablePolygonmesh<> *m = d->pin_parametric_mesh(static_cast<uint>(i));
 
-    mesh_with_metrics.push_back(d->get_parametric_mesh(static_cast<uint>(i)));
+    mesh_with_metrics.push_back(m);
 
     curr_mesh_id = static_cast<uint>(i);
 
+    // the heatmap is drawn instead of the mesh, whose render data are not
+    // needed
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
+    m->show_poly_color();
+    m->updateGL();
+    ui->mesh_metrics_canvas->push_obj(m, update_scene);
+    ui->mesh_metrics_canvas->updateGL();
+
+    update_scene=false;
+
     if (ui->min_rb->isChecked()) show_min();
     else if (ui->max_rb->isChecked()) show_max();
     else if (ui->avg_rb->isChecked()) show_avg();
@@ -127,6 +155,9 @@ void MeshMetricsGraphicWidget::set_dataset(Dataset *ds)
 
 void MeshMetricsGraphicWidget::set_metrics (std::vector<MeshMetrics> *m)
 {
+    // metrics are recomputed when the dataset changes
+    clear_heatmaps();
+
     metrics = m;
 }
 
@@ -150,6 +181,12 @@ void MeshMetricsGraphicWidget::set_max_color(const uint i)
 
 void MeshMetricsGraphicWidget::show_ic()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -196,6 +233,12 @@ void MeshMetricsGraphicWidget::show_ic()
 
 void MeshMetricsGraphicWidget::show_cc()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -242,6 +285,12 @@ void MeshMetricsGraphicWidget::show_cc()
 
 void MeshMetricsGraphicWidget::show_cr()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -287,6 +336,12 @@ void MeshMetricsGraphicWidget::show_cr()
 
 void MeshMetricsGraphicWidget::show_ar ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -332,6 +387,12 @@ void MeshMetricsGraphicWidget::show_ar ()
 
 void MeshMetricsGraphicWidget::show_ke ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -377,6 +438,12 @@ void MeshMetricsGraphicWidget::show_ke ()
 
 void MeshMetricsGraphicWidget::show_kar ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -422,6 +489,12 @@ void MeshMetricsGraphicWidget::show_kar ()
 
 void MeshMetricsGraphicWidget::show_par ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -467,6 +540,12 @@ void MeshMetricsGraphicWidget::show_par ()
 
 void MeshMetricsGraphicWidget::show_ma ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -512,6 +591,12 @@ void MeshMetricsGraphicWidget::show_ma ()
 
 void MeshMetricsGraphicWidget::show_se ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -557,6 +642,12 @@ void MeshMetricsGraphicWidget::show_se ()
 
 void MeshMetricsGraphicWidget::show_er ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -602,6 +693,12 @@ void MeshMetricsGraphicWidget::show_er ()
 
 void MeshMetricsGraphicWidget::show_mpd ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -647,6 +744,12 @@ void MeshMetricsGraphicWidget::show_mpd ()
 
 void MeshMetricsGraphicWidget::show_ns ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -692,6 +795,12 @@ void MeshMetricsGraphicWidget::show_ns ()
 
 void MeshMetricsGraphicWidget::show_mxa ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -737,6 +846,12 @@ void MeshMetricsGraphicWidget::show_mxa ()
 
 void MeshMetricsGraphicWidget::show_sr ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -782,6 +897,12 @@ void MeshMetricsGraphicWidget::show_sr ()
 
 void MeshMetricsGraphicWidget::show_vem ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -827,6 +948,12 @@ void MeshMetricsGraphicWidget::show_vem ()
 
 void MeshMetricsGraphicWidget::show_vema ()
 {
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     std::string message = "";
@@ -872,9 +999,113 @@ void MeshMetricsGraphicWidget::show_vema ()
     ui->info_text->setHtml(message.c_str());
 }
 
+void MeshMetricsGraphicWidget::show_vpc ()
+{
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
+    mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
+
+    std::string message = "";
+
+    uint id_min = metrics->at(curr_mesh_id).VPC_min_id;
+    uint id_max = metrics->at(curr_mesh_id).VPC_max_id;
+
+    if (ui->min_rb->isChecked() || ui->avg_rb->isChecked())
+    {
+        set_min_color(id_min);
+        message += "<br><font color=\"green\">VPC MIN : " + std::to_string(metrics->at(curr_mesh_id).VPC_min) + "</font>";
+    }
+
+    if (ui->max_rb->isChecked() || ui->avg_rb->isChecked())
+    {
+        set_max_color(id_max);
+        message += "<br><font color=\"blue\">VPC MAX : " + std::to_string(metrics->at(curr_mesh_id).VPC_max)+ "</font>";
+    }
+
+    if (ui->avg_rb->isChecked())
+    {
+        message += "<br>VPC AVG : " + std::to_string(metrics->at(curr_mesh_id).VPC_avg);
+    }
+
+    if (ui->poly_rb->isChecked())
+    {
+        id_min = metrics->at(curr_mesh_id).VPC_poly_min_id;
+        id_max = metrics->at(curr_mesh_id).VPC_poly_max_id;
+
+        set_min_color(id_min);
+        set_max_color(id_max);
+
+        message += "<br><font color=\"green\">VPC POLY MIN : " + std::to_string(metrics->at(curr_mesh_id).VPC_poly_min) + "</font>";
+        message += "<br><font color=\"blue\">VPC POLY MAX : " + std::to_string(metrics->at(curr_mesh_id).VPC_poly_max) + "</font>";
+        message += "<br>VPC POLY AVG : " + std::to_string(metrics->at(curr_mesh_id).VPC_poly_avg);
+    }
+
+    d->get_parametric_mesh(static_cast<uint>(curr_mesh_id))->updateGL();
+    ui->mesh_metrics_canvas->updateGL();
+
+    ui->info_text->setHtml(message.c_str());
+}
+
+void MeshMetricsGraphicWidget::show_vsc ()
+{
+    if (ui->heatmap_rb->isChecked())
+    {
+        show_heatmap();
+        return;
+    }
+
+    mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
+
+    std::string message = "";
+
+    uint id_min = metrics->at(curr_mesh_id).VSC_min_id;
+    uint id_max = metrics->at(curr_mesh_id).VSC_max_id;
+
+    if (ui->min_rb->isChecked() || ui->avg_rb->isChecked())
+    {
+        set_min_color(id_min);
+        message += "<br><font color=\"green\">VSC MIN : " + std::to_string(metrics->at(curr_mesh_id).VSC_min) + "</font>";
+    }
+
+    if (ui->max_rb->isChecked() || ui->avg_rb->isChecked())
+    {
+        set_max_color(id_max);
+        message += "<br><font color=\"blue\">VSC MAX : " + std::to_string(metrics->at(curr_mesh_id).VSC_max)+ "</font>";
+    }
+
+    if (ui->avg_rb->isChecked())
+    {
+        message += "<br>VSC AVG : " + std::to_string(metrics->at(curr_mesh_id).VSC_avg);
+    }
+
+    if (ui->poly_rb->isChecked())
+    {
+        id_min = metrics->at(curr_mesh_id).VSC_poly_min_id;
+        id_max = metrics->at(curr_mesh_id).VSC_poly_max_id;
+
+        set_min_color(id_min);
+        set_max_color(id_max);
+
+        message += "<br><font color=\"green\">VSC POLY MIN : " + std::to_string(metrics->at(curr_mesh_id).VSC_poly_min) + "</font>";
+        message += "<br><font color=\"blue\">VSC POLY MAX : " + std::to_string(metrics->at(curr_mesh_id).VSC_poly_max) + "</font>";
+        message += "<br>VSC POLY AVG : " + std::to_string(metrics->at(curr_mesh_id).VSC_poly_avg);
+    }
+
+    d->get_parametric_mesh(static_cast<uint>(curr_mesh_id))->updateGL();
+    ui->mesh_metrics_canvas->updateGL();
+
+    ui->info_text->setHtml(message.c_str());
+}
+
 
 void MeshMetricsGraphicWidget::show_min()
 {
+    hide_heatmap();
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     uint id;
@@ -976,6 +1207,18 @@ void MeshMetricsGraphicWidget::show_min()
         message = "VEMA MIN : " + std::to_string(metrics->at(curr_mesh_id).VEMA_min);
     }
     else
+    if (ui->vpc_rb->isChecked())
+    {
+        id = metrics->at(curr_mesh_id).VPC_min_id;
+        message = "VPC MIN : " + std::to_string(metrics->at(curr_mesh_id).VPC_min);
+    }
+    else
+    if (ui->vsc_rb->isChecked())
+    {
+        id = metrics->at(curr_mesh_id).VSC_min_id;
+        message = "VSC MIN : " + std::to_string(metrics->at(curr_mesh_id).VSC_min);
+    }
+    else
     {
         return;
     }
@@ -992,6 +1235,8 @@ void MeshMetricsGraphicWidget::show_min()
 
 void MeshMetricsGraphicWidget::show_max()
 {
+    hide_heatmap();
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     uint id;
@@ -1093,6 +1338,18 @@ void MeshMetricsGraphicWidget::show_max()
         message = "VEMA MAX : " + std::to_string(metrics->at(curr_mesh_id).VEMA_max);
     }
     else
+    if (ui->vpc_rb->isChecked())
+    {
+        id = metrics->at(curr_mesh_id).VPC_max_id;
+        message = "VPC MAX : " + std::to_string(metrics->at(curr_mesh_id).VPC_max);
+    }
+    else
+    if (ui->vsc_rb->isChecked())
+    {
+        id = metrics->at(curr_mesh_id).VSC_max_id;
+        message = "VSC MAX : " + std::to_string(metrics->at(curr_mesh_id).VSC_max);
+    }
+    else
     {
         return;
     }
@@ -1109,6 +1366,8 @@ void MeshMetricsGraphicWidget::show_max()
 
 void MeshMetricsGraphicWidget::show_avg()
 {
+    hide_heatmap();
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     uint id_min, id_max;
@@ -1260,6 +1519,24 @@ void MeshMetricsGraphicWidget::show_avg()
         message += "<br>VEMA : " + std::to_string(VEMA);
     }
     else
+    if (ui->vpc_rb->isChecked())
+    {
+        id_min = metrics->at(curr_mesh_id).VPC_min_id;
+        id_max = metrics->at(curr_mesh_id).VPC_max_id;
+        message += "<br><font color=\"green\">VPC MIN : " + std::to_string(metrics->at(curr_mesh_id).VPC_min) + "</font>";
+        message += "<br><font color=\"blue\">VPC MAX : " + std::to_string(metrics->at(curr_mesh_id).VPC_max) + "</font>";
+        message += "<br>VPC AVG : " + std::to_string(metrics->at(curr_mesh_id).VPC_avg);
+    }
+    else
+    if (ui->vsc_rb->isChecked())
+    {
+        id_min = metrics->at(curr_mesh_id).VSC_min_id;
+        id_max = metrics->at(curr_mesh_id).VSC_max_id;
+        message += "<br><font color=\"green\">VSC MIN : " + std::to_string(metrics->at(curr_mesh_id).VSC_min) + "</font>";
+        message += "<br><font color=\"blue\">VSC MAX : " + std::to_string(metrics->at(curr_mesh_id).VSC_max) + "</font>";
+        message += "<br>VSC AVG : " + std::to_string(metrics->at(curr_mesh_id).VSC_avg);
+    }
+    else
     {
         return;
     }
@@ -1275,6 +1552,8 @@ void MeshMetricsGraphicWidget::show_avg()
 
 void MeshMetricsGraphicWidget::show_poly()
 {
+    hide_heatmap();
+
     mesh_with_metrics.at(0)->poly_set_color(cinolib::Color::WHITE());
 
     uint id_min, id_max;
@@ -1426,6 +1705,24 @@ void MeshMetricsGraphicWidget::show_poly()
         message += "<br>VEMA : " + std::to_string(VEMA);
     }
     else
+    if (ui->vpc_rb->isChecked())
+    {
+        id_min = metrics->at(curr_mesh_id).VPC_poly_min_id;
+        id_max = metrics->at(curr_mesh_id).VPC_poly_max_id;
+        message += "<br><font color=\"green\">VPC POLY MIN : " + std::to_string(metrics->at(curr_mesh_id).VPC_poly_min) + "</font>";
+        message += "<br><font color=\"blue\">VPC POLY MAX : " + std::to_string(metrics->at(curr_mesh_id).VPC_poly_max) + "</font>";
+        message += "<br>VPC AVG : " + std::to_string(metrics->at(curr_mesh_id).VPC_poly_avg);
+    }
+    else
+    if (ui->vsc_rb->isChecked())
+    {
+        id_min = metrics->at(curr_mesh_id).VSC_poly_min_id;
+        id_max = metrics->at(curr_mesh_id).VSC_poly_max_id;
+        message += "<br><font color=\"green\">VSC POLY MIN : " + std::to_string(metrics->at(curr_mesh_id).VSC_poly_min) + "</font>";
+        message += "<br><font color=\"blue\">VSC POLY MAX : " + std::to_string(metrics->at(curr_mesh_id).VSC_poly_max) + "</font>";
+        message += "<br>VSC AVG : " + std::to_string(metrics->at(curr_mesh_id).VSC_poly_avg);
+    }
+    else
     {
         return;
     }
@@ -1440,6 +1737,149 @@ void MeshMetricsGraphicWidget::show_poly()
     ui->info_text->setHtml(message.c_str());
 }
 
+void MeshMetricsGraphicWidget::show_heatmap()
+{
+    if (mesh_with_metrics.empty()) return;
+
+    const int metric_id = checked_metric_id();
+
+    if (metric_id < 0) return;
+
+    HeatmapEntry &entry = heatmap_entry(curr_mesh_id);
+
+    std::vector<double> values (entry.poly_metrics.size());
+
+    for (uint pid=0; pid < entry.poly_metrics.size(); pid++)
+        values.at(pid) = poly_metric_value(entry.poly_metrics.at(pid), static_cast<uint>(metric_id));
+
+    // as in the scatter plots, metrics from SR on span several orders of
+    // magnitude and are mapped on a log scale
+    entry.heatmap->set_poly_values(values, metric_id >= 13);
+
+    if (shown_heatmap != entry.heatmap)
+    {
+        if (shown_heatmap != nullptr)
+            ui->mesh_metrics_canvas->pop(shown_heatmap);
+        else
+            ui->mesh_metrics_canvas->pop(mesh_with_metrics.at(0));
+
+        ui->mesh_metrics_canvas->push_obj(entry.heatmap, update_scene);
+        shown_heatmap = entry.heatmap;
+
+        update_scene=false;
+    }
+
+    ui->mesh_metrics_canvas->updateGL();
+
+    double min =  cinolib::max_double;
+    double max = -cinolib::max_double;
+
+    for (const double v : values)
+    {
+        min = std::min(min, v);
+        max = std::max(max, v);
+    }
+
+    const std::string acronym = metrics_acronym.at(static_cast<uint>(metric_id));
+
+    std::string message = "";
+    message += "<br><font color=\"red\">" + acronym + " POLY MIN : " + std::to_string(min) + "</font>";
+    message += "<br><font color=\"blue\">" + acronym + " POLY MAX : " + std::to_string(max) + "</font>";
+
+    if (metric_id >= 13)
+        message += "<br>(log scale)";
+
+    ui->info_text->setHtml(message.c_str());
+}
+
+MeshMetricsGraphicWidget::HeatmapEntry & MeshMetricsGraphicWidget::heatmap_entry(const uint mesh_id)
+{
+    for (auto it = heatmaps.begin(); it != heatmaps.end(); ++it)
+    {
+        if (it->mesh_id == mesh_id)
+        {
+            heatmaps.splice(heatmaps.begin(), heatmaps, it);
+            return heatmaps.front();
+        }
+    }
+
+    const cinolib::DrawablePolygonmesh<> *m = mesh_with_metrics.at(0);
+
+    HeatmapEntry entry;
+    entry.mesh_id = mesh_id;
+    entry.heatmap = new PolygonHeatmap();
+    entry.heatmap->set_geometry(*m);
+    entry.poly_metrics.resize(m->num_polys());
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int pid=0; pid < static_cast<int>(m->num_polys()); pid++)
+        compute_poly_metrics(*m, static_cast<uint>(pid), entry.poly_metrics.at(static_cast<uint>(pid)));
+
+    heatmaps.push_front(entry);
+
+    // GPU buffers are released in the context of the canvas
+    while (heatmaps.size() > max_heatmaps)
+    {
+        if (heatmaps.back().heatmap == shown_heatmap)
+            break;
+
+        ui->mesh_metrics_canvas->makeCurrent();
+        delete heatmaps.back().heatmap;
+        heatmaps.pop_back();
+    }
+
+    return heatmaps.front();
+}
+
+void MeshMetricsGraphicWidget::hide_heatmap()
+{
+    if (shown_heatmap == nullptr) return;
+
+    ui->mesh_metrics_canvas->pop(shown_heatmap);
+    shown_heatmap = nullptr;
+
+    if (!mesh_with_metrics.empty())
+    {
+        mesh_with_metrics.at(0)->show_poly_color();
+        ui->mesh_metrics_canvas->push_obj(mesh_with_metrics.at(0), update_scene);
+        update_scene=false;
+    }
+}
+
+void MeshMetricsGraphicWidget::clear_heatmaps()
+{
+    if (shown_heatmap != nullptr)
+    {
+        ui->mesh_metrics_canvas->pop(shown_heatmap);
+        shown_heatmap = nullptr;
+    }
+
+    if (heatmaps.empty()) return;
+
+    ui->mesh_metrics_canvas->makeCurrent();
+
+    for (HeatmapEntry &entry : heatmaps)
+        delete entry.heatmap;
+
+    heatmaps.clear();
+}
+
+int MeshMetricsGraphicWidget::checked_metric_id() const
+{
+    const std::vector<const QRadioButton *> buttons =
+    {
+        ui->ic_rb, ui->cc_rb, ui->cr_rb, ui->ar_rb, ui->ke_rb, ui->kar_rb,
+        ui->par_rb, ui->ma_rb, ui->se_rb, ui->er_rb, ui->mpd_rb, ui->ns_rb,
+        ui->mxa_rb, ui->sr_rb, ui->vem_rb, ui->vema_rb, ui->vpc_rb, ui->vsc_rb
+    };
+
+    for (uint i=0; i < buttons.size(); i++)
+        if (buttons.at(i)->isChecked())
+            return static_cast<int>(i);
+
+    return -1;
+}
+
 void MeshMetricsGraphicWidget::set_slider_max(const uint max)
 {
     ui->mesh_metrics_slider->setMaximum(static_cast<int>(max));
@@ -34,11 +34,15 @@
 #define MESHMETRICSGRAPHICWIDGET_H
 
 #include "dataset.h"
+#include "meshes/mesh_metrics.h"
+#include "meshes/polygon_heatmap.h"
 
 #include <cinolib/meshes/drawable_polygonmesh.h>
 
 #include <QWidget>
 
+#include <list>
+
 namespace Ui {
 class MeshMetricsGraphicWidget;
 }
@@ -78,12 +82,15 @@ public slots:
     void show_sr ();
     void show_vem ();
     void show_vema ();
+    void show_vpc ();
+    void show_vsc ();
 
 
     void show_min ();
     void show_max ();
     void show_avg ();
     void show_poly ();
+    void show_heatmap ();
 
 private slots:
     void on_mesh_metrics_slider_valueChanged(int value);
@@ -103,6 +110,28 @@ private:
     void set_min_color (const uint i);
     void set_max_color (const uint i);
 
+    // heatmaps of the last meshes shown, with the metrics of their polygons:
+    // switching metric only changes the colors of the heatmap
+    typedef struct
+    {
+        uint                     mesh_id;
+        PolygonHeatmap          *heatmap;
+        std::vector<PolyMetrics> poly_metrics;
+    }
+    HeatmapEntry;
+
+    std::list<HeatmapEntry> heatmaps;    // most recently used first
+    const uint max_heatmaps = 4;
+
+    PolygonHeatmap *shown_heatmap = nullptr;
+
+    HeatmapEntry & heatmap_entry (const uint mesh_id);
+    void hide_heatmap ();
+    void clear_heatmaps ();
+
+    // index in metrics_names of the checked metric
+    int checked_metric_id () const;
+
 };
 
 #endif // MESHMETRICSGRAPHICWIDGET_H
@@ -251,15 +251,15 @@ void MeshMetricsWidget::on_save_txt_btn_clicked()
 
     if (dir.isNull()) return;
 
-    for (uint i=0; i < dataset->get_parametric_meshes().size(); i++)
+    for (uint i=0; i < dataset->get_num_parametric_meshes(); i++)
     {
         std::string filename ;
 
-        std::cout << dataset->get_parametric_mesh(i)->mesh_data().filename << std::endl;
+        std::cout << dataset->get_parametric_mesh_filename(i) << std::endl;
 
         if (dataset->is_on_disk())
         {
-            std::string fn = dataset->get_parametric_mesh(i)->mesh_data().filename;
+            std::string fn = dataset->get_parametric_mesh_filename(i);
             std::string fname = fn.substr(fn.find_last_of(QDir::separator().toLatin1()) +1);
 
             std::cout << fname << std::endl;
@@ -274,7 +274,7 @@ void MeshMetricsWidget::on_save_txt_btn_clicked()
         else
         {           
             std::stringstream ss;
-            ss << std::setw((dataset->get_parametric_meshes().size() / 10) + 1)
+            ss << std::setw((dataset->get_num_parametric_meshes() / 10) + 1)
                << std::setfill('0') << i;
             std::string s = ss.str();
 
@@ -0,0 +1,179 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "meshprefetcher.h"
+
+#include "dataset.h"
+
+MeshPrefetcher::MeshPrefetcher(QObject *parent, const uint radius) :
+    QObject(parent),
+    radius(radius)
+{
+    // a zero interval timer fires once the pending events have been processed
+    idle_timer.setSingleShot(true);
+    idle_timer.setInterval(0);
+
+    connect(&idle_timer, SIGNAL(timeout()), this, SLOT(prefetch_next()));
+}
+
+void MeshPrefetcher::set_jobs(Prepare prepare, Release release)
+{
+    invalidate();
+
+    this->prepare = prepare;
+    this->release = release;
+}
+
+void MeshPrefetcher::set_dataset(Dataset *d)
+{
+    invalidate();
+
+    dataset = d;
+}
+
+void MeshPrefetcher::set_current(const uint i, const uint n)
+{
+    // a different dataset
+    if (n != num_meshes)
+    {
+        invalidate();
+        num_meshes = n;
+    }
+
+    if (i != current)
+        direction = (i > current) ? 1 : -1;
+
+    current = i;
+    active  = true;
+
+    for (auto it = prepared.begin(); it != prepared.end(); )
+    {
+        if (in_window(it->first))
+        {
+            ++it;
+            continue;
+        }
+
+        release_mesh(it->second);
+        it = prepared.erase(it);
+    }
+
+    if (prepare) idle_timer.start();
+}
+
+cinolib::DrawablePolygonmesh<> * MeshPrefetcher::take(const uint i)
+{
+    auto it = prepared.find(i);
+    if (it == prepared.end()) return nullptr;
+
+    cinolib::DrawablePolygonmesh<> *m = it->second;
+    prepared.erase(it);
+
+    // another tab has switched its color mode meanwhile
+    if (m != nullptr && (dataset == nullptr || dataset->get_render_owner(m) != this))
+    {
+        release_mesh(m);
+        return nullptr;
+    }
+
+    return m;
+}
+
+void MeshPrefetcher::put(const uint i, cinolib::DrawablePolygonmesh<> *m)
+{
+    if (m == nullptr) return;
+
+    if (!active || !in_window(i) || prepared.count(i) > 0)
+    {
+        release_mesh(m);
+        return;
+    }
+
+    prepared[i] = m;
+    if (dataset != nullptr) dataset->set_render_owner(m, this);
+}
+
+void MeshPrefetcher::invalidate()
+{
+    idle_timer.stop();
+    active = false;
+
+    for (auto &p : prepared)
+        release_mesh(p.second);
+
+    prepared.clear();
+}
+
+void MeshPrefetcher::prefetch_next()
+{
+    if (!active || !prepare) return;
+
+    // current+d, current-d, ... along the last move first
+    for (uint d=1; d <= radius; d++)
+    {
+        const long candidates[2] = { static_cast<long>(current) + direction * static_cast<long>(d),
+                                     static_cast<long>(current) - direction * static_cast<long>(d) };
+
+        for (const long c : candidates)
+        {
+            if (c < 0 || c >= static_cast<long>(num_meshes)) continue;
+
+            const uint i = static_cast<uint>(c);
+            if (prepared.count(i) > 0) continue;
+
+            // a mesh that cannot be prepared is stored as nullptr, so that
+            // it is not tried again
+            prepared[i] = prepare(i);
+            if (prepared[i] != nullptr && dataset != nullptr) dataset->set_render_owner(prepared[i], this);
+
+            // one mesh per pass, to keep the slider responsive
+            idle_timer.start();
+            return;
+        }
+    }
+}
+
+bool MeshPrefetcher::in_window(const uint i) const
+{
+    const uint d = (i > current) ? i - current : current - i;
+    return d > 0 && d <= radius && i < num_meshes;
+}
+
+void MeshPrefetcher::release_mesh(cinolib::DrawablePolygonmesh<> *m)
+{
+    if (m == nullptr) return;
+
+    // once released, it may be drawn in another color mode
+    if (dataset != nullptr && dataset->get_render_owner(m) == this) dataset->set_render_owner(m, nullptr);
+
+    if (release) release(m);
+}
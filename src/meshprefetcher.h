@@ -0,0 +1,115 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef MESHPREFETCHER_H
+#define MESHPREFETCHER_H
+
+#include <cinolib/meshes/drawable_polygonmesh.h>
+
+#include <QObject>
+#include <QTimer>
+
+#include <functional>
+#include <map>
+
+class Dataset;
+
+// Prepares, while the GUI is idle, the meshes next to the one shown by a
+// slider: they are loaded, pinned and their render data are built, so that
+// moving the slider by a few steps only swaps the objects on the canvas.
+// Preparing and releasing a mesh are up to the owner (e.g. pin it, set its
+// color mode and call updateGL, then unpin it). One mesh is prepared per
+// idle pass, the nearest ones first and along the last move first.
+// Meshes are shared by the tabs, each with its own color mode: a prefetched
+// mesh whose render data have been rebuilt since (by another prefetcher, or
+// by anyone resetting its render owner in the dataset) is not handed out,
+// but prepared again. GUI thread only.
+class MeshPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    typedef std::function<cinolib::DrawablePolygonmesh<> *(const uint)> Prepare;
+    typedef std::function<void(cinolib::DrawablePolygonmesh<> *)>       Release;
+
+    explicit MeshPrefetcher (QObject *parent = nullptr, const uint radius = 3);
+
+    void set_jobs (Prepare prepare, Release release = nullptr);
+
+    // the dataset of the meshes, which records who built their render data
+    void set_dataset (Dataset *d);
+
+    // the mesh shown now, out of n: prepared meshes farther than radius are
+    // released and the missing neighbors are scheduled
+    void set_current (const uint i, const uint n);
+
+    // the prepared mesh i, or nullptr (also if its render data are no longer
+    // the ones built by prepare). The caller takes it over, together with
+    // whatever prepare acquired (e.g. its pin)
+    cinolib::DrawablePolygonmesh<> * take (const uint i);
+
+    // hands back mesh i, with render data in the mode of the owner, when it
+    // leaves the canvas: it is kept if it is still next to the current one
+    void put (const uint i, cinolib::DrawablePolygonmesh<> *m);
+
+    // releases every prepared mesh, whose render data are no longer valid
+    // (the meshes have been edited or their color mode has been changed),
+    // and stops prefetching until the next set_current
+    void invalidate ();
+
+private slots:
+
+    void prefetch_next ();
+
+private:
+
+    Prepare prepare;
+    Release release;
+
+    uint radius     = 3;
+    uint num_meshes = 0;
+    uint current    = 0;
+    int  direction  = 1;
+    bool active     = false;
+
+    Dataset *dataset = nullptr;
+
+    std::map<uint, cinolib::DrawablePolygonmesh<> *> prepared;
+
+    QTimer idle_timer;
+
+    bool in_window     (const uint i) const;
+    void release_mesh  (cinolib::DrawablePolygonmesh<> *m);
+};
+
+#endif // MESHPREFETCHER_H
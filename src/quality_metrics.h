@@ -57,7 +57,9 @@ const std::vector<std::string> metrics_names =
     "Maximum Angle",
     "Shape Regularity",
     "Virtual Elements Max",
-    "Virtual Elements Area"
+    "Virtual Elements Area",
+    "VEM Projector Conditioning",
+    "VEM Stiffness Conditioning"
 };
 
 const std::vector<std::string> metrics_acronym =
@@ -77,7 +79,9 @@ const std::vector<std::string> metrics_acronym =
     "MXA",
     "SR",
     "VEM",
-    "VEMA"
+    "VEMA",
+    "VPC",
+    "VSC"
 };
 
 const std::vector<bool> metrics_scale_dependent =
@@ -97,6 +101,8 @@ const std::vector<bool> metrics_scale_dependent =
     false,
     false,
     false,
+    false,
+    false,
     false
 };
 
@@ -117,6 +123,8 @@ const std::vector<std::pair<double, double>> metrics_ranges
     std::pair<double, double> (0, M_PI),
     std::pair<double, double> (0, 1),
     std::pair<double, double> (1, cinolib::max_double),
+    std::pair<double, double> (1, cinolib::max_double),
+    std::pair<double, double> (1, cinolib::max_double),
     std::pair<double, double> (1, cinolib::max_double)
 };
 
@@ -0,0 +1,133 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "renderupdatequeue.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+RenderUpdateQueue::RenderUpdateQueue(QObject *parent, const uint max_batch) :
+    QObject(parent),
+    max_batch(std::max(max_batch, 1u))
+{
+}
+
+void RenderUpdateQueue::enqueue(cinolib::DrawablePolygonmesh<> *m, Update update)
+{
+    if (m == nullptr) return;
+
+    std::lock_guard<std::mutex> lock (mutex);
+
+    // any pending update leaves the render data of m up to date: it has not
+    // been applied yet, so it will read the attributes edited so far
+    if (!update && std::any_of(pending.begin(), pending.end(),
+                               [m](const Entry &e) { return e.mesh == m; }))
+        return;
+
+    pending.push_back({m, update});
+
+    if (drain_scheduled) return;
+
+    drain_scheduled = true;
+    QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+}
+
+void RenderUpdateQueue::discard(const cinolib::DrawablePolygonmesh<> *m)
+{
+    std::lock_guard<std::mutex> lock (mutex);
+
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [m](const Entry &e) { return e.mesh == m; }),
+                  pending.end());
+}
+
+void RenderUpdateQueue::flush()
+{
+    std::vector<Entry> batch;
+
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        batch.swap(pending);
+    }
+
+    if (batch.empty()) return;
+
+    apply(batch);
+
+    emit drained();
+}
+
+void RenderUpdateQueue::drain()
+{
+    std::vector<Entry> batch;
+
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        const size_t n = std::min(pending.size(), static_cast<size_t>(max_batch));
+
+        batch.assign(pending.begin(), pending.begin() + static_cast<long>(n));
+        pending.erase(pending.begin(), pending.begin() + static_cast<long>(n));
+
+        // the rest goes to the next pass, after the pending GUI events
+        drain_scheduled = !pending.empty();
+
+        if (drain_scheduled)
+            QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+    }
+
+    if (batch.empty()) return;
+
+    apply(batch);
+
+    emit drained();
+}
+
+void RenderUpdateQueue::apply(std::vector<Entry> &batch) const
+{
+    // every update rebuilds the render data: a plain rebuild is skipped if
+    // the same mesh has a later update in the batch
+    std::unordered_map<const cinolib::DrawablePolygonmesh<> *, size_t> last;
+
+    for (size_t i=0; i < batch.size(); i++)
+        last[batch.at(i).mesh] = i;
+
+    for (size_t i=0; i < batch.size(); i++)
+    {
+        Entry &e = batch.at(i);
+
+        if (e.update)
+            e.update(e.mesh);
+        else if (last.at(e.mesh) == i)
+            e.mesh->updateGL();
+    }
+}
@@ -0,0 +1,105 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef RENDERUPDATEQUEUE_H
+#define RENDERUPDATEQUEUE_H
+
+#include <cinolib/meshes/drawable_polygonmesh.h>
+
+#include <QObject>
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Coalesces and defers the render data rebuilds of drawable meshes. Any
+// thread can request one; they are all run on the GUI thread, the one
+// owning the OpenGL context, a batch at a time, so long pipelines show
+// their progress without blocking the event loop. The render data are not
+// prepared off the GUI thread: the draw lists of a cinolib mesh are built
+// by its own updateGL(), in place, while the canvas may be drawing them.
+// What the queue saves is redundant work: a plain rebuild requested while
+// another update of the same mesh is pending is dropped, and so are plain
+// rebuilds followed by an update in the same batch. A mesh must not be
+// edited again by a worker until its pending updates have been applied or
+// discarded.
+class RenderUpdateQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    // Runs on the GUI thread and must leave the render data up to date
+    // (the show_* switches of cinolib rebuild them on their own)
+    typedef std::function<void(cinolib::DrawablePolygonmesh<> *)> Update;
+
+    explicit RenderUpdateQueue (QObject *parent = nullptr, const uint max_batch = 16);
+
+    // Thread-safe. A null update just rebuilds the render data of m, and is
+    // dropped if m already has a pending update
+    void enqueue (cinolib::DrawablePolygonmesh<> *m, Update update = nullptr);
+
+    // GUI thread only. Drops the pending updates of m, which is going to
+    // be deleted or unloaded
+    void discard (const cinolib::DrawablePolygonmesh<> *m);
+
+    // GUI thread only. Applies all the pending updates right away
+    void flush ();
+
+signals:
+
+    // a batch of updates has been applied: the canvases showing the
+    // meshes have to be repainted
+    void drained ();
+
+private slots:
+
+    void drain ();
+
+private:
+
+    struct Entry
+    {
+        cinolib::DrawablePolygonmesh<> *mesh = nullptr;
+        Update update;
+    };
+
+    uint max_batch = 16;
+
+    std::mutex mutex;
+    std::vector<Entry> pending;
+    bool drain_scheduled = false;
+
+    void apply (std::vector<Entry> &batch) const;
+};
+
+#endif // RENDERUPDATEQUEUE_H
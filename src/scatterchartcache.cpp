@@ -0,0 +1,79 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "scatterchartcache.h"
+
+ScatterChartCache::ScatterChartCache(QStackedWidget *stack, const uint capacity) :
+    stack(stack),
+    capacity(capacity)
+{
+}
+
+CustomizedChartView * ScatterChartCache::find(const int key)
+{
+    for (auto it = lru.begin(); it != lru.end(); ++it)
+    {
+        if (it->first == key)
+        {
+            lru.splice(lru.begin(), lru, it);
+            return lru.front().second;
+        }
+    }
+
+    return nullptr;
+}
+
+void ScatterChartCache::insert(const int key, CustomizedChartView *view)
+{
+    lru.push_front(std::make_pair(key, view));
+    stack->addWidget(view);
+
+    while (lru.size() > capacity)
+    {
+        CustomizedChartView *old = lru.back().second;
+        lru.pop_back();
+
+        stack->removeWidget(old);
+        old->deleteLater();
+    }
+}
+
+void ScatterChartCache::clear()
+{
+    for (auto &item : lru)
+    {
+        stack->removeWidget(item.second);
+        item.second->deleteLater();
+    }
+
+    lru.clear();
+}
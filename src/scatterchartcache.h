@@ -0,0 +1,70 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef SCATTERCHARTCACHE_H
+#define SCATTERCHARTCACHE_H
+
+#include "customizedchartview.h"
+
+#include <QStackedWidget>
+
+#include <list>
+#include <utility>
+
+// The charts of a scatter plot widget that were shown last, kept in its
+// stacked widget. Charts are built when their pair of axes is selected;
+// when more than capacity charts are cached, the least recently used one
+// is removed from the stacked widget and deleted.
+class ScatterChartCache
+{
+public:
+    ScatterChartCache (QStackedWidget *stack, const uint capacity = 8);
+
+    // nullptr if the chart of key is not cached. Found charts become the
+    // most recently used ones
+    CustomizedChartView * find (const int key);
+
+    void insert (const int key, CustomizedChartView *view);
+    void clear  ();
+
+    // most recently used first
+    const std::list<std::pair<int, CustomizedChartView *>> & charts () const { return lru; }
+
+private:
+
+    QStackedWidget *stack = nullptr;
+    uint capacity = 8;
+
+    std::list<std::pair<int, CustomizedChartView *>> lru;
+};
+
+#endif // SCATTERCHARTCACHE_H
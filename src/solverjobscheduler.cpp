@@ -0,0 +1,341 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#include "solverjobscheduler.h"
+
+#include "meshes/solution_io.h"
+
+#include <QDir>
+
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+// hard links are enough for the solver to read the meshes, copies are the
+// fallback for file systems without them
+bool link_or_copy (const fs::path &src, const fs::path &dst)
+{
+    std::error_code ec;
+    fs::create_hard_link(src, dst, ec);
+    if (!ec) return true;
+
+    ec.clear();
+    return fs::copy_file(src, dst, fs::copy_options::overwrite_existing, ec) && !ec;
+}
+
+bool move_file (const fs::path &src, const fs::path &dst)
+{
+    std::error_code ec;
+    fs::rename(src, dst, ec);
+    if (!ec) return true;
+
+    ec.clear();
+    if (!fs::copy_file(src, dst, fs::copy_options::overwrite_existing, ec) || ec) return false;
+
+    fs::remove(src, ec);
+    return true;
+}
+
+}
+
+SolverJobScheduler::SolverJobScheduler(QObject *parent) :
+    QObject(parent)
+{
+}
+
+SolverJobScheduler::~SolverJobScheduler()
+{
+    for (QProcess *p : processes)
+    {
+        p->disconnect();
+        p->kill();
+        p->waitForFinished();
+    }
+
+    if (running) cleanup();
+}
+
+bool SolverJobScheduler::start(const Command                  &command,
+                               const Options                  &options,
+                               const std::string              &in_folder,
+                               const std::vector<std::string> &basenames,
+                               const uint                      solution_id,
+                               const std::string              &out_folder,
+                               const std::string              &out_filename)
+{
+    if (running || basenames.empty()) return false;
+
+    const std::string path_sep = QString(QDir::separator()).toStdString();
+
+    this->command     = command;
+    this->options     = options;
+    this->solution_id = solution_id;
+
+    n_meshes      = static_cast<uint>(basenames.size());
+    n_meshes_done = 0;
+    n_running     = 0;
+    canceled      = false;
+
+    out_filepath  = out_folder + path_sep + out_filename;
+    shards_folder = out_folder + path_sep + "." + out_filename + "_shards";
+
+    std::error_code ec;
+    fs::remove_all(shards_folder, ec);
+
+    const uint n_shards = std::max(1u, std::min(options.n_shards, n_meshes));
+
+    shards.assign(n_shards, Shard());
+    pending.clear();
+
+    for (uint k=0; k < n_shards; k++)
+    {
+        Shard &shard = shards.at(k);
+
+        shard.first        = static_cast<uint>(static_cast<size_t>(k) * n_meshes / n_shards);
+        shard.count        = static_cast<uint>(static_cast<size_t>(k+1) * n_meshes / n_shards) - shard.first;
+        shard.in_folder    = shards_folder + path_sep + "shard_" + std::to_string(k) + path_sep;
+        shard.out_filepath = out_filepath + ".shard_" + std::to_string(k);
+
+        fs::create_directories(shard.in_folder, ec);
+
+        if (ec)
+        {
+            emit log(QString("ERROR: cannot create ") + shard.in_folder.c_str());
+            cleanup();
+            return false;
+        }
+
+        for (uint i=shard.first; i < shard.first + shard.count; i++)
+            for (const char *ext : { ".node", ".ele" })
+            {
+                const std::string src = in_folder + basenames.at(i) + ext;
+
+                if (!link_or_copy(src, shard.in_folder + basenames.at(i) + ext))
+                {
+                    emit log(QString("ERROR: cannot link ") + src.c_str() + " into " + shard.in_folder.c_str());
+                    cleanup();
+                    return false;
+                }
+            }
+
+        pending.push_back(k);
+    }
+
+    running = true;
+
+    emit progress(0, n_meshes);
+
+    launch_next();
+
+    return true;
+}
+
+void SolverJobScheduler::cancel()
+{
+    if (!running || canceled) return;
+
+    canceled = true;
+    pending.clear();
+
+    emit log("Canceling solver processes ...");
+
+    for (QProcess *p : processes)
+        p->kill();
+
+    if (n_running == 0) finish();
+}
+
+void SolverJobScheduler::launch_next()
+{
+    while (n_running < std::max(1u, options.max_jobs) && !pending.empty())
+    {
+        const uint k = pending.front();
+        pending.pop_front();
+
+        Shard &shard = shards.at(k);
+        shard.attempts++;
+
+        std::error_code ec;
+        fs::remove(shard.out_filepath, ec);
+        fs::remove(shard.out_filepath + "_DONE", ec);
+
+        QStringList args;
+        for (QString arg : command.arguments)
+        {
+            arg.replace("%IN%",  shard.in_folder.c_str());
+            arg.replace("%OUT%", shard.out_filepath.c_str());
+            arg.replace("%SOL%", QString::number(solution_id));
+            args << arg;
+        }
+
+        QProcess *p = new QProcess(this);
+        p->setProcessChannelMode(QProcess::MergedChannels);
+        p->setWorkingDirectory(command.working_dir);
+
+        const QString prefix = QString("[shard %1] ").arg(k);
+
+        connect(p, &QProcess::readyReadStandardOutput, this, [this, p, prefix]()
+        {
+            while (p->canReadLine())
+                emit log(prefix + QString::fromLocal8Bit(p->readLine()).trimmed());
+        });
+
+        connect(p, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, k, p](int exit_code, QProcess::ExitStatus status)
+        {
+            on_process_finished(k, p, exit_code, status);
+        });
+
+        // a process that fails to start never emits finished
+        connect(p, &QProcess::errorOccurred, this, [this, k, p](QProcess::ProcessError error)
+        {
+            if (error == QProcess::FailedToStart)
+                on_process_finished(k, p, -1, QProcess::CrashExit);
+        });
+
+        processes.push_back(p);
+        n_running++;
+
+        emit shard_started(k, shard.attempts);
+
+        p->start(command.program, args);
+    }
+}
+
+void SolverJobScheduler::on_process_finished(const uint k, QProcess *p, const int exit_code, const QProcess::ExitStatus status)
+{
+    auto it = std::find(processes.begin(), processes.end(), p);
+    if (it == processes.end()) return;
+
+    processes.erase(it);
+    n_running--;
+
+    const QString remaining = QString::fromLocal8Bit(p->readAll()).trimmed();
+    if (!remaining.isEmpty())
+        emit log(QString("[shard %1] ").arg(k) + remaining);
+
+    p->deleteLater();
+
+    Shard &shard = shards.at(k);
+
+    std::error_code ec;
+    fs::remove(shard.out_filepath + "_DONE", ec);
+
+    if (!canceled)
+    {
+        std::vector<std::vector<double>> cols;
+
+        shard.ok = (status == QProcess::NormalExit && exit_code == 0 &&
+                    read_error_table(shard.out_filepath, options.n_cols, cols) &&
+                    cols.front().size() == shard.count);
+
+        if (shard.ok)
+        {
+            // per-mesh outputs written next to the inputs go to the output folder
+            const fs::path out_folder = fs::path(out_filepath).parent_path();
+
+            for (const fs::directory_entry &e : fs::directory_iterator(shard.in_folder, ec))
+                if (e.path().extension() == ".txt")
+                    move_file(e.path(), out_folder / e.path().filename());
+
+            n_meshes_done += shard.count;
+
+            emit shard_finished(k, true);
+            emit progress(n_meshes_done, n_meshes);
+        }
+        else if (shard.attempts <= options.max_retries)
+        {
+            emit log(QString("[shard %1] failed (exit code %2), retrying").arg(k).arg(exit_code));
+            pending.push_back(k);
+        }
+        else
+        {
+            emit log(QString("[shard %1] failed after %2 attempts").arg(k).arg(shard.attempts));
+
+            n_meshes_done += shard.count;
+
+            emit shard_finished(k, false);
+            emit progress(n_meshes_done, n_meshes);
+        }
+
+        launch_next();
+    }
+
+    if (n_running == 0 && pending.empty())
+        finish();
+}
+
+void SolverJobScheduler::finish()
+{
+    const bool results_written = !canceled && merge_results();
+
+    cleanup();
+    running = false;
+
+    emit finished(results_written);
+}
+
+bool SolverJobScheduler::merge_results()
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    std::vector<std::vector<double>> cols (options.n_cols, std::vector<double>(n_meshes, nan));
+
+    for (const Shard &shard : shards)
+    {
+        if (!shard.ok) continue;
+
+        std::vector<std::vector<double>> shard_cols;
+        if (!read_error_table(shard.out_filepath, options.n_cols, shard_cols)) continue;
+
+        for (uint c=0; c < options.n_cols; c++)
+            std::copy(shard_cols.at(c).begin(), shard_cols.at(c).begin() + shard.count,
+                      cols.at(c).begin() + shard.first);
+    }
+
+    return write_error_table(out_filepath, cols);
+}
+
+void SolverJobScheduler::cleanup()
+{
+    std::error_code ec;
+
+    for (const Shard &shard : shards)
+        fs::remove(shard.out_filepath, ec);
+
+    fs::remove_all(shards_folder, ec);
+}
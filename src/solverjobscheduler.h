@@ -0,0 +1,146 @@
+/********************************************************************************
+*  This file is part of PEMesh                                                  *
+*  Copyright(C) 2022: Daniela Cabiddu                                           *
+
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Daniela Cabiddu (daniela.cabiddu@cnr.it)                                  *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*                                                                               *
+*                                                                               *
+*                                                                               *
+*  This program is free software: you can redistribute it and/or modify it      *
+*  under the terms of the GNU General Public License as published by the        *
+*  Free Software Foundation, either version 3 of the License, or (at your       *
+*  option) any later version.                                                   *
+*                                                                               *
+*  This program is distributed in the hope that it will be useful, but          *
+*  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY   *
+*  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for  *
+*  more details.                                                                *
+*                                                                               *
+*  You should have received a copy of the GNU General Public License along      *
+*  with this program. If not, see <https://www.gnu.org/licenses/>.              *
+*                                                                               *
+*********************************************************************************/
+
+#ifndef SOLVERJOBSCHEDULER_H
+#define SOLVERJOBSCHEDULER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+// Runs an external solver over a dataset split into shards, with up to
+// max_jobs processes at a time. Each shard gets its own input folder, holding
+// links to (or copies of) the NODE/ELE files of its meshes, and its own
+// results file; completion is detected by QProcess::finished. A shard whose
+// process fails, or whose results file does not have one row per mesh, is
+// retried up to max_retries times. When every shard is over, the shard
+// results are merged, in dataset order, into the results file read by
+// MainWindow::show_solver_results; meshes of failed shards get rows of NaNs.
+//
+// The solver is any program taking an input folder, an output file and a
+// solution id, through the placeholders %IN%, %OUT% and %SOL% of its
+// arguments: the MATLAB script, or a local stand-in writing one row of
+// n_cols values per mesh (e.g. a shell script).
+class SolverJobScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    typedef struct
+    {
+        QString     program;
+        QStringList arguments;
+        QString     working_dir;
+    }
+    Command;
+
+    typedef struct
+    {
+        uint max_jobs    = 1;
+        uint n_shards    = 1;     // clamped to the number of meshes
+        uint max_retries = 1;
+        uint n_cols      = 5;     // values per row of the results files
+    }
+    Options;
+
+    explicit SolverJobScheduler (QObject *parent = nullptr);
+    ~SolverJobScheduler ();
+
+    // basenames are the NODE/ELE files in in_folder, in dataset order.
+    // Returns false if the shard folders cannot be prepared.
+    bool start (const Command                  &command,
+                const Options                  &options,
+                const std::string              &in_folder,
+                const std::vector<std::string> &basenames,
+                const uint                      solution_id,
+                const std::string              &out_folder,
+                const std::string              &out_filename);
+
+    // kills the running processes; finished(false) follows
+    void cancel ();
+
+    bool is_running () const { return running; }
+
+Q_SIGNALS:
+
+    void shard_started  (const uint shard, const uint attempt);
+    void shard_finished (const uint shard, const bool ok);
+    void progress       (const uint n_meshes_done, const uint n_meshes);
+    void log            (const QString line);
+
+    // results_written is false if the run was canceled or the results file
+    // could not be written. Shards that failed are reported by shard_finished
+    void finished       (const bool results_written);
+
+private:
+
+    typedef struct
+    {
+        uint        first    = 0;
+        uint        count    = 0;
+        uint        attempts = 0;
+        bool        ok       = false;
+        std::string in_folder;
+        std::string out_filepath;
+    }
+    Shard;
+
+    void launch_next ();
+    void on_process_finished (const uint shard, QProcess *process, const int exit_code, const QProcess::ExitStatus status);
+    void finish ();
+    bool merge_results ();
+    void cleanup ();
+
+    Command     command;
+    Options     options;
+    uint        solution_id = 0;
+    std::string shards_folder;
+    std::string out_filepath;
+
+    std::vector<Shard> shards;
+    std::deque<uint>   pending;
+    std::vector<QProcess *> processes;
+
+    uint n_running     = 0;
+    uint n_meshes_done = 0;
+    uint n_meshes      = 0;
+
+    bool running  = false;
+    bool canceled = false;
+};
+
+#endif // SOLVERJOBSCHEDULER_H
@@ -33,6 +33,8 @@
 #include "solverresultswidget.h"
 #include "ui_solverresultswidget.h"
 
+#include "meshes/solution_io.h"
+
 #include <QFileDialog>
 #include <QRubberBand>
 
@@ -43,6 +45,21 @@ SolverResultsWidget::SolverResultsWidget(QWidget *parent)
 {
   ui->setupUi(this);
 
+  render_queue = new RenderUpdateQueue(this);
+  connect(render_queue, SIGNAL(drained()), ui->solver_output, SLOT(updateGL()));
+  connect(render_queue, SIGNAL(drained()), ui->groundtruth, SLOT(updateGL()));
+
+  // only the displayed meshes and their neighbors are pinned, with their
+  // fields applied and their ground truth views: prefetching them builds
+  // their render data, in the vertex color mode of this tab
+  prefetcher = new MeshPrefetcher(this);
+  prefetcher->set_jobs([this](const uint i) {
+    return acquire_mesh(i);
+  },
+  [this](cinolib::DrawablePolygonmesh<> *m) {
+    release_mesh(m);
+  });
+
 #ifndef DEVELOP
 
   ui->deformation_cb->hide();
@@ -51,44 +68,177 @@ SolverResultsWidget::SolverResultsWidget(QWidget *parent)
 #endif
 }
 
-SolverResultsWidget::~SolverResultsWidget() { delete ui; }
+SolverResultsWidget::~SolverResultsWidget()
+{
+  // the ground truth views own GPU buffers of the groundtruth canvas. Views
+  // are left only if clear() was not called: their meshes are not unpinned,
+  // the dataset may be gone already
+  if (!groundtruth.empty()) {
+    ui->groundtruth->makeCurrent();
+
+    for (auto &v : groundtruth)
+      delete v.second;
+  }
+
+  delete ui;
+}
 
 void SolverResultsWidget::set_dataset(Dataset *d)
 {
-  for (uint i = 0; i < d->get_parametric_meshes().size(); i++)
-  {
-    DrawablePolygonmesh<> *m = d->get_parametric_mesh(i);
-    DrawablePolygonmesh<> *m_gt =
-        new DrawablePolygonmesh<>(m->vector_verts(), m->vector_polys());
+  clear();
 
-    results.push_back(m);
-    groundtruth.push_back(m_gt);
+  dataset = d;
 
-    for (uint pid=0; pid < m_gt->num_polys(); pid++)
-        if (m_gt->adj_p2e(pid).size() > 3)
-            for (uint eid : m_gt->adj_p2e(pid))
-                m_gt->edge_data(eid).flags.set(0, true);
+  prefetcher->set_dataset(d);
 
-    //        m_gt->show_marked_edge(true);
-  }
+  // meshes are pinned on demand, when they get close to the displayed one
+  solutions.resize(d->get_num_parametric_meshes());
+  groundtruths.resize(d->get_num_parametric_meshes());
 
-  ui->t_slider->setMaximum(static_cast<int>(d->get_parametric_meshes().size()) -
+  ui->t_slider->setMaximum(static_cast<int>(d->get_num_parametric_meshes()) -
                            1);
 
-  if (d->get_parametric_meshes().size() > 0)
+  if (d->get_num_parametric_meshes() > 0)
     show_parametric_mesh(0);
 }
 
-void SolverResultsWidget::show_mesh_solution_and_groundtruth() const
+void SolverResultsWidget::set_fields(const uint i,
+                                     const std::vector<double> &solution,
+                                     const std::vector<double> &groundtruth_field)
+{
+  solutions.at(i) = solution;
+  groundtruths.at(i) = groundtruth_field;
+
+  // meshes away from the displayed one get their fields when pinned
+  auto it = results.find(i);
+  if (it == results.end())
+    return;
+
+  apply_fields(i);
+
+  if (i == curr_mesh_id) {
+    ui->solver_output->updateGL();
+    ui->groundtruth->updateGL();
+  }
+}
+
+void SolverResultsWidget::geometry_changed()
 {
-  for (uint i = 0; i < results.size(); i++) {
+  for (auto &v : groundtruth)
+    v.second->geometry_changed();
+
+  ui->groundtruth->updateGL();
+}
+
+void SolverResultsWidget::clear()
+{
+  clean_canvas();
+  curr_mesh_id = max_uint;
+  update_scene = true;
+
+  prefetcher->invalidate();
+
+  // the displayed mesh, the only one left
+  while (!results.empty())
+    release_mesh(results.begin()->second);
+
+  solutions.clear();
+  groundtruths.clear();
+}
+
+cinolib::DrawablePolygonmesh<> *SolverResultsWidget::acquire_mesh(const uint i)
+{
+  // the ground truth is drawn on the geometry of the solution mesh
+  cinolib::DrawablePolygonmesh<> *m = dataset->pin_parametric_mesh(i);
+
+  VertexFieldView *gt = new VertexFieldView();
+  gt->set_geometry(m);
+
+  results[i] = m;
+  groundtruth[i] = gt;
+
+  apply_fields(i);
+
+  return m;
+}
+
+void SolverResultsWidget::release_mesh(cinolib::DrawablePolygonmesh<> *m)
+{
+  for (auto it = results.begin(); it != results.end(); ++it) {
+    if (it->second != m)
+      continue;
+
+    ui->groundtruth->makeCurrent();
+    delete groundtruth.at(it->first);
+    groundtruth.erase(it->first);
+
+    render_queue->discard(m);
+    dataset->unpin_parametric_mesh(m);
+
+    results.erase(it);
+    return;
+  }
+}
+
+void SolverResultsWidget::apply_fields(const uint i)
+{
+  cinolib::DrawablePolygonmesh<> *m = results.at(i);
+
+  std::vector<double> values;
+  std::vector<cinolib::Color> colors;
+
+  // the fields are stored as read, they are normalized and colored on a copy
+  if (solutions.at(i).size() == m->num_verts()) {
+    values = solutions.at(i);
+    vertex_field_colors(values, colors);
+
+    for (uint vid = 0; vid < m->num_verts(); vid++) {
+      m->vert_data(vid).uvw[0] = values.at(vid);
+      m->vert_data(vid).color = colors.at(vid);
+    }
+  }
+
+  // the other tabs may have prefetched it in another color mode
+  m->show_vert_color();
+  dataset->set_render_owner(m, nullptr);
+
+  if (groundtruths.at(i).size() == m->num_verts()) {
+    values = groundtruths.at(i);
+    vertex_field_colors(values, colors);
+    groundtruth.at(i)->set_field(values, colors);
+  }
+}
+
+void SolverResultsWidget::show_mesh_solution_and_groundtruth()
+{
+  const RenderUpdateQueue::Update show_vert_color =
+      [this](cinolib::DrawablePolygonmesh<> *m) {
+        m->show_vert_color();
+        dataset->set_render_owner(m, nullptr);
+      };
+
+  // switching the color mode rebuilds the render data: it is done a batch
+  // of meshes at a time, without blocking the GUI, starting from the
+  // displayed one. The ground truth views keep their own colors
+  auto curr = results.find(curr_mesh_id);
+
+  if (curr != results.end())
+    render_queue->enqueue(curr->second, show_vert_color);
+
+  for (auto &r : results) {
     // const int tex_type = cinolib::TEXTURE_1D_HSV;
     // results.at(i)->show_texture1D(tex_type);
     // groundtruth.at(i)->show_texture1D(tex_type);
 
-    results.at(i)->show_vert_color();
-    groundtruth.at(i)->show_vert_color();
+    if (r.first == curr_mesh_id)
+      continue;
+
+    render_queue->enqueue(r.second, show_vert_color);
   }
+
+  // the neighbors have been dropped on the tab change
+  if (curr != results.end())
+    prefetcher->set_current(curr_mesh_id, static_cast<uint>(solutions.size()));
 }
 
 void SolverResultsWidget::add_chart(CustomizedChartView *chart,
@@ -162,14 +312,31 @@ void SolverResultsWidget::clean_canvas()
 
 void SolverResultsWidget::show_parametric_mesh(int index)
 {
+  const uint previous_id = curr_mesh_id;
+
   clean_canvas();
 
-  cinolib::DrawablePolygonmesh<> *p_r = results.at(static_cast<uint>(index));
-  cinolib::DrawablePolygonmesh<> *p_gt =
-      groundtruth.at(static_cast<uint>(index));
+  const uint id = static_cast<uint>(index);
+
+  // the previous mesh goes back to the prefetcher, still pinned
+  cinolib::DrawablePolygonmesh<> *previous = nullptr;
+
+  if (previous_id < solutions.size() && previous_id != id)
+    previous = results.at(previous_id);
 
-  p_r->updateGL();
-  p_gt->updateGL();
+  // prefetched meshes have their fields and render data ready, the others
+  // are pinned now
+  cinolib::DrawablePolygonmesh<> *p_r = nullptr;
+
+  if (previous_id == id)
+    p_r = results.at(id);
+  else
+    p_r = prefetcher->take(id);
+
+  if (p_r == nullptr)
+    p_r = acquire_mesh(id);
+
+  VertexFieldView *p_gt = groundtruth.at(id);
 
   ui->solver_output->push_obj(p_r, update_scene);
   ui->solver_output->updateGL();
@@ -179,7 +346,12 @@ void SolverResultsWidget::show_parametric_mesh(int index)
 
   update_scene = false;
 
-  curr_mesh_id = static_cast<uint>(index);
+  curr_mesh_id = id;
+
+  prefetcher->set_current(id, static_cast<uint>(solutions.size()));
+
+  if (previous != nullptr)
+    prefetcher->put(previous_id, previous);
 }
 
 void SolverResultsWidget::on_t_slider_valueChanged(int value)
@@ -334,8 +506,3 @@ void SolverResultsWidget::on_meshsize_cb_stateChanged(int checked)
   //    }
   ui->deformation_cb->setChecked(!checked);
 }
-
-cinolib::DrawablePolygonmesh<> *SolverResultsWidget::get_gt_mesh(const uint i)
-{
-  return groundtruth.at(i);
-}
@@ -34,6 +34,10 @@
 #define SOLVERRESULTSWIDGET_H
 
 #include "dataset.h"
+#include "meshprefetcher.h"
+#include "renderupdatequeue.h"
+
+#include "meshes/vertex_field_view.h"
 
 #include <cinolib/meshes/drawable_polygonmesh.h>
 
@@ -45,6 +49,8 @@ QT_CHARTS_USE_NAMESPACE
 
 #include <QWidget>
 
+#include <map>
+
 namespace Ui {
 class SolverResultsWidget;
 }
@@ -61,20 +67,37 @@ public:
     void clean_charts();
 
     void set_dataset (Dataset *d);
+
+    // drops the results and unpins their meshes: to be called before the
+    // dataset is cleaned or destroyed, the widget does not unpin them when
+    // deleted
+    void clear ();
     void set_solution_id (const uint id) { solution_id = id; }
 
     void show_mesh (const uint index);
 
-    void show_mesh_solution_and_groundtruth () const;
+    void show_mesh_solution_and_groundtruth ();
 
     void clean_canvas ();
 
-    cinolib::DrawablePolygonmesh<> * get_gt_mesh (const uint i);
+    // the solution and ground truth fields of mesh i, as read (empty if
+    // missing), shown whenever the mesh is displayed. GUI thread only
+    void set_fields (const uint i, const std::vector<double> &solution, const std::vector<double> &groundtruth_field);
+
+    // color mode switches of the result meshes, still pending
+    RenderUpdateQueue * get_render_queue () { return render_queue; }
+
+    // the render data of the prefetched meshes are stale (e.g. their color mode changed)
+    void drop_prefetched_meshes () { prefetcher->invalidate(); }
 
 public slots:
 
     void show_parametric_mesh (int);
 
+    // the meshes of the dataset have been edited: the ground truth views
+    // drawn on them follow their new geometry
+    void geometry_changed ();
+
 private slots:
 
     void on_t_slider_valueChanged(int value);
@@ -114,14 +137,29 @@ private:
     std::vector<std::string> chart_views_names;
     std::vector<QGraphicsLineItem *> track_lines;
 
-    std::vector<cinolib::DrawablePolygonmesh<> *> results;
-    std::vector<cinolib::DrawablePolygonmesh<> *> groundtruth;
+    Dataset *dataset = nullptr;
+
+    // one per mesh of the dataset
+    std::vector<std::vector<double>> solutions;
+    std::vector<std::vector<double>> groundtruths;
+
+    // only the displayed and the prefetched meshes are pinned. The ground
+    // truth fields are drawn on their geometry, which is not copied
+    std::map<uint, cinolib::DrawablePolygonmesh<> *> results;
+    std::map<uint, VertexFieldView *> groundtruth;
+
+    RenderUpdateQueue *render_queue = nullptr;
+    MeshPrefetcher    *prefetcher   = nullptr;   // neighbors of the displayed meshes
 
     bool update_scene = true;
     uint curr_mesh_id = max_uint;
 
     void change_series_color (const uint series_id);
 
+    cinolib::DrawablePolygonmesh<> * acquire_mesh (const uint i);
+    void                             release_mesh (cinolib::DrawablePolygonmesh<> *m);
+    void                             apply_fields (const uint i);
+
 };
 
 #endif // SOLVERRESULTSWIDGET_H
@@ -107,6 +107,11 @@ const std::string SolverSettingsDialog::get_solver_script_full_path() const
     return ui->solver_script->text().toStdString();
 }
 
+bool SolverSettingsDialog::is_matlab_script() const
+{
+    return ui->solver_script->text().endsWith(".m", Qt::CaseInsensitive);
+}
+
 void SolverSettingsDialog::on_output_directory_btn_clicked()
 {
     QString start_folder = "";
@@ -154,19 +159,38 @@ void SolverSettingsDialog::disable_input_folder_selection()
     ui->input_directory_btn->setEnabled(false);
 }
 
-void SolverSettingsDialog::on_solver_directory_btn_clicked()
+void SolverSettingsDialog::disable_matlab_settings()
 {
-    QString dir = QFileDialog::getExistingDirectory(this, tr("Open Directory"),
+    ui->matlab_folder_label->hide();
+    ui->matlab_folder->hide();
+    ui->matlab_directory_btn->hide();
+    ui->matlab_folder_error->hide();
+
+    ui->solver_script_label->hide();
+    ui->solver_script->hide();
+    ui->solver_script_btn->hide();
+    ui->solver_folder_error->hide();
+
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(true);
+}
+
+void SolverSettingsDialog::on_solver_script_btn_clicked()
+{
+    QString file = QFileDialog::getOpenFileName(this, tr("Open Solver Script"),
                                                 "",
-                                                QFileDialog::ShowDirsOnly
-                                                | QFileDialog::DontResolveSymlinks);
+                                                tr("Solver scripts (*.m *.sh);;All files (*)"));
 
-    if (!dir.isNull())
+    if (!file.isNull())
     {
-        ui->solver_script->setText(dir);
+        ui->solver_script->setText(file);
 
-        solver_folder = dir.toStdString();
-        check_solver_folder_ok();
+        solver_script = file.toStdString();
+
+        // MATLAB is only needed by MATLAB scripts
+        const bool matlab_ok = check_matlab_folder_ok();
+        const bool solver_ok = check_solver_folder_ok();
+
+        ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(matlab_ok && solver_ok);
     }
 }
 
@@ -188,6 +212,12 @@ void SolverSettingsDialog::on_matlab_directory_btn_clicked()
 
 bool SolverSettingsDialog::check_matlab_folder_ok()
 {
+    if (!is_matlab_script())
+    {
+        ui->matlab_folder_error->hide();
+        return true;
+    }
+
     QString dir = ui->matlab_folder->text();
 
     QDir folder (dir);
@@ -55,17 +55,24 @@ public:
 
     const std::string get_matlab_exe_name () const;
 
+    // any other solver script (e.g. scripts/solver_stand_in.sh) is run by
+    // itself, with the input folder, output file and solution id as arguments
+    bool is_matlab_script () const;
+
     void set_input_folder (const std::string folder);
     void set_output_folder (const std::string folder);
 
     void disable_input_folder_selection ();
 
+    // hides the MATLAB settings, not needed by the native solver
+    void disable_matlab_settings ();
+
 private slots:
     void on_output_directory_btn_clicked();
 
     void on_input_directory_btn_clicked();
 
-    void on_solver_directory_btn_clicked();
+    void on_solver_script_btn_clicked();
 
     void on_matlab_directory_btn_clicked();
 
@@ -73,7 +80,7 @@ private:
     Ui::SolverSettingsDialog *ui;
 
     std::string matlab_folder;
-    std::string solver_folder;
+    std::string solver_script;
 
     std::string matlab_exe_name;
 
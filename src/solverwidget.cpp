@@ -33,9 +33,25 @@
 #include "solverwidget.h"
 #include "ui_solverwidget.h"
 
+#include "solverjobscheduler.h"
 #include "solversettingsdialog.h"
 
+#include "meshes/dataset_manifest.h"
+#include "meshes/error_norms.h"
+#include "meshes/polygon_mesh_io.h"
+#include "meshes/solution_io.h"
+#include "meshes/solver_cache.h"
+#include "meshes/vem_poisson_solver.h"
+
+#include <backgroundtask.h>
+
 #include <QDir>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 SolverWidget::SolverWidget(QWidget *parent) :
     QWidget(parent),
@@ -43,8 +59,36 @@ SolverWidget::SolverWidget(QWidget *parent) :
 {
     ui->setupUi(this);
 
-    process = new QProcess();
-    connect(process, SIGNAL(readyRead()), this, SLOT(update_log()));
+    ui->jobs_sb->setMaximum(std::max(1, QThread::idealThreadCount()));
+    ui->jobs_sb->setValue(std::max(1, std::min(4, QThread::idealThreadCount()/2)));
+
+    prefetcher = new MeshPrefetcher(this);
+    prefetcher->set_jobs([this](const uint i)
+    {
+        cinolib::DrawablePolygonmesh<> *p = dataset->pin_parametric_mesh(i);
+        prepare_render_data(p);
+        return p;
+    },
+    [this](cinolib::DrawablePolygonmesh<> *p)
+    {
+        dataset->unpin_parametric_mesh(p);
+    });
+
+    scheduler = new SolverJobScheduler(this);
+
+    connect(scheduler, &SolverJobScheduler::log, this, &SolverWidget::update_log);
+    connect(scheduler, &SolverJobScheduler::finished, this, &SolverWidget::on_solver_jobs_finished);
+
+    connect(scheduler, &SolverJobScheduler::progress, this, [this](const uint n_done, const uint)
+    {
+        if (progress_dialog != nullptr && !progress_dialog->wasCanceled())
+            progress_dialog->setValue(static_cast<int>(n_done));
+    });
+
+    connect(scheduler, &SolverJobScheduler::shard_finished, this, [this](const uint shard, const bool ok)
+    {
+        if (!ok) ui->log_text->append(QString("ERROR: shard %1 failed, its meshes have no results").arg(shard));
+    });
 }
 
 SolverWidget::~SolverWidget()
@@ -55,6 +99,8 @@ SolverWidget::~SolverWidget()
 void SolverWidget::set_dataset(Dataset *d)
 {
     dataset = d;
+
+    prefetcher->set_dataset(d);
 }
 
 void SolverWidget::set_input_folder(const std::string folder)
@@ -67,9 +113,9 @@ void SolverWidget::update()
     if (dataset == nullptr)
         return;
 
-    if (dataset->get_parametric_meshes().size() > 0 )
+    if (dataset->get_num_parametric_meshes() > 0 )
     {
-        ui->t_slider->setMaximum(static_cast<int>(dataset->get_parametric_meshes().size())-1);
+        ui->t_slider->setMaximum(static_cast<int>(dataset->get_num_parametric_meshes())-1);
         show_parametric_mesh(ui->t_slider->value());
     }
 }
@@ -77,18 +123,39 @@ void SolverWidget::update()
 void SolverWidget::clean_canvas()
 {
     for (DrawablePolygonmesh<> * p : drawable_polys)
+    {
         ui->canvas->pop(p);
+        dataset->unpin_parametric_mesh(p);
+    }
 
     drawable_polys.clear();
 }
 
 void SolverWidget::show_parametric_mesh(int index)
 {
+    const uint id = static_cast<uint>(index);
+
+    // the previous mesh goes back to the prefetcher, still pinned
+    cinolib::DrawablePolygonmesh<> *previous = nullptr;
+
+    if (drawable_polys.size() == 1)
+    {
+        previous = drawable_polys.front();
+        ui->canvas->pop(previous);
+        drawable_polys.clear();
+    }
+
     clean_canvas();
 
-    cinolib::DrawablePolygonmesh<> *p = dataset->get_parametric_mesh(static_cast<uint>(index));
+    // a prefetched mesh is pinned and its render data are ready
+    cinolib::DrawablePolygonmesh<> *p = prefetcher->take(id);
+
+    if (p == nullptr)
+    {
+        p = dataset->pin_parametric_mesh(id);
+        prepare_render_data(p);
+    }
 
-    dataset->get_parametric_mesh(static_cast<uint>(index))->updateGL();
     ui->canvas->push_obj(p, update_scene);
     ui->canvas->updateGL();
 
@@ -96,7 +163,17 @@ void SolverWidget::show_parametric_mesh(int index)
 
     update_scene = false;
 
-    curr_mesh_id = static_cast<uint>(index);
+    const uint previous_id = curr_mesh_id;
+    curr_mesh_id = id;
+
+    prefetcher->set_current(id, dataset->get_num_parametric_meshes());
+    prefetcher->put(previous_id, previous);
+}
+
+void SolverWidget::prepare_render_data(cinolib::DrawablePolygonmesh<> *p) const
+{
+    p->show_poly_color();
+    p->updateGL();
 }
 
 void SolverWidget::on_t_slider_valueChanged(int value)
@@ -112,71 +189,409 @@ void SolverWidget::on_run_btn_clicked()
     dialog->set_output_folder(input_folder);
     dialog->disable_input_folder_selection();
 
-    if (dialog->exec() == 1)
+    // the MATLAB script stays the default engine: the native one has not
+    // been checked against its output yet
+    const bool native = (ui->engine_cb->currentIndex() == 1);
+
+    if (native)
+        dialog->disable_matlab_settings();
+
+    if (dialog->exec() != 1)
     {
-        //ui->log_label->append("Running solver ... ");
+        delete dialog;
+        return;
+    }
 
-        QApplication::setOverrideCursor(Qt::WaitCursor);
+    QString path_sep = QString(QDir::separator());
 
-        QString path_sep = QString(QDir::separator());
+    run = SolverRun();
+    run.solution_id  = static_cast<uint>(ui->solver_cb->currentIndex());
+    run.in_folder    = dialog->get_input_folder() + path_sep.toStdString();
+    run.out_folder   = dialog->get_output_folder();
+    run.out_filename = dialog->get_output_filename();
+    run.basenames    = dataset_basenames();
 
-        const std::string in_folder = dialog->get_input_folder() + path_sep.toStdString();
-        const std::string out_folder = dialog->get_output_folder();
-        const std::string out_filename = dialog->get_output_filename();
-        const std::string out_filepath = out_folder + path_sep.toStdString() + out_filename;
+    const std::string solver_script_path = dialog->get_solver_script_full_path();
 
-        const unsigned int solution_id = static_cast<uint>(ui->solver_cb->currentIndex());
+    // results are reused while the solver (script contents, or native
+    // solver and its settings) does not change
+    if (native)
+        run.fingerprint = string_fingerprint("PEMesh native VEM k=1, version 1, linear solver " +
+                                             std::to_string(ui->linear_solver_cb->currentIndex()));
+    else
+        run.fingerprint = file_fingerprint(solver_script_path) ^
+                          string_fingerprint("PEMesh error norms, version 2");
 
-        const std::string matlab_folder = dialog->get_matlab_folder();
-        const std::string matlab_exe = matlab_folder + QString(QDir::separator()).toStdString() + dialog->get_matlab_exe_name();
+    if (!lookup_cached_results())
+    {
+        ui->log_text->append("Solver canceled.");
+        delete dialog;
+        return;
+    }
 
-        const std::string solver_script_path = dialog->get_solver_script_full_path();
-        const std::string scripts_folder = solver_script_path.substr(0, solver_script_path.find_last_of(QDir::separator().unicode()));
+    const uint n_meshes = static_cast<uint>(run.basenames.size());
+    const uint n_misses = static_cast<uint>(run.misses.size());
 
-        const std::string cd_cmd = std::string ("cd ") + std::string(scripts_folder);
+    ui->log_text->append(QString::number(n_meshes - n_misses) + " of " + QString::number(n_meshes) +
+                         " meshes found in the solver cache");
 
-        std::string solver_script_name = solver_script_path.substr(solver_script_path.find_last_of(QDir::separator().unicode())+1);
-        solver_script_name = solver_script_name.substr(0, solver_script_name.find_last_of("."));
-        const std::string matlab_script = solver_script_name + std::string(" ('")
-                                            + in_folder + "','" + out_filepath + "'," + std::to_string(solution_id) +");exit;";
+    if (native || n_misses == 0)
+    {
+        if ((native ? run_native_solver() : true) && write_results())
+            emit (solver_completed (run.solution_id, run.out_folder, run.out_filename));
+    }
+    else
+    {
+        SolverJobScheduler::Command command;
 
-        std::cout << "RUNNING : " << matlab_script << std::endl;
+        // the scheduler fills in the input folder, output file and solution
+        // id of each shard
+        if (dialog->is_matlab_script())
+        {
+            const std::string matlab_folder = dialog->get_matlab_folder();
+            const std::string matlab_exe = matlab_folder + path_sep.toStdString() + dialog->get_matlab_exe_name();
 
-        const std::string matlab_args = "-nodisplay -nosplash -nodesktop -r \"" + matlab_script + "\";";
+            const std::string scripts_folder = solver_script_path.substr(0, solver_script_path.find_last_of(QDir::separator().unicode()));
 
-        process->setWorkingDirectory(scripts_folder.c_str());
+            std::string solver_script_name = solver_script_path.substr(solver_script_path.find_last_of(QDir::separator().unicode())+1);
+            solver_script_name = solver_script_name.substr(0, solver_script_name.find_last_of("."));
 
-        process->moveToThread(QCoreApplication::instance()->thread());
+            command.program     = matlab_exe.c_str();
+            command.arguments   << "-nodisplay" << "-nosplash" << "-nodesktop" << "-r"
+                                << QString(solver_script_name.c_str()) + "('%IN%','%OUT%',%SOL%);exit;";
+            command.working_dir = scripts_folder.c_str();
+        }
+        else
+        {
+            // e.g. the local stand-in solver, scripts/solver_stand_in.sh
+            command.program     = solver_script_path.c_str();
+            command.arguments   << "%IN%" << "%OUT%" << "%SOL%";
+            command.working_dir = run.out_folder.c_str();
+        }
+
+        SolverJobScheduler::Options options;
+        options.max_jobs    = static_cast<uint>(ui->jobs_sb->value());
+        options.n_shards    = 2 * options.max_jobs;
+        options.max_retries = 1;
+
+        // only cache misses are dispatched, their rows go to a partial
+        // results file merged with the cached ones at the end
+        std::vector<std::string> miss_basenames;
+        for (uint i : run.misses)
+            miss_basenames.push_back(run.basenames.at(i));
 
-        process->start(
-            QString(matlab_exe.c_str()),
-            QStringList() << QString( (matlab_args).c_str() ));
+        progress_dialog = new QProgressDialog("Solving ...", "Cancel", 0, static_cast<int>(n_misses), this);
+        progress_dialog->setWindowModality(Qt::WindowModal);
+        progress_dialog->setMinimumDuration(0);
+        progress_dialog->setAutoReset(false);
+        connect(progress_dialog, &QProgressDialog::canceled, scheduler, &SolverJobScheduler::cancel);
 
-        std::string file_finished = out_filepath + "_DONE";
+        ui->run_btn->setEnabled(false);
 
-        while (!QFile::exists(file_finished.c_str()))
+        if (!scheduler->start(command, options, run.in_folder, miss_basenames, run.solution_id,
+                              run.out_folder, partial_results_filename()))
         {
-            QCoreApplication::processEvents();
+            ui->log_text->append("ERROR: cannot start the solver");
+
+            progress_dialog->deleteLater();
+            progress_dialog = nullptr;
+
+            ui->run_btn->setEnabled(true);
         }
+    }
+
+    delete dialog;
+}
+
+bool SolverWidget::lookup_cached_results()
+{
+    const std::string path_sep = QString(QDir::separator()).toStdString();
+    const std::string cache_folder = run.in_folder + SOLVER_CACHE_FOLDER;
+    const uint n_meshes = static_cast<uint>(run.basenames.size());
+
+    // one row per mesh: errS, errInf, errL2, hEmax, condVect. Meshes without
+    // results keep a row of NaNs, so that rows stay aligned with the dataset
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    run.errs.assign(5, std::vector<double>(n_meshes, nan));
+    run.keys.assign(n_meshes, 0);
+    run.n_verts.assign(n_meshes, 0);
+    run.misses.clear();
+
+    std::vector<char> hit (n_meshes, 0);
+
+    BackgroundTask task (this, "Looking up cached results ...", n_meshes);
+
+    bool completed = task.run([&]()
+    {
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i=0; i < static_cast<int>(n_meshes); i++)
+        {
+            if (task.is_canceled()) continue;
 
-        remove(file_finished.c_str());
+            FlatPolygonMesh flat;
 
-        std::cout << process->exitStatus() << std::endl;
-        std::cout << process->readAllStandardError().toStdString() << std::endl;
-        std::cout << process->readAllStandardOutput().toStdString() << std::endl;
+            if (read_NODE_ELE_2D(run.in_folder + run.basenames.at(i), flat))
+            {
+                run.keys.at(i)    = solver_cache_key(mesh_content_hash(flat), run.solution_id, run.fingerprint);
+                run.n_verts.at(i) = flat.num_verts();
+
+                SolverCacheEntry entry;
+
+                if (read_solver_cache_entry(cache_folder, run.keys.at(i), entry) &&
+                    entry.errs.size() == run.errs.size() && entry.solution.size() == flat.num_verts())
+                {
+                    // the results view reads the fields from the output folder
+                    const std::string prefix = run.out_folder + path_sep + run.basenames.at(i);
+
+                    if (write_vertex_field(prefix + "-VEM-sol.txt", entry.solution) &&
+                        write_vertex_field(prefix + "-GROUND-TRUTH-sol.txt", entry.ground_truth))
+                    {
+                        for (uint c=0; c < run.errs.size(); c++)
+                            run.errs.at(c).at(i) = entry.errs.at(c);
+
+                        hit.at(i) = 1;
+                    }
+                }
+            }
+
+            task.step_done();
+        }
+    });
+
+    for (uint i=0; i < n_meshes; i++)
+        if (!hit.at(i))
+            run.misses.push_back(i);
+
+    return completed;
+}
+
+bool SolverWidget::run_native_solver()
+{
+    const std::string path_sep = QString(QDir::separator()).toStdString();
+    const std::string cache_folder = run.in_folder + SOLVER_CACHE_FOLDER;
+    const uint n_misses = static_cast<uint>(run.misses.size());
+
+    VEMPoissonOptions options;
+    options.linear_solver = (ui->linear_solver_cb->currentIndex() == 1) ? VEM_CONJUGATE_GRADIENT
+                                                                         : VEM_SPARSE_DIRECT;
+
+    std::vector<char> failed (n_misses, 0);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    BackgroundTask task (this, "Solving ...", n_misses);
+
+    bool completed = task.run([&]()
+    {
+        // meshes are solved in parallel, each one on a single thread (the
+        // assembly loops of the solver do not nest). A single mesh gets the
+        // parallel assembly instead
+        #pragma omp parallel for schedule(dynamic, 1) if (n_misses > 1)
+        for (int m=0; m < static_cast<int>(n_misses); m++)
+        {
+            if (task.is_canceled()) continue;
 
-        std::cout << "DONE" << std::endl;
+            const uint i = run.misses.at(m);
+            const std::string basename = run.basenames.at(i);
 
-        QApplication::restoreOverrideCursor();
+            FlatPolygonMesh flat;
+            std::vector<cinolib::vec3d> verts;
+            std::vector<std::vector<uint>> polys;
 
-        emit (solver_completed (solution_id, out_folder, out_filename));
+            VEMPoissonResult res;
+
+            bool ok = read_NODE_ELE_2D(run.in_folder + basename, flat);
+
+            if (ok)
+            {
+                flat_polygon_mesh_to_vectors(flat, verts, polys);
+                cinolib::Polygonmesh<> mesh (verts, polys);
+
+                ok = vem_poisson_solve(mesh, run.solution_id, options, res);
+            }
+
+            if (ok)
+            {
+                const std::string prefix = run.out_folder + path_sep + basename;
+
+                ok = write_vertex_field(prefix + "-VEM-sol.txt", res.solution) &&
+                     write_vertex_field(prefix + "-GROUND-TRUTH-sol.txt", res.ground_truth);
+
+                SolverCacheEntry entry;
+                entry.errs = { res.errS, res.errInf, res.errL2, res.hEmax, res.condVect };
+
+                for (uint c=0; c < run.errs.size(); c++)
+                    run.errs.at(c).at(i) = entry.errs.at(c);
+
+                entry.solution     = std::move(res.solution);
+                entry.ground_truth = std::move(res.ground_truth);
+
+                if (run.keys.at(i) != 0)
+                    write_solver_cache_entry(cache_folder, run.keys.at(i), entry);
+            }
+
+            failed.at(m) = !ok;
+
+            task.step_done();
+        }
+    });
+
+    if (!completed)
+    {
+        ui->log_text->append("Solver canceled.");
+        return false;
     }
 
-    delete dialog;
+    for (uint m=0; m < n_misses; m++)
+        if (failed.at(m))
+            ui->log_text->append(QString("ERROR: cannot solve ") + run.basenames.at(run.misses.at(m)).c_str());
+
+    ui->log_text->append(QString("Solved ") + QString::number(n_misses) + " meshes in " +
+                         QString::number(timer.elapsed() / 1000.0) + " s");
+
+    return true;
+}
+
+void SolverWidget::store_external_results()
+{
+    const std::string path_sep = QString(QDir::separator()).toStdString();
+    const std::string cache_folder = run.in_folder + SOLVER_CACHE_FOLDER;
+    const std::string partial_filepath = run.out_folder + path_sep + partial_results_filename();
+
+    std::vector<std::vector<double>> partial;
+    const bool ok = read_error_table(partial_filepath, static_cast<uint>(run.errs.size()), partial) &&
+                    partial.front().size() == run.misses.size();
+
+    remove(partial_filepath.c_str());
+
+    if (!ok) return;
+
+    const uint n_misses = static_cast<uint>(run.misses.size());
+
+    BackgroundTask task (this, "Computing errors ...", n_misses);
+
+    task.run([&]()
+    {
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int m=0; m < static_cast<int>(n_misses); m++)
+        {
+            const uint i = run.misses.at(m);
+
+            SolverCacheEntry entry;
+
+            for (uint c=0; c < run.errs.size(); c++)
+                entry.errs.push_back(partial.at(c).at(m));
+
+            // rows of failed shards are all NaNs, and are not cached. The
+            // error columns of the script are kept as they are: only those it
+            // left empty (NaN) are computed here, against its ground truth
+            // field, as the analytical solution of the script is not known
+            const bool solved = std::any_of(entry.errs.begin(), entry.errs.end(),
+                                            [](const double e) { return !std::isnan(e); });
+
+            const std::string prefix = run.out_folder + path_sep + run.basenames.at(i);
+
+            const bool fields = solved && run.n_verts.at(i) > 0 &&
+                                read_vertex_field(prefix + "-VEM-sol.txt", run.n_verts.at(i), entry.solution) &&
+                                read_vertex_field(prefix + "-GROUND-TRUTH-sol.txt", run.n_verts.at(i), entry.ground_truth);
+
+            const uint n_norms = std::min(4u, static_cast<uint>(entry.errs.size()));
+
+            auto missing = [&entry, n_norms]()
+            {
+                return std::any_of(entry.errs.begin(), entry.errs.begin() + n_norms,
+                                   [](const double e) { return std::isnan(e); });
+            };
+
+            FlatPolygonMesh flat;
+
+            if (fields && missing() && read_NODE_ELE_2D(run.in_folder + run.basenames.at(i), flat))
+            {
+                std::vector<cinolib::vec3d> verts;
+                std::vector<std::vector<uint>> polys;
+
+                flat_polygon_mesh_to_vectors(flat, verts, polys);
+                cinolib::Polygonmesh<> mesh (verts, polys);
+
+                ErrorNorms errs;
+
+                if (compute_error_norms(mesh, entry.solution, entry.ground_truth, nullptr, errs))
+                {
+                    const double computed[4] = { errs.errS, errs.errInf, errs.errL2, errs.hEmax };
+
+                    for (uint c=0; c < n_norms; c++)
+                        if (std::isnan(entry.errs.at(c))) entry.errs.at(c) = computed[c];
+                }
+            }
+
+            if (fields && !missing() && run.keys.at(i) != 0)
+                write_solver_cache_entry(cache_folder, run.keys.at(i), entry);
+
+            for (uint c=0; c < run.errs.size(); c++)
+                run.errs.at(c).at(i) = entry.errs.at(c);
+
+            task.step_done();
+        }
+    });
+}
+
+bool SolverWidget::write_results()
+{
+    const std::string path_sep = QString(QDir::separator()).toStdString();
+
+    if (!write_error_table(run.out_folder + path_sep + run.out_filename, run.errs))
+    {
+        ui->log_text->append(QString("ERROR: cannot write ") + run.out_filename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void SolverWidget::on_solver_jobs_finished(const bool results_written)
+{
+    if (progress_dialog != nullptr)
+    {
+        progress_dialog->close();
+        progress_dialog->deleteLater();
+        progress_dialog = nullptr;
+    }
+
+    ui->run_btn->setEnabled(true);
+
+    if (!results_written)
+    {
+        ui->log_text->append("Solver canceled or failed.");
+        return;
+    }
+
+    store_external_results();
+
+    if (write_results())
+        emit (solver_completed (run.solution_id, run.out_folder, run.out_filename));
+}
+
+std::string SolverWidget::partial_results_filename() const
+{
+    return run.out_filename + ".partial";
+}
+
+std::vector<std::string> SolverWidget::dataset_basenames() const
+{
+    std::vector<std::string> basenames (dataset->get_num_parametric_meshes());
+
+    for (uint i=0; i < basenames.size(); i++)
+    {
+        std::string basename = dataset->get_parametric_mesh_filename(i);
+        basename = basename.substr(basename.find_last_of(QDir::separator().toLatin1())+1);
+        basenames.at(i) = basename.substr(0, basename.find_last_of("."));
+    }
+
+    return basenames;
 }
 
-void SolverWidget::update_log()
+void SolverWidget::update_log(const QString line)
 {
-    QString appendText(process->readAll());
-    ui->log_text->append(appendText);
+    ui->log_text->append(line);
 }
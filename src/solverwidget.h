@@ -34,14 +34,34 @@
 #define SOLVERWIDGET_H
 
 #include "dataset.h"
+#include "meshprefetcher.h"
 
-#include <QProcess>
+#include <QProgressDialog>
 #include <QWidget>
 
 namespace Ui {
 class SolverWidget;
 }
 
+class SolverJobScheduler;
+
+// a solver run over the dataset, from the cache lookup to the results file
+typedef struct
+{
+    uint        solution_id = 0;
+    std::string in_folder;                      // with the trailing separator
+    std::string out_folder;
+    std::string out_filename;
+    uint64_t    fingerprint = 0;                // of the solver and its settings
+
+    std::vector<std::string>         basenames; // NODE/ELE files, dataset order
+    std::vector<uint64_t>            keys;      // solver cache keys, 0 if unreadable
+    std::vector<uint>                n_verts;
+    std::vector<std::vector<double>> errs;      // columns of the results table
+    std::vector<uint>                misses;    // meshes to solve
+}
+SolverRun;
+
 class SolverWidget : public QWidget
 {
     Q_OBJECT
@@ -56,6 +76,9 @@ public:
     void update ();
     void clean_canvas ();
 
+    // the render data of the prefetched meshes are stale (e.g. their color mode changed)
+    void drop_prefetched_meshes () { prefetcher->invalidate(); }
+
 Q_SIGNALS:
 
     void solver_completed (const uint solution_id, const std::string folder, const std::string filename);
@@ -63,13 +86,15 @@ Q_SIGNALS:
 public slots:
 
     void show_parametric_mesh (int);
-    void update_log ();
+    void update_log (const QString line);
 
 private slots:
     void on_t_slider_valueChanged(int value);
 
     void on_run_btn_clicked();
 
+    void on_solver_jobs_finished (const bool results_written);
+
 private:
     Ui::SolverWidget *ui;
 
@@ -83,7 +108,33 @@ private:
 
     std::vector<cinolib::DrawablePolygonmesh<> *> drawable_polys;
 
-    QProcess *process = nullptr;
+    MeshPrefetcher *prefetcher = nullptr;   // neighbors of the displayed mesh
+
+    // MATLAB runs: shards of the dataset solved by concurrent processes
+    SolverJobScheduler *scheduler       = nullptr;
+    QProgressDialog    *progress_dialog = nullptr;
+
+    SolverRun run;
+
+    void prepare_render_data (cinolib::DrawablePolygonmesh<> *p) const;
+
+    std::vector<std::string> dataset_basenames () const;
+
+    // meshes whose results are in the solver cache (see meshes/solver_cache.h)
+    // get their outputs from there, the others are listed in run.misses.
+    // Returns false if canceled
+    bool lookup_cached_results ();
+
+    // solves the cache misses in process (meshes/vem_poisson_solver.h).
+    // Returns false if canceled
+    bool run_native_solver ();
+
+    // caches the results of the misses solved by the external solver
+    void store_external_results ();
+
+    bool write_results ();
+
+    std::string partial_results_filename () const;
 };
 
 #endif // SOLVERWIDGET_H